@@ -1,9 +1,16 @@
 #include "AISystem.h"
+#include "BattleEngine.h"
+#include "TranspositionTable.h"
+#include "Metrics.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <algorithm>
-#include <random>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream> 
 #include <map>    
+#include <thread>
 
 namespace {
     const double K_DAMAGE_DEALT_PER_HP = 1.0;
@@ -13,11 +20,55 @@ namespace {
     const double K_TIE_OUTCOME_BASE = 0.0;
     const double K_MOVE_BASE_DAMAGE_BIAS = 0.1;
 
+    // rng.chance() rolls in chooseMoveEasy, as probabilities for moveDistribution
+    const double K_EASY_RANDOM_CHANCE = 0.33;
+    const double K_EASY_SECOND_CHOICE_CHANCE = 0.25;
+
     const double K_PASSIVE_HEAL_MULT = 1.0;
     const double K_PASSIVE_DAMAGE_MULT = 1.1;
     const double K_PASSIVE_BUFF_MULT = 0.8;
     const double K_PASSIVE_PERM_BUFF_MULT = 1.5;
 
+    // OPTIMAL payoffs: HP share difference after the round, with a K.O. worth more than any HP lead
+    const double K_OPTIMAL_KO_VALUE = 2.0;
+    const double K_OPTIMAL_BONUS_PER_HP = 0.5; // A banked bonus point counts as half an HP point
+    const double K_OPTIMAL_EPSILON = 1e-12;
+
+    // LOOKAHEAD: a K.O. found sooner scores slightly higher than one found later
+    const double K_SEARCH_KO_PER_DEPTH = 0.01;
+    const uint64_t K_SEARCH_CLOCK_INTERVAL = 256; // Nodes between deadline checks
+    const int K_SEARCH_MAX_DEPTH = 32;
+    const double K_SEARCH_TIE = 1e-9;
+
+    // Keeps apart the values of one state played from either seat
+    const uint64_t K_PLAYER_SIDE_KEY = 0x9E3779B97F4A7C15ULL;
+
+    // Table key for "self to move against opponent"
+    uint64_t stateKey(const Character& self, const Character& opponent, BattleSide side = BattleSide::BOT) {
+        uint64_t key = zobristPair(self.getStateHash(), opponent.getStateHash());
+        return side == BattleSide::PLAYER ? key ^ K_PLAYER_SIDE_KEY : key;
+    }
+
+    // BattleEngine's round rules with self in the given seat
+    bool beginRoundAs(BattleSide side, Character& self, Character& opponent) {
+        return side == BattleSide::BOT ? BattleEngine::beginRound(opponent, self) : BattleEngine::beginRound(self, opponent);
+    }
+
+    bool resolveMovesAs(BattleSide side, Character& self, Character& opponent, int selfMove, int opponentMove) {
+        return side == BattleSide::BOT ? BattleEngine::resolveMoves(opponent, self, opponentMove, selfMove)
+            : BattleEngine::resolveMoves(self, opponent, selfMove, opponentMove);
+    }
+
+    // Round outcome from self's point of view
+    double evaluateRound(const Character& self, const Character& opponent) {
+        if (self.isDefeated() && opponent.isDefeated()) return 0.0;
+        if (opponent.isDefeated()) return K_OPTIMAL_KO_VALUE;
+        if (self.isDefeated()) return -K_OPTIMAL_KO_VALUE;
+        double selfShare = (self.getCurrentHp() + K_OPTIMAL_BONUS_PER_HP * self.getBonusDamageNextAttack()) / self.getMaxHp();
+        double opponentShare = (opponent.getCurrentHp() + K_OPTIMAL_BONUS_PER_HP * opponent.getBonusDamageNextAttack()) / opponent.getMaxHp();
+        return selfShare - opponentShare;
+    }
+
     int getEstimatedDamage(const Character& c, int move) {
         int baseDmg = 0;
         switch (move) {
@@ -29,19 +80,236 @@ namespace {
     }
 }
 
-int AISystem::chooseMove(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty) {
+const char* difficultyName(AIDifficulty difficulty) {
+    switch (difficulty) {
+    case AIDifficulty::EASY: return "Easy";
+    case AIDifficulty::HARD: return "Hard";
+    case AIDifficulty::OPTIMAL: return "Optimal";
+    case AIDifficulty::LOOKAHEAD: return "Lookahead";
+    }
+    return "Unknown";
+}
+
+namespace {
+    // One thread's view of the search: private fighter copies it rewinds
+    // between branches, plus the shared stop signal
+    class ExpectimaxSearch {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        ExpectimaxSearch(const Character& bot, const Character& player, BattleSide side, bool hasDeadline, Clock::time_point deadline,
+            std::atomic<bool>& stop)
+            : self(bot), opponent(player), rootSelf(bot.captureBattleState()), rootOpponent(player.captureBattleState()),
+            side(side), hasDeadline(hasDeadline), deadline(deadline), stop(stop) {
+        }
+
+        // Expected value of playing move at the root, looking depth rounds ahead.
+        // Returns false if the deadline cut the search short.
+        bool rootValue(int move, int depth, double& value) {
+            double total = 0.0;
+            for (int opponentMove = 1; opponentMove <= 3; ++opponentMove) {
+                self.restoreBattleState(rootSelf);
+                opponent.restoreBattleState(rootOpponent);
+                total += afterMoves(move, opponentMove, depth);
+                if (stop.load(std::memory_order_relaxed)) return false;
+            }
+            value = total / 3.0;
+            return true;
+        }
+
+        uint64_t nodes = 0;
+
+    private:
+        Character self;
+        Character opponent;
+        const Character::BattleState rootSelf;
+        const Character::BattleState rootOpponent;
+        const BattleSide side;
+        const bool hasDeadline;
+        const Clock::time_point deadline;
+        std::atomic<bool>& stop;
+        TranspositionTable& table = TranspositionTable::shared();
+
+        double terminalValue(int depth) const {
+            return evaluateRound(self, opponent) * (1.0 + K_SEARCH_KO_PER_DEPTH * depth);
+        }
+
+        // Passives fire in the order of the searcher's seat in the real battle
+        double afterMoves(int move, int opponentMove, int depth) {
+            if (++nodes % K_SEARCH_CLOCK_INTERVAL == 0 && hasDeadline && Clock::now() >= deadline) {
+                stop.store(true, std::memory_order_relaxed);
+            }
+            if (resolveMovesAs(side, self, opponent, move, opponentMove)) return terminalValue(depth);
+            if (depth <= 1) return evaluateRound(self, opponent);
+            return roundValue(depth - 1);
+        }
+
+        // Value of a state at the start of a round. A state's value at a given
+        // depth never changes, so the shared table can answer for it whichever
+        // thread, turn or battle got there first.
+        double roundValue(int depth) {
+            if (stop.load(std::memory_order_relaxed)) return 0.0;
+            uint64_t key = stateKey(self, opponent, side);
+            TableEntry entry;
+            if (table.probe(key, TableKind::SEARCH_NODE, depth, entry)) return entry.scores[0];
+            if (beginRoundAs(side, self, opponent)) return terminalValue(depth);
+
+            const Character::BattleState selfStart = self.captureBattleState();
+            const Character::BattleState opponentStart = opponent.captureBattleState();
+            double best = -1e300;
+            for (int move = 1; move <= 3; ++move) {
+                double total = 0.0;
+                double worst = 1e300;
+                int worstReply = 0;
+                for (int opponentMove = 1; opponentMove <= 3; ++opponentMove) {
+                    self.restoreBattleState(selfStart);
+                    opponent.restoreBattleState(opponentStart);
+                    double value = afterMoves(move, opponentMove, depth);
+                    total += value;
+                    if (value < worst) { worst = value; worstReply = opponentMove; }
+                }
+                if (total / 3.0 > best) {
+                    best = total / 3.0;
+                    entry.bestMove = move;
+                    entry.bestReply = worstReply;
+                }
+            }
+            // A value cut short by the deadline is incomplete and must not be shared
+            if (!stop.load(std::memory_order_relaxed)) {
+                entry.scores = { best, 0.0, 0.0 };
+                table.store(key, TableKind::SEARCH_NODE, depth, entry);
+            }
+            return best;
+        }
+    };
+}
+
+namespace {
+    // Long-lived workers for root-parallel searches, so a move starts no threads
+    ThreadPool& searchPool() {
+        static ThreadPool pool(3);
+        return pool;
+    }
+}
+
+SearchResult AISystem::searchMove(const Character& botCharacter, const Character& playerCharacter, const SearchLimits& limits,
+    BattleSide side) {
+    using Clock = ExpectimaxSearch::Clock;
+    const bool hasDeadline = limits.deadlineMs > 0.0;
+    const Clock::time_point deadline = Clock::now()
+        + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(limits.deadlineMs));
+    const int maxDepth = std::clamp(limits.maxDepth, 1, K_SEARCH_MAX_DEPTH);
+    std::atomic<bool> stop{ false };
+
+    // A position searched to full depth before, in any battle, needs no search
+    TranspositionTable& table = TranspositionTable::shared();
+    const uint64_t rootKey = stateKey(botCharacter, playerCharacter, side);
+    TableEntry rootEntry;
+    if (table.probe(rootKey, TableKind::SEARCH_ROOT, maxDepth, rootEntry)) {
+        SearchResult cached;
+        cached.values = rootEntry.scores;
+        cached.move = rootEntry.bestMove;
+        cached.depth = maxDepth;
+        return cached;
+    }
+
+    // values[m][d - 1] once move m + 1 has finished depth d
+    std::array<std::array<double, K_SEARCH_MAX_DEPTH>, 3> values{};
+    std::array<int, 3> finished{};
+    std::array<uint64_t, 3> nodes{};
+
+    // Inside a pool (matrix, tournament, the server) the other workers already
+    // keep every core busy, so the search stays on this thread
+    unsigned threads = limits.threads ? limits.threads : std::thread::hardware_concurrency();
+    if (threads >= 3 && !ThreadPool::onWorkerThread()) {
+        // One root move per worker, each deepening on its own until time runs out
+        searchPool().parallelFor(1, 4, 1, [&](size_t first, size_t last, unsigned) {
+            for (size_t m = first; m < last; ++m) {
+                int move = static_cast<int>(m);
+                ExpectimaxSearch search(botCharacter, playerCharacter, side, hasDeadline, deadline, stop);
+                for (int depth = 1; depth <= maxDepth; ++depth) {
+                    if (!search.rootValue(move, depth, values[move - 1][depth - 1])) break;
+                    finished[move - 1] = depth;
+                }
+                nodes[move - 1] = search.nodes;
+            }
+        });
+    }
+    else {
+        // Depth-major so every move reaches a depth before any goes deeper
+        ExpectimaxSearch search(botCharacter, playerCharacter, side, hasDeadline, deadline, stop);
+        for (int depth = 1; depth <= maxDepth && !stop.load(); ++depth) {
+            for (int move = 1; move <= 3; ++move) {
+                if (!search.rootValue(move, depth, values[move - 1][depth - 1])) break;
+                finished[move - 1] = depth;
+            }
+        }
+        nodes[0] = search.nodes;
+    }
+
+    SearchResult result;
+    result.depth = std::max(1, *std::min_element(finished.begin(), finished.end()));
+    result.nodes = nodes[0] + nodes[1] + nodes[2];
+    if (*std::min_element(finished.begin(), finished.end()) == 0) {
+        // Not even one round fit in the budget; finish depth 1 regardless
+        ExpectimaxSearch search(botCharacter, playerCharacter, side, false, deadline, stop);
+        stop.store(false);
+        for (int move = 1; move <= 3; ++move) search.rootValue(move, 1, values[move - 1][0]);
+        result.nodes += search.nodes;
+    }
+    for (int move = 1; move <= 3; ++move) {
+        result.values[move - 1] = values[move - 1][result.depth - 1];
+        if (result.values[move - 1] > result.values[result.move - 1] + K_SEARCH_TIE) result.move = move;
+    }
+    rootEntry.scores = result.values;
+    rootEntry.bestMove = result.move;
+    table.store(rootKey, TableKind::SEARCH_ROOT, result.depth, rootEntry);
+    return result;
+}
+
+namespace {
+    MetricHistogram decisionHistogram(AIDifficulty difficulty) {
+        switch (difficulty) {
+        case AIDifficulty::EASY: return MetricHistogram::AI_DECISION_EASY;
+        case AIDifficulty::OPTIMAL: return MetricHistogram::AI_DECISION_OPTIMAL;
+        case AIDifficulty::LOOKAHEAD: return MetricHistogram::AI_DECISION_LOOKAHEAD;
+        default: return MetricHistogram::AI_DECISION_HARD;
+        }
+    }
+}
+
+int AISystem::chooseMove(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty, Rng& rng,
+    const SearchLimits& limits, BattleSide side) {
+    MetricTimer timer(decisionHistogram(difficulty), MetricTimer::SAMPLED);
     if (difficulty == AIDifficulty::EASY) {
-        return chooseMoveEasy(botCharacter, playerCharacter);
+        return chooseMoveEasy(botCharacter, playerCharacter, rng);
+    }
+    else if (difficulty == AIDifficulty::OPTIMAL) {
+        std::array<double, 3> mix = optimalMix(botCharacter, playerCharacter, side);
+        double roll = rng.nextDouble();
+        for (int move = 1; move < 3; ++move) {
+            roll -= mix[move - 1];
+            if (roll < 0.0) return move;
+        }
+        return 3;
+    }
+    else if (difficulty == AIDifficulty::LOOKAHEAD) {
+        SearchResult search = searchMove(botCharacter, playerCharacter, limits, side);
+        // Equal moves are picked at random so the AI is not predictable
+        std::vector<int> best;
+        for (int move = 1; move <= 3; ++move) {
+            if (search.values[move - 1] >= search.values[search.move - 1] - K_SEARCH_TIE) best.push_back(move);
+        }
+        return best[rng.nextInt(0, static_cast<int>(best.size()) - 1)];
     }
     else {
+        std::array<double, 3> scores = hardScores(botCharacter, playerCharacter);
         std::vector<MoveChoice> scoredMoves;
         for (int move = 1; move <= 3; ++move) {
-            scoredMoves.emplace_back(move, scoreMoveHard(move, botCharacter, playerCharacter));
+            scoredMoves.emplace_back(move, scores[move - 1]);
         }
 
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(scoredMoves.begin(), scoredMoves.end(), g);
+        rng.shuffle(scoredMoves.begin(), scoredMoves.end());
 
         std::sort(scoredMoves.begin(), scoredMoves.end(), [](const MoveChoice& a, const MoveChoice& b) {
             return a.score > b.score;
@@ -57,59 +325,231 @@ int AISystem::chooseMove(const Character& botCharacter, const Character& playerC
         if (!scoredMoves.empty()) {
             return scoredMoves[0].move;
         }
-        return (rand() % 3) + 1;
+        return rng.nextInt(1, 3);
     }
 }
 
-int AISystem::chooseMoveEasy(const Character& botCharacter, const Character& playerCharacter) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(1, 100);
-    std::uniform_int_distribution<> move_distrib(1, 3);
+int AISystem::chooseMoveEasy(const Character& botCharacter, const Character& playerCharacter, Rng& rng) {
+    if (rng.chance(33)) {
+        return rng.nextInt(1, 3);
+    }
+
+    std::vector<MoveChoice> potentialMoves;
+    for (int m = 1; m <= 3; ++m) {
+        potentialMoves.emplace_back(m, scoreMoveEasy(m, botCharacter, playerCharacter));
+    }
 
+    rng.shuffle(potentialMoves.begin(), potentialMoves.end());
+    std::sort(potentialMoves.begin(), potentialMoves.end(), [](const MoveChoice& a, const MoveChoice& b) {
+        return a.score > b.score;
+        });
 
-    if (distrib(gen) <= 33) {
-        return move_distrib(gen);
+    if (!potentialMoves.empty()) {
+        if (rng.chance(25) && potentialMoves.size() > 1) {
+            if (potentialMoves[0].score - potentialMoves[1].score < 10.0) {
+                return potentialMoves[1].move;
+            }
+        }
+        return potentialMoves[0].move;
     }
+    return rng.nextInt(1, 3);
+}
 
-    std::vector<MoveChoice> potentialMoves;
+double AISystem::scoreMoveEasy(int m, const Character& botCharacter, const Character& playerCharacter) {
     bool playerVeryLowHp = (static_cast<double>(playerCharacter.getCurrentHp()) / playerCharacter.getMaxHp()) < 0.20;
+    double currentScore = 0;
+    int damageOutput = getEstimatedDamage(botCharacter, m);
 
-    for (int m = 1; m <= 3; ++m) {
-        double currentScore = 0;
-        int damageOutput = getEstimatedDamage(botCharacter, m);
+    currentScore += damageOutput * 0.5;
 
-        currentScore += damageOutput * 0.5;
+    if (playerVeryLowHp && damageOutput > 0 && (playerCharacter.getCurrentHp() - damageOutput <= 0)) {
+        currentScore += 50;
+    }
+    else if (playerVeryLowHp && damageOutput > 0) {
+        currentScore += damageOutput;
+    }
 
-        if (playerVeryLowHp && damageOutput > 0 && (playerCharacter.getCurrentHp() - damageOutput <= 0)) {
-            currentScore += 50;
+    for (const auto& p : botCharacter.getPassives()) {
+        if (p.trigger == static_cast<PassiveTrigger>(m)) {
+            currentScore += 3.0;
         }
-        else if (playerVeryLowHp && damageOutput > 0) {
-            currentScore += damageOutput;
+    }
+    return currentScore;
+}
+
+std::array<double, 3> AISystem::moveDistribution(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty,
+    BattleSide side) {
+    if (difficulty == AIDifficulty::OPTIMAL) {
+        return optimalMix(botCharacter, playerCharacter, side);
+    }
+    if (difficulty == AIDifficulty::LOOKAHEAD) {
+        // Without a deadline the search depends only on the state
+        SearchResult search = searchMove(botCharacter, playerCharacter, SearchLimits::reproducible(), side);
+        std::array<double, 3> distribution{};
+        int tied = 0;
+        for (int move = 1; move <= 3; ++move) {
+            if (search.values[move - 1] >= search.values[search.move - 1] - K_SEARCH_TIE) ++tied;
         }
+        for (int move = 1; move <= 3; ++move) {
+            if (search.values[move - 1] >= search.values[search.move - 1] - K_SEARCH_TIE) distribution[move - 1] = 1.0 / tied;
+        }
+        return distribution;
+    }
 
-        for (const auto& p : botCharacter.getPassives()) {
-            if (p.trigger == static_cast<PassiveTrigger>(m)) {
-                currentScore += 3.0;
+    // chooseMove shuffles the scored moves and sorts them, so ties go to whichever
+    // came first. Sorting each of the six equally likely orders the same way
+    // gives the exact chance of every move.
+    std::array<double, 3> scores;
+    if (difficulty == AIDifficulty::EASY) {
+        for (int m = 1; m <= 3; ++m) scores[m - 1] = scoreMoveEasy(m, botCharacter, playerCharacter);
+    }
+    else {
+        scores = hardScores(botCharacter, playerCharacter);
+    }
+
+    std::array<double, 3> distribution{};
+    const double orderWeight = 1.0 / 6.0;
+    int order[3] = { 1, 2, 3 };
+    do {
+        std::vector<MoveChoice> moves;
+        for (int m : order) moves.emplace_back(m, scores[m - 1]);
+        std::sort(moves.begin(), moves.end(), [](const MoveChoice& a, const MoveChoice& b) {
+            return a.score > b.score;
+            });
+
+        if (difficulty == AIDifficulty::EASY) {
+            // 67% of the time the scored pick, which a 25% roll swaps for a close second
+            double weight = orderWeight * (1.0 - K_EASY_RANDOM_CHANCE);
+            if (moves[0].score - moves[1].score < 10.0) {
+                distribution[moves[1].move - 1] += weight * K_EASY_SECOND_CHOICE_CHANCE;
+                weight *= 1.0 - K_EASY_SECOND_CHOICE_CHANCE;
             }
+            distribution[moves[0].move - 1] += weight;
         }
-        potentialMoves.emplace_back(m, currentScore);
+        else {
+            distribution[moves[0].move - 1] += orderWeight;
+        }
+    } while (std::next_permutation(order, order + 3));
+
+    if (difficulty == AIDifficulty::EASY) {
+        for (double& p : distribution) p += K_EASY_RANDOM_CHANCE / 3.0;
     }
+    return distribution;
+}
 
-    std::shuffle(potentialMoves.begin(), potentialMoves.end(), gen);
-    std::sort(potentialMoves.begin(), potentialMoves.end(), [](const MoveChoice& a, const MoveChoice& b) {
-        return a.score > b.score;
-        });
+std::array<double, 3> AISystem::optimalMix(const Character& botCharacter, const Character& playerCharacter, BattleSide side) {
+    // Long battles revisit the same HP pairs over and over
+    TranspositionTable& table = TranspositionTable::shared();
+    uint64_t key = stateKey(botCharacter, playerCharacter, side);
+    TableEntry entry;
+    if (table.probe(key, TableKind::EQUILIBRIUM, 0, entry)) {
+        return entry.scores;
+    }
 
-    if (!potentialMoves.empty()) {
-        if (distrib(gen) <= 25 && potentialMoves.size() > 1) {
-            if (potentialMoves[0].score - potentialMoves[1].score < 10.0) {
-                return potentialMoves[1].move;
+    entry.scores = solveZeroSum(buildPayoffMatrix(botCharacter, playerCharacter, side));
+    table.store(key, TableKind::EQUILIBRIUM, 0, entry);
+    return entry.scores;
+}
+
+std::array<double, 3> AISystem::hardScores(const Character& botCharacter, const Character& playerCharacter) {
+    // scoreMoveHard walks both fighters' passives for every move; the table
+    // makes a state seen in any earlier turn, battle or thread one lookup
+    TranspositionTable& table = TranspositionTable::shared();
+    uint64_t key = stateKey(botCharacter, playerCharacter);
+    TableEntry entry;
+    if (table.probe(key, TableKind::HARD_SCORES, 0, entry)) {
+        return entry.scores;
+    }
+
+    for (int move = 1; move <= 3; ++move) {
+        entry.scores[move - 1] = scoreMoveHard(move, botCharacter, playerCharacter);
+        if (entry.bestMove == 0 || entry.scores[move - 1] > entry.scores[entry.bestMove - 1]) entry.bestMove = move;
+    }
+    table.store(key, TableKind::HARD_SCORES, 0, entry);
+    return entry.scores;
+}
+
+AISystem::PayoffMatrix AISystem::buildPayoffMatrix(const Character& botCharacter, const Character& playerCharacter, BattleSide side) {
+    // Plays each of the nine move pairs with the real round rules on scratch copies
+    Character self(botCharacter);
+    Character opponent(playerCharacter);
+    const Character::BattleState selfStart = self.captureBattleState();
+    const Character::BattleState opponentStart = opponent.captureBattleState();
+
+    PayoffMatrix payoff{};
+    for (int selfMove = 1; selfMove <= 3; ++selfMove) {
+        for (int opponentMove = 1; opponentMove <= 3; ++opponentMove) {
+            self.restoreBattleState(selfStart);
+            opponent.restoreBattleState(opponentStart);
+            resolveMovesAs(side, self, opponent, selfMove, opponentMove);
+            payoff[selfMove - 1][opponentMove - 1] = evaluateRound(self, opponent);
+        }
+    }
+    return payoff;
+}
+
+std::array<double, 3> AISystem::solveZeroSum(const PayoffMatrix& payoff) {
+    // The row player's guaranteed payoff, min over columns of x . A[:, j], is
+    // concave and piecewise linear on the simplex, so its maximum sits where two
+    // of these lines cross: a simplex edge (x_k = 0) or a column tie (x . (A_a - A_b) = 0).
+    std::vector<std::array<double, 3>> lines;
+    for (int k = 0; k < 3; ++k) {
+        std::array<double, 3> edge{};
+        edge[k] = 1.0;
+        lines.push_back(edge);
+    }
+    for (int a = 0; a < 3; ++a) {
+        for (int b = a + 1; b < 3; ++b) {
+            lines.push_back({ payoff[0][a] - payoff[0][b], payoff[1][a] - payoff[1][b], payoff[2][a] - payoff[2][b] });
+        }
+    }
+
+    // The even mix is the fallback and wins ties, e.g. when every cell is equal
+    std::array<double, 3> best = { 1.0 / 3.0, 1.0 / 3.0, 1.0 / 3.0 };
+    double bestValue = 1e300;
+    for (int col = 0; col < 3; ++col) {
+        bestValue = std::min(bestValue, (payoff[0][col] + payoff[1][col] + payoff[2][col]) / 3.0);
+    }
+    double bestSpread = 1.0 / 3.0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = i + 1; j < lines.size(); ++j) {
+            // Solve l_i . x = 0, l_j . x = 0, x0 + x1 + x2 = 1 by Cramer's rule
+            const std::array<double, 3>& p = lines[i];
+            const std::array<double, 3>& q = lines[j];
+            std::array<double, 3> cross = {
+                p[1] * q[2] - p[2] * q[1],
+                p[2] * q[0] - p[0] * q[2],
+                p[0] * q[1] - p[1] * q[0]
+            };
+            double det = cross[0] + cross[1] + cross[2];
+            if (std::fabs(det) < K_OPTIMAL_EPSILON) continue;
+
+            std::array<double, 3> x;
+            bool feasible = true;
+            for (int k = 0; k < 3; ++k) {
+                x[k] = cross[k] / det;
+                if (x[k] < -K_OPTIMAL_EPSILON) feasible = false;
+                x[k] = std::max(x[k], 0.0);
+            }
+            if (!feasible) continue;
+
+            double value = 1e300;
+            for (int col = 0; col < 3; ++col) {
+                value = std::min(value, x[0] * payoff[0][col] + x[1] * payoff[1][col] + x[2] * payoff[2][col]);
+            }
+            // Among equally good mixes prefer the most even one; it gives the least away
+            double spread = x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+            if (value > bestValue + K_OPTIMAL_EPSILON || (value > bestValue - K_OPTIMAL_EPSILON && spread < bestSpread)) {
+                bestValue = std::max(value, bestValue);
+                bestSpread = spread;
+                best = x;
             }
         }
-        return potentialMoves[0].move;
     }
-    return move_distrib(gen);
+
+    double total = best[0] + best[1] + best[2];
+    for (double& p : best) p /= total;
+    return best;
 }
 
 double AISystem::scoreMoveHard(int botMove, const Character& bot, const Character& player) {
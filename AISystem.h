@@ -5,16 +5,63 @@
 #include "PassiveSystem.h"
 #include <vector>
 #include <string> 
+#include "Rng.h"
+#include <array>
 
 
 enum class AIDifficulty {
     EASY,
-    HARD
+    HARD,
+    OPTIMAL,  // Mixed-strategy equilibrium of this round's payoff matrix
+    LOOKAHEAD // Expectimax over several rounds of the real rules, time-boxed
 };
 
+// The deciding fighter's seat in BattleEngine. The player's passives fire
+// first, so the AIs that replay rounds (OPTIMAL, LOOKAHEAD) need to know it.
+enum class BattleSide {
+    PLAYER,
+    BOT
+};
+
+// Bounds for AISystem::searchMove. The defaults suit play against a person;
+// headless battles use reproducible(), so a seed gives the same result
+// however loaded the machine is.
+struct SearchLimits {
+    int maxDepth = 4;          // Rounds looked ahead, including this one
+    double deadlineMs = 2.0;   // Wall-clock budget; 0 = none, so the result depends only on the state
+    unsigned threads = 0;      // Root moves searched at once, 0 = one per hardware thread (max 3)
+
+    static SearchLimits reproducible() {
+        SearchLimits limits;
+        limits.deadlineMs = 0.0;
+        return limits;
+    }
+};
+
+struct SearchResult {
+    std::array<double, 3> values{}; // Expected value of each move at the deepest finished depth
+    int move = 1;                   // First of the best moves
+    int depth = 0;                  // Deepest depth every root move finished
+    uint64_t nodes = 0;
+};
+
+const char* difficultyName(AIDifficulty difficulty);
+
 class AISystem {
 public:
-    static int chooseMove(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty);
+    // All randomness comes from the caller's context so runs reproduce from one seed
+    // limits only matter for LOOKAHEAD. botCharacter is the one deciding; side
+    // is its seat, the bot's unless an AI plays the player's side.
+    static int chooseMove(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty, Rng& rng,
+        const SearchLimits& limits = {}, BattleSide side = BattleSide::BOT);
+    // Exact probability of each move (index 0 = Rock) that chooseMove would return
+    static std::array<double, 3> moveDistribution(const Character& botCharacter, const Character& playerCharacter, AIDifficulty difficulty,
+        BattleSide side = BattleSide::BOT);
+    // Iterative-deepening expectimax: the bot maximises, the opponent's move is a
+    // uniform chance node. Call it after the round's turn-start passives, as chooseMove is.
+    // Called from a ThreadPool worker, it searches on that thread alone.
+    static SearchResult searchMove(const Character& botCharacter, const Character& playerCharacter, const SearchLimits& limits = {},
+        BattleSide side = BattleSide::BOT);
 
 private:
     struct MoveChoice {
@@ -23,9 +70,17 @@ private:
         MoveChoice(int m, double s) : move(m), score(s) {}
     };
 
+    // Rows are this fighter's moves, columns the opponent's; higher is better for the row player
+    using PayoffMatrix = std::array<std::array<double, 3>, 3>;
+
+    static std::array<double, 3> hardScores(const Character& botCharacter, const Character& playerCharacter);
+    static std::array<double, 3> optimalMix(const Character& botCharacter, const Character& playerCharacter, BattleSide side);
+    static PayoffMatrix buildPayoffMatrix(const Character& botCharacter, const Character& playerCharacter, BattleSide side);
+    static std::array<double, 3> solveZeroSum(const PayoffMatrix& payoff);
+    static double scoreMoveEasy(int move, const Character& bot, const Character& player);
     static double scoreMoveHard(int botMove, const Character& bot, const Character& player);
     static double evaluatePassiveOutcome(const Passive& passive, const Character& self, const Character& opponent, bool selfIsActor);
-    static int chooseMoveEasy(const Character& botCharacter, const Character& playerCharacter);
+    static int chooseMoveEasy(const Character& botCharacter, const Character& playerCharacter, Rng& rng);
 };
 
 #endif // AISYSTEM_H
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "BalanceEstimate.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    // Battles one matchup plays before the others get a turn
+    const int K_BATTLES_PER_BATCH = 16;
+
+    using Clock = chrono::steady_clock;
+
+    // Wald's SPRT of an even matchup against p = 0.5 + edge, on the build's wins
+    // and losses; draws carry no evidence either way
+    struct Sprt {
+        double winStep;  // Log-likelihood ratio added per win
+        double lossStep; // And per loss
+        double upper;    // Accept p = 0.5 + edge at or above
+        double lower;    // Accept p = 0.5 at or below
+
+        Sprt(double edge, const BalanceOptions& options) {
+            winStep = log((0.5 + edge) / 0.5);
+            lossStep = log((0.5 - edge) / 0.5);
+            upper = log((1 - options.beta) / options.alpha);
+            lower = log(options.beta / (1 - options.alpha));
+        }
+
+        double ratio(const MatchupEstimate& m) const { return m.wins * winStep + m.losses * lossStep; }
+    };
+
+    struct SprtPair {
+        Sprt ahead;  // Tests for the build being favoured
+        Sprt behind; // And for it being unfavoured
+
+        explicit SprtPair(const BalanceOptions& options) : ahead(options.margin, options), behind(-options.margin, options) {}
+
+        // Decided once either test finds an edge, or both accept an even matchup
+        bool decide(MatchupEstimate& m) const {
+            double up = ahead.ratio(m), down = behind.ratio(m);
+            if (up >= ahead.upper) m.verdict = SprtVerdict::FAVOURED;
+            else if (down >= behind.upper) m.verdict = SprtVerdict::UNFAVOURED;
+            else if (up > ahead.lower || down > behind.lower) return false;
+            return true;
+        }
+    };
+
+    // Plays up to one batch of the matchup; returns false once the deadline has passed
+    bool playBatch(MatchupEstimate& m, const Character& build, const SprtPair& sprt, const Rng& stream,
+        const BalanceOptions& options, Clock::time_point deadline) {
+        for (int i = 0; i < K_BATTLES_PER_BATCH && !m.decided; ++i) {
+            if (Clock::now() >= deadline) return false;
+
+            int battle = m.battles();
+            bool buildIsPlayer = battle % 2 == 0;
+            const Character& player = buildIsPlayer ? build : *m.opponent;
+            const Character& bot = buildIsPlayer ? *m.opponent : build;
+            BattleResult r = BattleEngine::runBattle(player, bot, options.policy, options.policy,
+                stream.fork(static_cast<uint64_t>(battle)).next(), options.maxRounds);
+            if (r.outcome == BattleOutcome::PLAYER_WINS) ++(buildIsPlayer ? m.wins : m.losses);
+            else if (r.outcome == BattleOutcome::BOT_WINS) ++(buildIsPlayer ? m.losses : m.wins);
+            else ++m.draws;
+
+            m.decided = sprt.decide(m) || m.battles() >= options.maxBattles;
+        }
+        return true;
+    }
+}
+
+BalanceReport estimateBalance(const Character& build, const vector<const Character*>& opponents, const BalanceOptions& options) {
+    BalanceReport report;
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + chrono::duration_cast<Clock::duration>(chrono::duration<double, milli>(options.budgetMs));
+    const SprtPair sprt(options);
+    const Rng base(options.seed);
+
+    report.matchups.resize(opponents.size());
+    for (size_t i = 0; i < opponents.size(); ++i) report.matchups[i].opponent = opponents[i];
+
+    // Undecided matchups get one batch each per pass, so a slow one cannot starve the rest
+    ThreadPool pool(options.threads);
+    vector<size_t> open;
+    vector<char> inTime;
+    while (true) {
+        open.clear();
+        for (size_t i = 0; i < report.matchups.size(); ++i) {
+            if (!report.matchups[i].decided) open.push_back(i);
+        }
+        if (open.empty()) break;
+
+        inTime.assign(open.size(), 1);
+        pool.parallelFor(0, open.size(), 1, [&](size_t first, size_t last, unsigned) {
+            for (size_t k = first; k < last; ++k) {
+                inTime[k] = playBatch(report.matchups[open[k]], build, sprt, base.fork(open[k]), options, deadline);
+            }
+        });
+        bool expired = false;
+        for (char ok : inTime) expired = expired || !ok;
+        if (expired) {
+            report.timedOut = true;
+            break;
+        }
+    }
+
+    report.milliseconds = chrono::duration<double, milli>(Clock::now() - start).count();
+    return report;
+}
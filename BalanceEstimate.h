@@ -0,0 +1,55 @@
+#ifndef BALANCEESTIMATE_H
+#define BALANCEESTIMATE_H
+
+#include "BattleEngine.h"
+#include <cstdint>
+#include <vector>
+
+// Where a matchup's sequential probability ratio tests ended up. Two run side
+// by side, each testing an even matchup against one side being up by the margin.
+enum class SprtVerdict {
+    FAVOURED,   // Win rate 50% + margin accepted
+    UNFAVOURED, // Win rate 50% - margin accepted
+    CLOSE       // Even accepted by both tests, or the battle cap reached
+};
+
+// One matchup of the build against an opponent, counted from the build's side
+struct MatchupEstimate {
+    const Character* opponent = nullptr;
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;    // Double K.O.s and round limits, worth half a win
+    SprtVerdict verdict = SprtVerdict::CLOSE;
+    bool decided = false; // False if the time budget ran out before the test stopped
+
+    int battles() const { return wins + losses + draws; }
+    double winRate() const { return battles() ? (wins + 0.5 * draws) / battles() : 0.5; }
+};
+
+struct BalanceOptions {
+    // Both sides. The optimal AI mixes its moves, so battles differ and each
+    // one is evidence; hard against hard mostly stalls into the round limit.
+    MovePolicy policy = MovePolicy::ai(AIDifficulty::OPTIMAL);
+    int maxRounds = 200;        // Passive stalls are called draws early; they cost the most time
+    int maxBattles = 1000;      // Per matchup before it is called close
+    double margin = 0.05;       // Smallest edge worth calling
+    double alpha = 0.05;        // Chance of calling an even matchup lopsided
+    double beta = 0.05;         // Chance of calling a lopsided one even
+    double budgetMs = 80.0;     // Wall-clock budget; undecided matchups report what they have
+    uint64_t seed = 1;          // Same build, same report
+    unsigned threads = 0;       // 0 = all hardware threads
+};
+
+struct BalanceReport {
+    std::vector<MatchupEstimate> matchups; // In opponent order
+    double milliseconds = 0.0;
+    bool timedOut = false;
+};
+
+// Estimates the build's win rate against each opponent from simulated battles,
+// alternating sides. Matchups run in parallel in short batches, so each gets
+// a share of the budget, and each stops as soon as its SPRT is decided.
+BalanceReport estimateBalance(const Character& build, const std::vector<const Character*>& opponents,
+    const BalanceOptions& options = BalanceOptions());
+
+#endif // BALANCEESTIMATE_H
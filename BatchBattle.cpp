@@ -0,0 +1,891 @@
+#include "BatchBattle.h"
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BATCH_HAS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BATCH_TARGET_AVX2
+#else
+#define BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+namespace {
+    const uint32_t K_NOT_RUNNING = static_cast<uint32_t>(-1);
+
+    // An effectTable row holds, per trigger, the sum of the fighter's flat
+    // effects packed three fields to a word, so a step costs two gathers
+    enum EffectField { K_HEAL, K_DAMAGE, K_BONUS, K_ROCK, K_PAPER, K_SCISSORS, K_EFFECT_FIELDS };
+    const int K_FIELDS_PER_WORD = 3;
+    const int K_FIELD_BITS = 10;
+    const int32_t K_FIELD_MAX = (1 << K_FIELD_BITS) - 1;
+    const size_t K_WORDS_PER_TRIGGER = K_EFFECT_FIELDS / K_FIELDS_PER_WORD;
+    const size_t K_ROW_SIZE = PASSIVE_TRIGGER_COUNT * K_WORDS_PER_TRIGGER;
+
+    uint32_t triggerBit(PassiveTrigger t) {
+        return 1u << static_cast<int>(t);
+    }
+
+    const uint32_t K_TURN_START_BIT = 1u << static_cast<int>(PassiveTrigger::ON_TURN_START);
+    const uint32_t K_TIE_BIT = 1u << static_cast<int>(PassiveTrigger::ON_TIE);
+    const uint32_t K_ATTACKER_BITS = 1u << static_cast<int>(PassiveTrigger::AFTER_ANY_ATTACK);
+    const uint32_t K_DEFENDER_BITS = (1u << static_cast<int>(PassiveTrigger::AFTER_TAKING_HIT))
+        | (1u << static_cast<int>(PassiveTrigger::ON_HP_BELOW_PERCENT));
+
+    // Triggers BattleEngine::afterStrike may fire for each side of a hit
+    uint32_t attackerTriggers(int move) {
+        return (1u << move) | K_ATTACKER_BITS;
+    }
+
+    uint32_t defenderTriggers(int move) {
+        return (1u << (move + 3)) | K_DEFENDER_BITS;
+    }
+
+    bool detectAvx2() {
+#if defined(BATCH_HAS_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6);
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#elif defined(BATCH_HAS_X86)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}
+
+BatchBattle::BatchBattle(size_t expectedLanes)
+    : effectTable(K_ROW_SIZE, 0), laneCount(0), span(0), activeLanes(0), passiveLanes(0), scalarLanes(0),
+    scalarPassPending(false), useSimd(simdAvailable()) {
+    // Padded to whole SIMD blocks so the kernel never needs a partial load
+    size_t slots = (expectedLanes + 7) / 8 * 8;
+    resizeColumns(slots);
+    results.reserve(expectedLanes);
+    slotOf.reserve(expectedLanes);
+}
+
+bool BatchBattle::simdAvailable() {
+    static const bool available = detectAvx2();
+    return available;
+}
+
+size_t BatchBattle::size() const { return laneCount; }
+size_t BatchBattle::activeCount() const { return activeLanes; }
+
+void BatchBattle::clear() {
+    fill(active.begin(), active.begin() + span, 0);
+    laneCount = 0;
+    span = 0;
+    activeLanes = 0;
+    passiveLanes = 0;
+    scalarLanes = 0;
+    passivePool.clear();
+    effectTable.assign(K_ROW_SIZE, 0);
+    scriptPool.clear();
+    results.clear();
+    slotOf.clear();
+}
+
+// Every per-slot column that has to move when a slot is retired
+template <class F>
+void BatchBattle::forEachColumn(F&& f) {
+    for (auto& s : side) {
+        f(s.hp); f(s.maxHp); // The passive kernel clamps every lane of a block to it
+        f(s.rockDamage); f(s.paperDamage); f(s.scissorsDamage);
+        f(s.randomMoves); f(s.scriptFirst); f(s.scriptLength); f(s.scriptCursor);
+    }
+    for (auto& words : rngState) f(words);
+    f(rounds); f(maxRounds); f(active); f(laneOf);
+}
+
+// The rest of a slot's columns, which only mean something on a lane with
+// passives. Moving a lane without any needs them cleared at most.
+template <class F>
+void BatchBattle::forEachPassiveColumn(F&& f) {
+    for (auto& s : side) {
+        f(s.bonus);
+        f(s.triggerMask); f(s.hpTriggerFloor); f(s.hpTriggerCeiling); f(s.passiveFirst); f(s.passiveCount);
+        f(s.effectRow);
+    }
+    f(passivesFired); f(scalarPassives);
+}
+
+void BatchBattle::clearPassiveColumns(size_t slot) {
+    for (auto& s : side) {
+        s.bonus[slot] = 0;
+        s.triggerMask[slot] = 0;
+        s.effectRow[slot] = 0;
+    }
+    passivesFired[slot] = 0;
+    scalarPassives[slot] = 0;
+}
+
+// Every column, the per-round scratch ones included
+void BatchBattle::resizeColumns(size_t slots) {
+    auto resize = [slots](auto& column) { column.resize(slots); };
+    forEachColumn(resize);
+    forEachPassiveColumn(resize);
+    for (auto& s : side) s.move.resize(slots);
+    winner.resize(slots);
+    hpBefore.resize(slots);
+    done.resize(slots);
+    fixup.resize(slots);
+}
+
+void BatchBattle::addFighter(int s, const Character& c, const MovePolicy& policy) {
+    FighterColumns& f = side[s];
+    size_t slot = span - 1;
+    // Same starting point as runBattle's copy + resetStatsForNewBattle
+    f.hp[slot] = c.getMaxHp();
+    f.maxHp[slot] = c.getMaxHp();
+    f.rockDamage[slot] = c.getRockDamage();
+    f.paperDamage[slot] = c.getPaperDamage();
+    f.scissorsDamage[slot] = c.getScissorsDamage();
+    f.bonus[slot] = 0;
+    f.triggerMask[slot] = c.getPassiveTriggerMask();
+    f.hpTriggerFloor[slot] = c.getHpTriggerFloor();
+    f.passiveFirst[slot] = static_cast<uint32_t>(passivePool.size());
+    f.passiveCount[slot] = static_cast<uint32_t>(c.getPassives().size());
+    f.hpTriggerCeiling[slot] = -1;
+    for (Passive p : c.getPassives()) {
+        p.triggeredThisTurn = false;
+        passivePool.push_back(p);
+        if (p.trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
+            f.hpTriggerCeiling[slot] = max(f.hpTriggerCeiling[slot], p.hpCutoff);
+        }
+    }
+    f.effectRow[slot] = addEffectRow(c);
+    bool scripted = policy.kind == MovePolicy::Kind::SCRIPTED;
+    f.randomMoves[slot] = scripted ? 0 : -1;
+    f.scriptFirst[slot] = static_cast<int32_t>(scriptPool.size());
+    f.scriptLength[slot] = scripted ? static_cast<int32_t>(policy.script.size()) : 0;
+    f.scriptCursor[slot] = 0;
+    f.move[slot] = 1;
+    if (scripted) scriptPool.insert(scriptPool.end(), policy.script.begin(), policy.script.end());
+}
+
+// Passives of one trigger fire together with no defeat check in between, so
+// flat effects just add up. HP thresholds are checked passive by passive, so
+// there it holds only if they agree and no heal comes before another one.
+int32_t BatchBattle::addEffectRow(const Character& c) {
+    if (c.getPassives().empty()) return 0;
+    array<array<int32_t, K_EFFECT_FIELDS>, PASSIVE_TRIGGER_COUNT> sums{};
+    int hpCutoff = -1;
+    bool hpBelowHealed = false;
+    for (const Passive& p : c.getPassives()) {
+        int field;
+        switch (p.effect) {
+        case PassiveEffect::HEAL_SELF_FLAT: field = K_HEAL; break;
+        case PassiveEffect::DAMAGE_OPPONENT_FLAT: field = K_DAMAGE; break;
+        case PassiveEffect::INCREASE_NEXT_ATTACK_FLAT: field = K_BONUS; break;
+        case PassiveEffect::INCREASE_ROCK_DMG_PERM: field = K_ROCK; break;
+        case PassiveEffect::INCREASE_PAPER_DMG_PERM: field = K_PAPER; break;
+        case PassiveEffect::INCREASE_SCISSORS_DMG_PERM: field = K_SCISSORS; break;
+        case PassiveEffect::NONE: continue;
+        default: return 0; // Depends on HP at the time it fires
+        }
+        if (p.value < 0) return 0; // Clamping would no longer commute
+        if (p.trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
+            if (hpBelowHealed || (hpCutoff >= 0 && hpCutoff != p.hpCutoff)) return 0;
+            hpCutoff = p.hpCutoff;
+            hpBelowHealed = field == K_HEAL;
+        }
+        int32_t& sum = sums[static_cast<size_t>(p.trigger)][field];
+        if (p.value > K_FIELD_MAX - sum) return 0; // Too big to pack
+        sum += p.value;
+    }
+    array<int32_t, K_ROW_SIZE> row{};
+    for (size_t t = 0; t < PASSIVE_TRIGGER_COUNT; ++t) {
+        for (int k = 0; k < K_EFFECT_FIELDS; ++k) {
+            row[t * K_WORDS_PER_TRIGGER + k / K_FIELDS_PER_WORD] |= sums[t][k] << (k % K_FIELDS_PER_WORD * K_FIELD_BITS);
+        }
+    }
+    // A batch usually repeats the same few fighters
+    size_t last = effectTable.size() - K_ROW_SIZE;
+    if (last > 0 && equal(row.begin(), row.end(), effectTable.begin() + last)) return static_cast<int32_t>(last);
+    effectTable.insert(effectTable.end(), row.begin(), row.end());
+    return static_cast<int32_t>(last + K_ROW_SIZE);
+}
+
+size_t BatchBattle::addBattle(const Character& player, const Character& bot,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, uint64_t seed, int maxRoundsForLane) {
+    auto batchable = [](const MovePolicy& p) {
+        return p.kind == MovePolicy::Kind::RANDOM || (p.kind == MovePolicy::Kind::SCRIPTED && !p.script.empty());
+    };
+    if (!batchable(playerPolicy) || !batchable(botPolicy)) return REJECTED_LANE;
+
+    size_t slot = span++;
+    if (slot == rounds.size()) resizeColumns(max<size_t>(64, slot * 2));
+
+    size_t lane = laneCount++;
+    addFighter(0, player, playerPolicy);
+    addFighter(1, bot, botPolicy);
+
+    uint64_t words[4];
+    Rng(seed).saveState(words);
+    for (int k = 0; k < 4; ++k) rngState[k][slot] = words[k];
+    rounds[slot] = 0;
+    maxRounds[slot] = maxRoundsForLane;
+    active[slot] = -1;
+    laneOf[slot] = static_cast<uint32_t>(lane);
+    passivesFired[slot] = 0;
+    bool scalar = (!player.getPassives().empty() && !side[0].effectRow[slot])
+        || (!bot.getPassives().empty() && !side[1].effectRow[slot]);
+    scalarPassives[slot] = scalar ? -1 : 0;
+    if (scalar) side[0].effectRow[slot] = side[1].effectRow[slot] = 0;
+    results.emplace_back();
+    slotOf.push_back(static_cast<uint32_t>(slot));
+
+    ++activeLanes;
+    if (side[0].triggerMask[slot] | side[1].triggerMask[slot]) ++passiveLanes;
+    if (scalar) ++scalarLanes;
+    if (slotDefeated(slot) || maxRoundsForLane <= 0) {
+        finishSlot(slot);
+        --span;
+    }
+    return lane;
+}
+
+bool BatchBattle::slotDefeated(size_t slot) const {
+    return side[0].hp[slot] <= 0 || side[1].hp[slot] <= 0;
+}
+
+BattleResult BatchBattle::resultOf(size_t slot) const {
+    BattleResult r;
+    r.rounds = rounds[slot];
+    r.playerHp = side[0].hp[slot];
+    r.botHp = side[1].hp[slot];
+    bool playerDown = r.playerHp <= 0;
+    bool botDown = r.botHp <= 0;
+    if (playerDown && botDown) r.outcome = BattleOutcome::DOUBLE_KO;
+    else if (botDown) r.outcome = BattleOutcome::PLAYER_WINS;
+    else if (playerDown) r.outcome = BattleOutcome::BOT_WINS;
+    else r.outcome = BattleOutcome::ROUND_LIMIT;
+    return r;
+}
+
+void BatchBattle::finishSlot(size_t slot) {
+    uint32_t lane = laneOf[slot];
+    results[lane] = resultOf(slot);
+    slotOf[lane] = K_NOT_RUNNING;
+    active[slot] = 0;
+    --activeLanes;
+    if (side[0].triggerMask[slot] | side[1].triggerMask[slot]) --passiveLanes;
+    if (scalarPassives[slot]) --scalarLanes;
+}
+
+BattleResult BatchBattle::result(size_t lane) const {
+    uint32_t slot = slotOf[lane];
+    return slot == K_NOT_RUNNING ? results[lane] : resultOf(slot);
+}
+
+// Drops finished lanes by moving the last running slot into each gap, so the
+// kernels only ever walk running battles and each lane moves at most once
+void BatchBattle::retireFinished() {
+    for (size_t i = span; i-- > 0;) {
+        if (!done[i]) continue;
+        if (active[i]) finishSlot(i);
+        size_t last = --span;
+        if (i != last) {
+            auto moveDown = [i, last](auto& column) { column[i] = column[last]; };
+            forEachColumn(moveDown);
+            if (side[0].triggerMask[last] | side[1].triggerMask[last]) forEachPassiveColumn(moveDown);
+            else if (side[0].triggerMask[i] | side[1].triggerMask[i]) clearPassiveColumns(i);
+            slotOf[laneOf[i]] = static_cast<uint32_t>(i);
+        }
+        active[last] = 0;
+    }
+}
+
+void BatchBattle::slotHeal(size_t slot, int s, int amount) {
+    int32_t& hp = side[s].hp[slot];
+    hp += amount;
+    if (hp > side[s].maxHp[slot]) hp = side[s].maxHp[slot];
+}
+
+void BatchBattle::slotTakeDamage(size_t slot, int s, int damage) {
+    int32_t& hp = side[s].hp[slot];
+    hp -= damage;
+    if (hp < 0) hp = 0;
+}
+
+void BatchBattle::slotApplyEffect(size_t slot, int self, const Passive& p) {
+    int opponent = 1 - self;
+    FighterColumns& f = side[self];
+    switch (p.effect) {
+    case PassiveEffect::HEAL_SELF_FLAT: slotHeal(slot, self, p.value); break;
+    case PassiveEffect::DAMAGE_OPPONENT_FLAT: slotTakeDamage(slot, opponent, p.value); break;
+    case PassiveEffect::INCREASE_NEXT_ATTACK_FLAT: f.bonus[slot] += p.value; break;
+    case PassiveEffect::INCREASE_ROCK_DMG_PERM: f.rockDamage[slot] += p.value; break;
+    case PassiveEffect::INCREASE_PAPER_DMG_PERM: f.paperDamage[slot] += p.value; break;
+    case PassiveEffect::INCREASE_SCISSORS_DMG_PERM: f.scissorsDamage[slot] += p.value; break;
+    case PassiveEffect::HEAL_SELF_PERCENT_CURRENT:
+        slotHeal(slot, self, (f.hp[slot] * p.value) / 100);
+        break;
+    case PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT:
+        slotTakeDamage(slot, opponent, (side[opponent].hp[slot] * p.value) / 100);
+        break;
+    default: break;
+    }
+}
+
+void BatchBattle::slotApplyPassives(size_t slot, int self, PassiveTrigger trigger, int move, bool didWin) {
+    const FighterColumns& f = side[self];
+    if (!(f.triggerMask[slot] & triggerBit(trigger))) return;
+
+    Passive* first = passivePool.data() + f.passiveFirst[slot];
+    Passive* last = first + f.passiveCount[slot];
+
+    if (trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
+        for (Passive* p = first; p != last; ++p) {
+            int hp = f.hp[slot];
+            if (p->trigger == trigger && !p->triggeredThisTurn && hp >= f.hpTriggerFloor[slot] && hp <= p->hpCutoff) {
+                p->triggeredThisTurn = true;
+                passivesFired[slot] = 1;
+                slotApplyEffect(slot, self, *p);
+            }
+        }
+        return;
+    }
+
+    bool conditionMet = true;
+    switch (trigger) {
+    case PassiveTrigger::ON_WIN_ROCK: conditionMet = (move == 1 && didWin); break;
+    case PassiveTrigger::ON_WIN_PAPER: conditionMet = (move == 2 && didWin); break;
+    case PassiveTrigger::ON_WIN_SCISSORS: conditionMet = (move == 3 && didWin); break;
+    case PassiveTrigger::ON_LOSE_ROCK: conditionMet = (move == 1 && !didWin); break;
+    case PassiveTrigger::ON_LOSE_PAPER: conditionMet = (move == 2 && !didWin); break;
+    case PassiveTrigger::ON_LOSE_SCISSORS: conditionMet = (move == 3 && !didWin); break;
+    case PassiveTrigger::ON_TIE: conditionMet = !didWin; break;
+    default: break;
+    }
+    if (!conditionMet) return;
+
+    for (Passive* p = first; p != last; ++p) {
+        if (p->trigger == trigger && !p->triggeredThisTurn) {
+            p->triggeredThisTurn = true;
+            passivesFired[slot] = 1;
+            slotApplyEffect(slot, self, *p);
+        }
+    }
+}
+
+bool BatchBattle::slotBeginRound(size_t slot) {
+    slotApplyPassives(slot, 0, PassiveTrigger::ON_TURN_START, 0, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, 1, PassiveTrigger::ON_TURN_START, 0, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, 0, PassiveTrigger::ON_HP_BELOW_PERCENT, 0, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, 1, PassiveTrigger::ON_HP_BELOW_PERCENT, 0, false);
+    return slotDefeated(slot);
+}
+
+bool BatchBattle::slotResolveTie(size_t slot) {
+    slotApplyPassives(slot, 0, PassiveTrigger::ON_TIE, 0, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, 1, PassiveTrigger::ON_TIE, 0, false);
+    return slotDefeated(slot);
+}
+
+bool BatchBattle::slotAfterStrike(size_t slot, int attacker, int attackerMove, int defenderMove, int defenderHpBefore) {
+    int defender = 1 - attacker;
+    slotApplyPassives(slot, attacker, static_cast<PassiveTrigger>(attackerMove), attackerMove, true);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, attacker, PassiveTrigger::AFTER_ANY_ATTACK, 0, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, defender, static_cast<PassiveTrigger>(defenderMove + 3), defenderMove, false);
+    if (slotDefeated(slot)) return true;
+    slotApplyPassives(slot, defender, PassiveTrigger::AFTER_TAKING_HIT, 0, false);
+    if (slotDefeated(slot)) return true;
+    if (side[defender].hp[slot] != defenderHpBefore) {
+        slotApplyPassives(slot, defender, PassiveTrigger::ON_HP_BELOW_PERCENT, 0, false);
+    }
+    return slotDefeated(slot);
+}
+
+void BatchBattle::chooseMovesScalar(size_t slot) {
+    for (auto& f : side) {
+        if (f.randomMoves[slot]) {
+            uint64_t words[4];
+            for (int k = 0; k < 4; ++k) words[k] = rngState[k][slot];
+            Rng rng = Rng::fromState(words);
+            f.move[slot] = rng.nextInt(1, 3);
+            rng.saveState(words);
+            for (int k = 0; k < 4; ++k) rngState[k][slot] = words[k];
+        }
+        else {
+            int32_t& cursor = f.scriptCursor[slot];
+            f.move[slot] = scriptPool[f.scriptFirst[slot] + cursor];
+            if (++cursor == f.scriptLength[slot]) cursor = 0;
+        }
+    }
+}
+
+void BatchBattle::strikeScalar(size_t i) {
+    FighterColumns& p = side[0];
+    FighterColumns& b = side[1];
+    int32_t pm = p.move[i];
+    int32_t bm = b.move[i];
+    int32_t d = pm - bm;
+    d += 3 & -(d < 0);
+    int32_t playerHit = -(d == 1);
+    int32_t botHit = -(d == 2);
+
+    int32_t pdmg = (pm == 1 ? p.rockDamage[i] : pm == 2 ? p.paperDamage[i] : p.scissorsDamage[i]) + p.bonus[i];
+    int32_t bdmg = (bm == 1 ? b.rockDamage[i] : bm == 2 ? b.paperDamage[i] : b.scissorsDamage[i]) + b.bonus[i];
+
+    int32_t hp0 = p.hp[i];
+    int32_t hp1 = b.hp[i];
+    hpBefore[i] = playerHit ? hp1 : hp0;
+    b.hp[i] = playerHit ? max(hp1 - pdmg, 0) : hp1;
+    p.hp[i] = botHit ? max(hp0 - bdmg, 0) : hp0;
+    p.bonus[i] &= ~playerHit;
+    b.bonus[i] &= ~botHit;
+    winner[i] = (playerHit & PLAYER_HIT) | (botHit & BOT_HIT);
+
+    uint32_t reacting;
+    if (playerHit) reacting = (p.triggerMask[i] & attackerTriggers(pm)) | (b.triggerMask[i] & defenderTriggers(bm));
+    else if (botHit) reacting = (b.triggerMask[i] & attackerTriggers(bm)) | (p.triggerMask[i] & defenderTriggers(pm));
+    else reacting = (p.triggerMask[i] | b.triggerMask[i]) & K_TIE_BIT;
+    fixup[i] = reacting ? -1 : 0;
+}
+
+// Flags every lane a passive may react on, kernel lanes included, and plays
+// the start-of-round passives runRound leaves to the kernels
+void BatchBattle::kernelScalar(size_t first, size_t last) {
+    if (passiveLanes > 0) scalarPassPending = true;
+    for (size_t i = first; i < last; ++i) {
+        fixup[i] = 0;
+        if (active[i]) {
+            bool ended = (side[0].effectRow[i] | side[1].effectRow[i]) && slotBeginRound(i);
+            if (!ended) {
+                chooseMovesScalar(i);
+                strikeScalar(i);
+            }
+        }
+        done[i] = (slotDefeated(i) || rounds[i] >= maxRounds[i]) ? -1 : 0;
+    }
+}
+
+#if defined(BATCH_HAS_X86)
+namespace {
+    // xoshiro256** state of four lanes, one 64-bit word per lane in each register
+    struct RngLanes {
+        __m256i s0, s1, s2, s3;
+    };
+
+    BATCH_TARGET_AVX2 inline __m256i load(const int32_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    BATCH_TARGET_AVX2 inline __m256i load(const uint64_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    BATCH_TARGET_AVX2 inline void store(int32_t* p, __m256i x) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+    }
+
+    BATCH_TARGET_AVX2 inline void store(uint64_t* p, __m256i x) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+    }
+
+    BATCH_TARGET_AVX2 inline __m256i rotl64(__m256i x, int k) {
+        return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+    }
+
+    // Four xoshiro256** steps at once. Masked lanes keep their state; the
+    // unmasked form is for blocks where every lane draws.
+    template <bool Masked>
+    BATCH_TARGET_AVX2 inline __m256i xoshiroNext(RngLanes& r, __m256i mask) {
+        __m256i x5 = _mm256_add_epi64(r.s1, _mm256_slli_epi64(r.s1, 2));
+        __m256i r7 = rotl64(x5, 7);
+        __m256i result = _mm256_add_epi64(r7, _mm256_slli_epi64(r7, 3));
+        __m256i t = _mm256_slli_epi64(r.s1, 17);
+        __m256i s2 = _mm256_xor_si256(r.s2, r.s0);
+        __m256i s3 = _mm256_xor_si256(r.s3, r.s1);
+        __m256i s1 = _mm256_xor_si256(r.s1, s2);
+        __m256i s0 = _mm256_xor_si256(r.s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = rotl64(s3, 45);
+        if (Masked) {
+            s0 = _mm256_blendv_epi8(r.s0, s0, mask);
+            s1 = _mm256_blendv_epi8(r.s1, s1, mask);
+            s2 = _mm256_blendv_epi8(r.s2, s2, mask);
+            s3 = _mm256_blendv_epi8(r.s3, s3, mask);
+        }
+        r = { s0, s1, s2, s3 };
+        return result;
+    }
+
+    // Rng::nextInt(1, 3) on four draws. Returns moves in the low dword of each
+    // 64-bit lane and flags lanes that hit Lemire's (1 in 2^32) rejection case.
+    BATCH_TARGET_AVX2 inline __m256i drawMove(__m256i draw, __m256i mask, __m256i& rejected) {
+        __m256i m = _mm256_mul_epu32(_mm256_srli_epi64(draw, 32), _mm256_set1_epi64x(3));
+        __m256i low = _mm256_and_si256(m, _mm256_set1_epi64x(0xFFFFFFFF));
+        rejected = _mm256_or_si256(rejected, _mm256_and_si256(mask, _mm256_cmpeq_epi64(low, _mm256_setzero_si256())));
+        return _mm256_add_epi64(_mm256_srli_epi64(m, 32), _mm256_set1_epi64x(1));
+    }
+
+    // Low dwords of two 4 x 64-bit vectors packed into one 8 x 32-bit vector
+    BATCH_TARGET_AVX2 inline __m256i packLow(__m256i lo, __m256i hi) {
+        const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        return _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(lo, idx), _mm256_permutevar8x32_epi32(hi, idx), 0x20);
+    }
+
+    // Either fighter down, or the round limit reached
+    BATCH_TARGET_AVX2 inline __m256i doneMask(__m256i hp0, __m256i hp1, __m256i rounds, __m256i maxRounds) {
+        const __m256i one = _mm256_set1_epi32(1);
+        __m256i defeated = _mm256_or_si256(_mm256_cmpgt_epi32(one, hp0), _mm256_cmpgt_epi32(one, hp1));
+        __m256i underLimit = _mm256_cmpgt_epi32(maxRounds, rounds);
+        return _mm256_or_si256(defeated, _mm256_xor_si256(underLimit, _mm256_set1_epi32(-1)));
+    }
+
+    // One fighter's moves for eight lanes: RANDOM lanes draw from their stream,
+    // SCRIPTED lanes read script[cursor] and advance the cursor
+    BATCH_TARGET_AVX2 inline __m256i chooseMoves(__m256i act, const int32_t* randomMoves,
+        const int32_t* scriptFirst, const int32_t* scriptLength, __m256i& cursor, const int32_t* scriptPool,
+        RngLanes& lo, RngLanes& hi, __m256i& rejected) {
+        __m256i randomPolicy = load(randomMoves);
+        __m256i random = _mm256_and_si256(act, randomPolicy);
+        __m256i randomLo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(random));
+        __m256i randomHi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(random, 1));
+        // Finished lanes may advance freely, only scripted ones must keep their stream
+        __m256i drawLo, drawHi;
+        if (_mm256_testc_si256(randomPolicy, _mm256_set1_epi32(-1))) {
+            drawLo = xoshiroNext<false>(lo, randomLo);
+            drawHi = xoshiroNext<false>(hi, randomHi);
+        }
+        else {
+            drawLo = xoshiroNext<true>(lo, randomLo);
+            drawHi = xoshiroNext<true>(hi, randomHi);
+        }
+        __m256i moves = packLow(drawMove(drawLo, randomLo, rejected), drawMove(drawHi, randomHi, rejected));
+
+        __m256i scripted = _mm256_andnot_si256(random, act);
+        if (!_mm256_testz_si256(scripted, scripted)) {
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i fromScript = _mm256_mask_i32gather_epi32(zero, scriptPool,
+                _mm256_add_epi32(load(scriptFirst), cursor), scripted, 4);
+            __m256i next = _mm256_add_epi32(cursor, _mm256_set1_epi32(1));
+            next = _mm256_andnot_si256(_mm256_cmpeq_epi32(next, load(scriptLength)), next);
+            cursor = _mm256_blendv_epi8(cursor, next, scripted);
+            moves = _mm256_blendv_epi8(moves, fromScript, scripted);
+        }
+        return moves;
+    }
+
+    // One block's fighters, [0] the player and [1] the bot
+    struct FighterLanes {
+        __m256i hp[2], maxHp[2], bonus[2], rock[2], paper[2], scissors[2];
+    };
+
+    // What the passive steps need besides the fighters
+    struct PassiveLanes {
+        const int32_t* table;
+        __m256i mask[2]; // triggerMask
+        __m256i row[2];  // effectRow
+    };
+
+    BATCH_TARGET_AVX2 inline __m256i standing(const FighterLanes& f) {
+        const __m256i zero = _mm256_setzero_si256();
+        return _mm256_and_si256(_mm256_cmpgt_epi32(f.hp[0], zero), _mm256_cmpgt_epi32(f.hp[1], zero));
+    }
+
+    // Inside an ON_HP_BELOW_PERCENT range; a ceiling of -1 means no such passive
+    BATCH_TARGET_AVX2 inline __m256i hpInRange(__m256i hp, __m256i floor, __m256i ceiling) {
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(floor, hp), _mm256_cmpgt_epi32(hp, ceiling));
+        return _mm256_xor_si256(outside, _mm256_set1_epi32(-1));
+    }
+
+    BATCH_TARGET_AVX2 inline __m256i unpackField(__m256i word, int slot) {
+        return _mm256_and_si256(_mm256_srli_epi32(word, slot * K_FIELD_BITS), _mm256_set1_epi32(K_FIELD_MAX));
+    }
+
+    // Adds v to the player's lanes where onPlayer is set and to the bot's elsewhere
+    BATCH_TARGET_AVX2 inline void addSplit(__m256i (&x)[2], __m256i v, __m256i onPlayer) {
+        x[0] = _mm256_add_epi32(x[0], _mm256_and_si256(onPlayer, v));
+        x[1] = _mm256_add_epi32(x[1], _mm256_andnot_si256(onPlayer, v));
+    }
+
+    // One step of BattleEngine's passive order: in the given lanes, the player
+    // (where player is set) or the bot applies its passives for trigger, if it
+    // has any. Returns the lanes that fired.
+    BATCH_TARGET_AVX2 inline __m256i firePassives(FighterLanes& f, const PassiveLanes& passives,
+        __m256i player, __m256i trigger, __m256i lanes) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi32(1);
+        __m256i mask = _mm256_blendv_epi8(passives.mask[1], passives.mask[0], player);
+        __m256i fire = _mm256_and_si256(lanes, _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(mask, trigger), one), one));
+        if (_mm256_testz_si256(fire, fire)) return fire;
+
+        __m256i row = _mm256_blendv_epi8(passives.row[1], passives.row[0], player);
+        __m256i index = _mm256_add_epi32(row, _mm256_slli_epi32(trigger, 1));
+        __m256i self = _mm256_mask_i32gather_epi32(zero, passives.table, index, fire, 4);
+        __m256i perm = _mm256_mask_i32gather_epi32(zero, passives.table + 1, index, fire, 4);
+        __m256i heal = unpackField(self, K_HEAL);
+        __m256i damage = unpackField(self, K_DAMAGE);
+        f.hp[0] = _mm256_min_epi32(_mm256_add_epi32(f.hp[0], _mm256_and_si256(player, heal)), f.maxHp[0]);
+        f.hp[1] = _mm256_min_epi32(_mm256_add_epi32(f.hp[1], _mm256_andnot_si256(player, heal)), f.maxHp[1]);
+        f.hp[0] = _mm256_max_epi32(_mm256_sub_epi32(f.hp[0], _mm256_andnot_si256(player, damage)), zero);
+        f.hp[1] = _mm256_max_epi32(_mm256_sub_epi32(f.hp[1], _mm256_and_si256(player, damage)), zero);
+        addSplit(f.bonus, unpackField(self, K_BONUS), player);
+        addSplit(f.rock, unpackField(perm, K_ROCK - K_FIELDS_PER_WORD), player);
+        addSplit(f.paper, unpackField(perm, K_PAPER - K_FIELDS_PER_WORD), player);
+        addSplit(f.scissors, unpackField(perm, K_SCISSORS - K_FIELDS_PER_WORD), player);
+        return fire;
+    }
+}
+
+template <bool Passives>
+BATCH_TARGET_AVX2
+void BatchBattle::kernelAvx2Block(size_t i) {
+    FighterColumns& p = side[0];
+    FighterColumns& b = side[1];
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i hpBelow = _mm256_set1_epi32(static_cast<int>(PassiveTrigger::ON_HP_BELOW_PERCENT));
+
+    __m256i act = load(&active[i]);
+    FighterLanes f;
+    for (int s = 0; s < 2; ++s) {
+        FighterColumns& c = side[s];
+        f.hp[s] = load(&c.hp[i]);
+        f.bonus[s] = load(&c.bonus[i]);
+        f.rock[s] = load(&c.rockDamage[i]);
+        f.paper[s] = load(&c.paperDamage[i]);
+        f.scissors[s] = load(&c.scissorsDamage[i]);
+    }
+
+    // Lanes whose passives this kernel plays; nothing is stored until the
+    // moves are drawn, so a rejected draw can still hand the block over
+    PassiveLanes passives;
+    __m256i kernelLanes = zero;
+    __m256i hpBelowFired[2] = { zero, zero };
+    if constexpr (Passives) {
+        passives = { effectTable.data(),
+            { load(reinterpret_cast<const int32_t*>(&p.triggerMask[i])), load(reinterpret_cast<const int32_t*>(&b.triggerMask[i])) },
+            { load(&p.effectRow[i]), load(&b.effectRow[i]) } };
+        kernelLanes = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_or_si256(passives.row[0], passives.row[1]), zero), act);
+        f.maxHp[0] = load(&p.maxHp[i]);
+        f.maxHp[1] = load(&b.maxHp[i]);
+
+        // BattleEngine::beginRound: turn start, then HP thresholds, player first, stopping at a K.O.
+        const __m256i turnStart = _mm256_set1_epi32(static_cast<int>(PassiveTrigger::ON_TURN_START));
+        __m256i lanes = kernelLanes;
+        firePassives(f, passives, ones, turnStart, lanes);
+        lanes = _mm256_and_si256(lanes, standing(f));
+        firePassives(f, passives, zero, turnStart, lanes);
+        for (int s = 0; s < 2; ++s) {
+            lanes = _mm256_and_si256(lanes, standing(f));
+            __m256i inRange = hpInRange(f.hp[s], load(&side[s].hpTriggerFloor[i]), load(&side[s].hpTriggerCeiling[i]));
+            hpBelowFired[s] = firePassives(f, passives, s == 0 ? ones : zero, hpBelow, _mm256_and_si256(lanes, inRange));
+        }
+        // A K.O. before the moves ends the battle; retireFinished() picks it up through done
+        __m256i knockedOut = _mm256_andnot_si256(standing(f), kernelLanes);
+        act = _mm256_andnot_si256(knockedOut, act);
+        kernelLanes = _mm256_andnot_si256(knockedOut, kernelLanes);
+    }
+    // Moves: the player's draw comes before the bot's on the lane's stream
+    RngLanes lo = { load(&rngState[0][i]), load(&rngState[1][i]), load(&rngState[2][i]), load(&rngState[3][i]) };
+    RngLanes hi = { load(&rngState[0][i + 4]), load(&rngState[1][i + 4]), load(&rngState[2][i + 4]), load(&rngState[3][i + 4]) };
+    __m256i rejected = zero;
+    __m256i pCursor = load(&p.scriptCursor[i]);
+    __m256i bCursor = load(&b.scriptCursor[i]);
+    __m256i pm = chooseMoves(act, &p.randomMoves[i], &p.scriptFirst[i], &p.scriptLength[i], pCursor,
+        scriptPool.data(), lo, hi, rejected);
+    __m256i bm = chooseMoves(act, &b.randomMoves[i], &b.scriptFirst[i], &b.scriptLength[i], bCursor,
+        scriptPool.data(), lo, hi, rejected);
+    if (!_mm256_testz_si256(rejected, rejected)) {
+        // Nothing stored yet, so the scalar path can redo this block from the same state
+        kernelScalar(i, i + 8);
+        return;
+    }
+    store(&rngState[0][i], lo.s0);
+    store(&rngState[1][i], lo.s1);
+    store(&rngState[2][i], lo.s2);
+    store(&rngState[3][i], lo.s3);
+    store(&rngState[0][i + 4], hi.s0);
+    store(&rngState[1][i + 4], hi.s1);
+    store(&rngState[2][i + 4], hi.s2);
+    store(&rngState[3][i + 4], hi.s3);
+    store(&p.scriptCursor[i], pCursor);
+    store(&b.scriptCursor[i], bCursor);
+
+    // Branchless RPS: (pm - bm) mod 3 is 0 tie, 1 player wins, 2 bot wins
+    __m256i d = _mm256_sub_epi32(pm, bm);
+    d = _mm256_add_epi32(d, _mm256_and_si256(three, _mm256_cmpgt_epi32(zero, d)));
+    __m256i playerHit = _mm256_and_si256(act, _mm256_cmpeq_epi32(d, one));
+    __m256i botHit = _mm256_and_si256(act, _mm256_cmpeq_epi32(d, two));
+
+    __m256i pdmg = _mm256_blendv_epi8(f.scissors[0], f.paper[0], _mm256_cmpeq_epi32(pm, two));
+    pdmg = _mm256_add_epi32(_mm256_blendv_epi8(pdmg, f.rock[0], _mm256_cmpeq_epi32(pm, one)), f.bonus[0]);
+    __m256i bdmg = _mm256_blendv_epi8(f.scissors[1], f.paper[1], _mm256_cmpeq_epi32(bm, two));
+    bdmg = _mm256_add_epi32(_mm256_blendv_epi8(bdmg, f.rock[1], _mm256_cmpeq_epi32(bm, one)), f.bonus[1]);
+
+    __m256i defenderHpBefore = _mm256_blendv_epi8(f.hp[0], f.hp[1], playerHit);
+    f.hp[1] = _mm256_blendv_epi8(f.hp[1], _mm256_max_epi32(_mm256_sub_epi32(f.hp[1], pdmg), zero), playerHit);
+    f.hp[0] = _mm256_blendv_epi8(f.hp[0], _mm256_max_epi32(_mm256_sub_epi32(f.hp[0], bdmg), zero), botHit);
+    f.bonus[0] = _mm256_andnot_si256(playerHit, f.bonus[0]);
+    f.bonus[1] = _mm256_andnot_si256(botHit, f.bonus[1]);
+
+    if constexpr (Passives) {
+        // BattleEngine::afterStrike, or resolveMoves on a tie. The attacker's
+        // win passives fire even if the hit was a K.O.
+        const __m256i onTie = _mm256_set1_epi32(static_cast<int>(PassiveTrigger::ON_TIE));
+        const __m256i afterAttack = _mm256_set1_epi32(static_cast<int>(PassiveTrigger::AFTER_ANY_ATTACK));
+        const __m256i afterHit = _mm256_set1_epi32(static_cast<int>(PassiveTrigger::AFTER_TAKING_HIT));
+        __m256i hit = _mm256_or_si256(playerHit, botHit);
+        __m256i tie = _mm256_andnot_si256(hit, kernelLanes);
+        __m256i lanes = kernelLanes;
+        __m256i winTrigger = _mm256_blendv_epi8(_mm256_blendv_epi8(onTie, bm, botHit), pm, playerHit); // ON_WIN_x is x
+        firePassives(f, passives, _mm256_or_si256(playerHit, tie), winTrigger, lanes);
+        lanes = _mm256_and_si256(lanes, standing(f));
+        firePassives(f, passives, playerHit, _mm256_blendv_epi8(onTie, afterAttack, hit), lanes);
+
+        // The defender's side, the player where the bot hit
+        lanes = _mm256_and_si256(_mm256_and_si256(lanes, hit), standing(f));
+        __m256i defenderMove = _mm256_blendv_epi8(pm, bm, playerHit);
+        firePassives(f, passives, botHit, _mm256_add_epi32(defenderMove, three), lanes); // ON_LOSE_x is x + 3
+        lanes = _mm256_and_si256(lanes, standing(f));
+        firePassives(f, passives, botHit, afterHit, lanes);
+        lanes = _mm256_and_si256(lanes, standing(f));
+        __m256i defenderHp = _mm256_blendv_epi8(f.hp[1], f.hp[0], botHit);
+        __m256i floor = _mm256_blendv_epi8(load(&b.hpTriggerFloor[i]), load(&p.hpTriggerFloor[i]), botHit);
+        __m256i ceiling = _mm256_blendv_epi8(load(&b.hpTriggerCeiling[i]), load(&p.hpTriggerCeiling[i]), botHit);
+        __m256i firedAlready = _mm256_blendv_epi8(hpBelowFired[1], hpBelowFired[0], botHit);
+        lanes = _mm256_andnot_si256(_mm256_or_si256(firedAlready, _mm256_cmpeq_epi32(defenderHp, defenderHpBefore)), lanes);
+        firePassives(f, passives, botHit, hpBelow, _mm256_and_si256(lanes, hpInRange(defenderHp, floor, ceiling)));
+
+        for (int s = 0; s < 2; ++s) {
+            store(&side[s].rockDamage[i], f.rock[s]);
+            store(&side[s].paperDamage[i], f.paper[s]);
+            store(&side[s].scissorsDamage[i], f.scissors[s]);
+        }
+    }
+    store(&p.hp[i], f.hp[0]);
+    store(&b.hp[i], f.hp[1]);
+    store(&p.bonus[i], f.bonus[0]);
+    store(&b.bonus[i], f.bonus[1]);
+    store(&done[i], doneMask(f.hp[0], f.hp[1], load(&rounds[i]), load(&maxRounds[i])));
+
+    // Scalar lanes where a passive could react to this round; the rest skip the scalar pass
+    __m256i scalarLanes = _mm256_and_si256(act, load(&scalarPassives[i]));
+    if (_mm256_testz_si256(scalarLanes, scalarLanes)) {
+        store(&fixup[i], zero);
+        return;
+    }
+    // What the scalar pass reads back
+    store(&p.move[i], pm);
+    store(&b.move[i], bm);
+    store(&hpBefore[i], defenderHpBefore);
+    store(&winner[i], _mm256_or_si256(_mm256_and_si256(playerHit, one), _mm256_and_si256(botHit, two)));
+    __m256i pMask = load(reinterpret_cast<const int32_t*>(&p.triggerMask[i]));
+    __m256i bMask = load(reinterpret_cast<const int32_t*>(&b.triggerMask[i]));
+    __m256i attackerBits = _mm256_set1_epi32(static_cast<int>(K_ATTACKER_BITS));
+    __m256i defenderBits = _mm256_set1_epi32(static_cast<int>(K_DEFENDER_BITS));
+    __m256i pWin = _mm256_or_si256(_mm256_sllv_epi32(one, pm), attackerBits);
+    __m256i bWin = _mm256_or_si256(_mm256_sllv_epi32(one, bm), attackerBits);
+    __m256i pLose = _mm256_or_si256(_mm256_sllv_epi32(one, _mm256_add_epi32(pm, three)), defenderBits);
+    __m256i bLose = _mm256_or_si256(_mm256_sllv_epi32(one, _mm256_add_epi32(bm, three)), defenderBits);
+    __m256i tie = _mm256_andnot_si256(_mm256_or_si256(playerHit, botHit), act);
+    __m256i reacting = _mm256_and_si256(tie,
+        _mm256_and_si256(_mm256_or_si256(pMask, bMask), _mm256_set1_epi32(static_cast<int>(K_TIE_BIT))));
+    reacting = _mm256_or_si256(reacting, _mm256_and_si256(playerHit,
+        _mm256_or_si256(_mm256_and_si256(pMask, pWin), _mm256_and_si256(bMask, bLose))));
+    reacting = _mm256_or_si256(reacting, _mm256_and_si256(botHit,
+        _mm256_or_si256(_mm256_and_si256(bMask, bWin), _mm256_and_si256(pMask, pLose))));
+    store(&fixup[i], _mm256_and_si256(scalarLanes, _mm256_xor_si256(_mm256_cmpeq_epi32(reacting, zero), ones)));
+}
+
+BATCH_TARGET_AVX2
+void BatchBattle::kernelAvx2(size_t first, size_t last) {
+    for (size_t i = first; i < last; i += 8) {
+        __m256i act = load(&active[i]);
+        if (_mm256_testz_si256(act, act)) {
+            // Lanes retired by start-of-round passives still need their done flag
+            store(&done[i], doneMask(load(&side[0].hp[i]), load(&side[1].hp[i]), load(&rounds[i]), load(&maxRounds[i])));
+            store(&fixup[i], _mm256_setzero_si256());
+            continue;
+        }
+        // Kept apart so blocks without passives do not pay for their registers
+        __m256i rows = _mm256_or_si256(load(&side[0].effectRow[i]), load(&side[1].effectRow[i]));
+        if (_mm256_testz_si256(rows, act)) kernelAvx2Block<false>(i);
+        else kernelAvx2Block<true>(i);
+    }
+}
+#else
+void BatchBattle::kernelAvx2(size_t first, size_t last) {
+    kernelScalar(first, last);
+}
+#endif
+
+bool BatchBattle::runRound() {
+    if (activeLanes == 0) return false;
+
+    for (size_t i = 0; i < span; ++i) rounds[i] -= active[i];
+
+    // Start-of-round passives of the scalar lanes, in the same order as BattleEngine::beginRound
+    if (scalarLanes > 0) {
+        for (size_t i = 0; i < span; ++i) {
+            if (!active[i] || !scalarPassives[i]) continue;
+            bool beginTriggers = false;
+            for (auto& f : side) {
+                beginTriggers |= (f.triggerMask[i] & K_TURN_START_BIT)
+                    || (f.hp[i] >= f.hpTriggerFloor[i] && f.hp[i] <= f.hpTriggerCeiling[i]);
+            }
+            if (beginTriggers && slotBeginRound(i)) {
+                finishSlot(i); // Kernels skip it; retireFinished() sees it as defeated
+            }
+        }
+    }
+
+    scalarPassPending = scalarLanes > 0;
+    // Columns are padded to whole blocks, so the SIMD kernel can cover the tail
+    if (useSimd) kernelAvx2(0, (span + 7) / 8 * 8);
+    else kernelScalar(0, span);
+
+    // Passive follow-ups for the lanes the kernel flagged; the turn's flags are
+    // cleared once it is over, which is all BattleEngine's start-of-turn reset does
+    if (scalarPassPending) {
+        for (size_t i = 0; i < span; ++i) {
+            if (fixup[i]) {
+                int w = winner[i];
+                if (w == TIE) {
+                    slotResolveTie(i);
+                }
+                else {
+                    int attacker = (w == PLAYER_HIT) ? 0 : 1;
+                    slotAfterStrike(i, attacker, side[attacker].move[i], side[1 - attacker].move[i], hpBefore[i]);
+                }
+                done[i] = (slotDefeated(i) || rounds[i] >= maxRounds[i]) ? -1 : 0;
+            }
+            if (passivesFired[i]) {
+                for (auto& f : side) {
+                    Passive* first = passivePool.data() + f.passiveFirst[i];
+                    for (uint32_t k = 0; k < f.passiveCount[i]; ++k) first[k].triggeredThisTurn = false;
+                }
+                passivesFired[i] = 0;
+            }
+        }
+    }
+
+    retireFinished();
+    return activeLanes > 0;
+}
+
+void BatchBattle::runToCompletion() {
+    while (runRound()) {
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef BATCHBATTLE_H
+#define BATCHBATTLE_H
+
+#include "BattleEngine.h"
+#include "Rng.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Thousands of concurrent battles held as structure-of-arrays. Each call to
+// runRound() advances every unfinished battle by one round: move draws
+// (xoshiro256** stepped four streams per register), the RPS winner, damage,
+// bonus consumption and clamping run eight lanes at a time in an AVX2 kernel,
+// with a scalar kernel on other CPUs. Passives with flat effects fire in the
+// kernel too: each fighter's are summed per trigger into a row of effectTable,
+// and every step of BattleEngine's passive order is a masked gather from the
+// rows of the lanes whose trigger masks say it fires. Lanes with a passive
+// the kernel cannot sum (percent effects, negative or oversized values, HP
+// thresholds that differ) get a scalar pass before and after the kernel
+// instead. Either way every battle ends exactly as BattleEngine::runBattle
+// would for the same seed. Finished lanes are swapped out so the kernel only
+// walks battles that are still running.
+//
+// Only policies that need no character state (RANDOM, SCRIPTED) can be batched.
+class BatchBattle {
+public:
+    static const size_t REJECTED_LANE = static_cast<size_t>(-1);
+
+    explicit BatchBattle(size_t expectedLanes = 0);
+
+    // Returns the lane index, or REJECTED_LANE for AI policies
+    size_t addBattle(const Character& player, const Character& bot,
+        const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+        uint64_t seed, int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS);
+
+    size_t size() const;
+    size_t activeCount() const;
+    void clear(); // Drops every lane but keeps the column storage for reuse
+
+    bool runRound(); // Returns false once every lane has finished
+    void runToCompletion();
+    BattleResult result(size_t lane) const;
+
+    static bool simdAvailable();
+
+private:
+    enum Winner : int32_t { TIE = 0, PLAYER_HIT = 1, BOT_HIT = 2 };
+
+    // Columns are indexed by slot; slots [0, span) hold the running lanes
+    struct FighterColumns {
+        std::vector<int32_t> hp;
+        std::vector<int32_t> maxHp;
+        std::vector<int32_t> rockDamage;
+        std::vector<int32_t> paperDamage;
+        std::vector<int32_t> scissorsDamage;
+        std::vector<int32_t> bonus;
+        std::vector<uint32_t> triggerMask;
+        std::vector<int32_t> hpTriggerFloor;
+        std::vector<int32_t> hpTriggerCeiling; // Highest hpCutoff, -1 without ON_HP_BELOW_PERCENT passives
+        std::vector<uint32_t> passiveFirst; // Range in passivePool
+        std::vector<uint32_t> passiveCount;
+        std::vector<int32_t> effectRow;     // Offset of the fighter's row in effectTable, 0 on scalar lanes
+        std::vector<int32_t> randomMoves;   // -1 for RANDOM, 0 for SCRIPTED
+        std::vector<int32_t> scriptFirst;   // Range in scriptPool
+        std::vector<int32_t> scriptLength;
+        std::vector<int32_t> scriptCursor;  // Equals round % scriptLength
+        std::vector<int32_t> move;          // This round's move
+    };
+
+    FighterColumns side[2]; // 0 = player, 1 = bot
+    std::vector<uint64_t> rngState[4];      // Per-lane xoshiro256** words, player draws first
+    std::vector<int32_t> rounds;
+    std::vector<int32_t> maxRounds;
+    std::vector<int32_t> active;            // -1 while running, 0 once finished (SIMD mask layout)
+    std::vector<uint32_t> laneOf;           // Slot -> lane index given out by addBattle
+    std::vector<int32_t> winner;            // Scratch: this round's Winner per slot
+    std::vector<int32_t> hpBefore;          // Scratch: defender HP before the hit
+    std::vector<int32_t> done;              // Scratch: -1 once a slot's battle is over
+    std::vector<int32_t> fixup;             // Scratch: -1 if a passive may react to this round's strike
+    std::vector<int32_t> passivesFired;     // Some triggeredThisTurn flag needs clearing
+    std::vector<int32_t> scalarPassives;    // -1 if the lane's passives run in the scalar passes
+    std::vector<Passive> passivePool;
+    std::vector<int32_t> effectTable;       // Two packed words per trigger per row; row 0 is all zeros
+    std::vector<int32_t> scriptPool;
+    std::vector<BattleResult> results;      // By lane, filled as lanes finish
+    std::vector<uint32_t> slotOf;           // Lane -> current slot while running
+    size_t laneCount;
+    size_t span;
+    size_t activeLanes;
+    size_t passiveLanes;                    // Running lanes with at least one passive
+    size_t scalarLanes;                     // Running lanes with scalarPassives set
+    bool scalarPassPending;                 // This round left fixup or passivesFired flags to handle
+    bool useSimd;
+
+    template <class F> void forEachColumn(F&& f);
+    template <class F> void forEachPassiveColumn(F&& f);
+    void clearPassiveColumns(size_t slot);
+    void resizeColumns(size_t slots);
+    void addFighter(int s, const Character& c, const MovePolicy& policy);
+    int32_t addEffectRow(const Character& c); // 0 if the kernel cannot apply c's passives
+    void retireFinished();
+
+    void chooseMovesScalar(size_t slot);
+    void kernelScalar(size_t first, size_t last);
+    void kernelAvx2(size_t first, size_t last);
+    template <bool Passives> void kernelAvx2Block(size_t i); // Passives: some lane has kernel passives
+    void strikeScalar(size_t slot);
+
+    // Scalar passive rules on the columns; mirror Character/BattleEngine
+    bool slotDefeated(size_t slot) const;
+    bool slotBeginRound(size_t slot);
+    bool slotResolveTie(size_t slot);
+    bool slotAfterStrike(size_t slot, int attacker, int attackerMove, int defenderMove, int defenderHpBefore);
+    void slotApplyPassives(size_t slot, int self, PassiveTrigger trigger, int move, bool didWin);
+    void slotApplyEffect(size_t slot, int self, const Passive& p);
+    void slotHeal(size_t slot, int s, int amount);
+    void slotTakeDamage(size_t slot, int s, int damage);
+    void finishSlot(size_t slot);
+    BattleResult resultOf(size_t slot) const;
+};
+
+#endif // BATCHBATTLE_H
@@ -0,0 +1,215 @@
+#include "BattleEngine.h"
+#include "BuiltinKernel.h"
+#include "CharacterPool.h"
+#include "Metrics.h"
+#include <utility>
+
+using namespace std;
+
+MovePolicy MovePolicy::ai(AIDifficulty difficulty) {
+    MovePolicy policy;
+    policy.kind = Kind::AI;
+    policy.difficulty = difficulty;
+    return policy;
+}
+
+MovePolicy MovePolicy::scripted(vector<int> moves) {
+    MovePolicy policy;
+    policy.kind = Kind::SCRIPTED;
+    policy.script = std::move(moves);
+    return policy;
+}
+
+MovePolicy MovePolicy::random() {
+    MovePolicy policy;
+    policy.kind = Kind::RANDOM;
+    return policy;
+}
+
+int MovePolicy::chooseMove(const Character& self, const Character& opponent, BattleSide side, int round, Rng& rng) const {
+    if (kind == Kind::SCRIPTED && !script.empty()) {
+        return script[round % script.size()];
+    }
+    if (kind == Kind::RANDOM) {
+        return rng.nextInt(1, 3);
+    }
+    // Headless battles must replay from their seed, so no wall-clock cutoffs
+    return AISystem::chooseMove(self, opponent, difficulty, rng, SearchLimits::reproducible(), side);
+}
+
+array<double, 3> MovePolicy::moveDistribution(const Character& self, const Character& opponent, BattleSide side, int round) const {
+    if (kind == Kind::SCRIPTED && !script.empty()) {
+        array<double, 3> distribution{};
+        distribution[script[round % script.size()] - 1] = 1.0;
+        return distribution;
+    }
+    if (kind == Kind::RANDOM) {
+        return { 1.0 / 3.0, 1.0 / 3.0, 1.0 / 3.0 };
+    }
+    return AISystem::moveDistribution(self, opponent, difficulty, side);
+}
+
+int BattleEngine::getRPSWinner(int playerMove, int botMove) {
+    if (playerMove == botMove) return 0;
+    if ((playerMove == 1 && botMove == 3) ||
+        (playerMove == 2 && botMove == 1) ||
+        (playerMove == 3 && botMove == 2)) {
+        return 1;
+    }
+    return 2;
+}
+
+namespace {
+    bool eitherDefeated(const Character& a, const Character& b) {
+        return a.isDefeated() || b.isDefeated();
+    }
+}
+
+template <class Sink>
+bool BattleEngine::beginRoundImpl(Character& player, Character& bot, Sink& sink) {
+    player.resetTurnState();
+    bot.resetTurnState();
+
+    player.checkAndApplyPassives(PassiveTrigger::ON_TURN_START, player, bot, 0, false, sink);
+    if (eitherDefeated(player, bot)) return true;
+    bot.checkAndApplyPassives(PassiveTrigger::ON_TURN_START, bot, player, 0, false, sink);
+    if (eitherDefeated(player, bot)) return true;
+
+    player.checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, player, bot, 0, false, sink);
+    if (eitherDefeated(player, bot)) return true;
+    bot.checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, bot, player, 0, false, sink);
+    return eitherDefeated(player, bot);
+}
+
+template <class Sink>
+bool BattleEngine::resolveTieImpl(Character& player, Character& bot, Sink& sink) {
+    player.checkAndApplyPassives(PassiveTrigger::ON_TIE, player, bot, 0, false, sink);
+    if (eitherDefeated(player, bot)) return true;
+    bot.checkAndApplyPassives(PassiveTrigger::ON_TIE, bot, player, 0, false, sink);
+    return eitherDefeated(player, bot);
+}
+
+template <class Sink>
+int BattleEngine::strikeImpl(Character& attacker, Character& defender, int move, Sink& sink) {
+    int damage = attacker.calculateDamage(move);
+    defender.takeDamage(damage);
+    if constexpr (Sink::enabled) {
+        sink.record({ BattleEventType::DAMAGE, &attacker, &defender, nullptr, damage, move });
+        if (defender.isDefeated()) sink.record({ BattleEventType::DEFEAT, &attacker, &defender, nullptr, damage, move });
+    }
+    return damage;
+}
+
+template <class Sink>
+bool BattleEngine::afterStrikeImpl(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, Sink& sink) {
+    attacker.checkAndApplyPassives(static_cast<PassiveTrigger>(attackerMove), attacker, defender, attackerMove, true, sink);
+    if (eitherDefeated(attacker, defender)) return true;
+    attacker.checkAndApplyPassives(PassiveTrigger::AFTER_ANY_ATTACK, attacker, defender, 0, false, sink);
+    if (eitherDefeated(attacker, defender)) return true;
+
+    defender.checkAndApplyPassives(static_cast<PassiveTrigger>(defenderMove + 3), defender, attacker, defenderMove, false, sink);
+    if (eitherDefeated(attacker, defender)) return true;
+    defender.checkAndApplyPassives(PassiveTrigger::AFTER_TAKING_HIT, defender, attacker, 0, false, sink);
+    if (eitherDefeated(attacker, defender)) return true;
+
+    if (defender.getCurrentHp() != defenderHpBefore) {
+        defender.checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, defender, attacker, 0, false, sink);
+    }
+    return eitherDefeated(attacker, defender);
+}
+
+template <class Sink>
+bool BattleEngine::resolveMovesImpl(Character& player, Character& bot, int playerMove, int botMove, Sink& sink) {
+    int winner = getRPSWinner(playerMove, botMove);
+    if (winner == 0) {
+        return resolveTieImpl(player, bot, sink);
+    }
+    if (winner == 1) {
+        int oldBotHp = bot.getCurrentHp();
+        strikeImpl(player, bot, playerMove, sink);
+        return afterStrikeImpl(player, bot, playerMove, botMove, oldBotHp, sink);
+    }
+    int oldPlayerHp = player.getCurrentHp();
+    strikeImpl(bot, player, botMove, sink);
+    return afterStrikeImpl(bot, player, botMove, playerMove, oldPlayerHp, sink);
+}
+
+bool BattleEngine::beginRound(Character& player, Character& bot, BattleEventSink& sink) { return beginRoundImpl(player, bot, sink); }
+bool BattleEngine::beginRound(Character& player, Character& bot, NullEventSink sink) { return beginRoundImpl(player, bot, sink); }
+bool BattleEngine::resolveTie(Character& player, Character& bot, BattleEventSink& sink) { return resolveTieImpl(player, bot, sink); }
+bool BattleEngine::resolveTie(Character& player, Character& bot, NullEventSink sink) { return resolveTieImpl(player, bot, sink); }
+int BattleEngine::strike(Character& attacker, Character& defender, int move, BattleEventSink& sink) { return strikeImpl(attacker, defender, move, sink); }
+int BattleEngine::strike(Character& attacker, Character& defender, int move, NullEventSink sink) { return strikeImpl(attacker, defender, move, sink); }
+
+bool BattleEngine::afterStrike(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, BattleEventSink& sink) {
+    return afterStrikeImpl(attacker, defender, attackerMove, defenderMove, defenderHpBefore, sink);
+}
+
+bool BattleEngine::afterStrike(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, NullEventSink sink) {
+    return afterStrikeImpl(attacker, defender, attackerMove, defenderMove, defenderHpBefore, sink);
+}
+
+bool BattleEngine::resolveMoves(Character& player, Character& bot, int playerMove, int botMove, BattleEventSink& sink) {
+    return resolveMovesImpl(player, bot, playerMove, botMove, sink);
+}
+
+bool BattleEngine::resolveMoves(Character& player, Character& bot, int playerMove, int botMove, NullEventSink sink) {
+    return resolveMovesImpl(player, bot, playerMove, botMove, sink);
+}
+
+BattleResult BattleEngine::runBattle(const Character& playerProto, const Character& botProto,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, uint64_t seed, int maxRounds, vector<uint8_t>* movePairs) {
+    // Pooled copies: after the first battle on a thread this allocates nothing
+    CharacterPool& pool = CharacterPool::local();
+    CharacterPool::Scope scope(pool);
+    Character& player = pool.acquire(playerProto);
+    Character& bot = pool.acquire(botProto);
+
+    Rng rng(seed);
+    return playBattle(player, bot, playerPolicy, botPolicy, rng, maxRounds, movePairs);
+}
+
+BattleResult BattleEngine::playBattle(Character& player, Character& bot,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, Rng& rng, int maxRounds, vector<uint8_t>* movePairs) {
+    if (BuiltinBattleKernel kernel = builtinBattleKernel(player, bot)) {
+        return kernel(player, bot, playerPolicy, botPolicy, rng, maxRounds, movePairs);
+    }
+    return playGenericBattle(player, bot, playerPolicy, botPolicy, rng, maxRounds, movePairs);
+}
+
+BattleResult BattleEngine::playGenericBattle(Character& player, Character& bot,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, Rng& rng, int maxRounds, vector<uint8_t>* movePairs) {
+    int rounds = 0;
+    while (!eitherDefeated(player, bot) && rounds < maxRounds) {
+        int round = rounds++;
+        bool over;
+        {
+            MetricTimer timer(MetricHistogram::ROUND_BEGIN, MetricTimer::SAMPLED);
+            over = beginRound(player, bot);
+        }
+        if (over) break;
+        int playerMove, botMove;
+        {
+            MetricTimer timer(MetricHistogram::ROUND_CHOOSE, MetricTimer::SAMPLED);
+            playerMove = playerPolicy.chooseMove(player, bot, BattleSide::PLAYER, round, rng);
+            botMove = botPolicy.chooseMove(bot, player, BattleSide::BOT, round, rng);
+        }
+        if (movePairs) movePairs->push_back(static_cast<uint8_t>(playerMove << 2 | botMove));
+        MetricTimer timer(MetricHistogram::ROUND_RESOLVE, MetricTimer::SAMPLED);
+        resolveMoves(player, bot, playerMove, botMove);
+    }
+    Metrics::record(MetricHistogram::BATTLE_ROUNDS, static_cast<uint64_t>(rounds));
+    return resultOf(player, bot, rounds);
+}
+
+BattleResult BattleEngine::resultOf(const Character& player, const Character& bot, int rounds) {
+    BattleResult result;
+    result.rounds = rounds;
+    result.playerHp = player.getCurrentHp();
+    result.botHp = bot.getCurrentHp();
+    if (player.isDefeated() && bot.isDefeated()) result.outcome = BattleOutcome::DOUBLE_KO;
+    else if (bot.isDefeated()) result.outcome = BattleOutcome::PLAYER_WINS;
+    else if (player.isDefeated()) result.outcome = BattleOutcome::BOT_WINS;
+    else result.outcome = BattleOutcome::ROUND_LIMIT;
+    return result;
+}
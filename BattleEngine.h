@@ -0,0 +1,101 @@
+#ifndef BATTLEENGINE_H
+#define BATTLEENGINE_H
+
+#include "Character.h"
+#include "AISystem.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// How one side of a headless battle picks its moves
+struct MovePolicy {
+    enum class Kind {
+        AI,
+        SCRIPTED,
+        RANDOM // Uniform over the three moves; needs no character state
+    };
+
+    Kind kind = Kind::AI;
+    AIDifficulty difficulty = AIDifficulty::HARD;
+    std::vector<int> script; // Moves 1-3, replayed from the start when exhausted
+
+    static MovePolicy ai(AIDifficulty difficulty);
+    static MovePolicy scripted(std::vector<int> moves);
+    static MovePolicy random();
+
+    // side is self's seat in the battle
+    int chooseMove(const Character& self, const Character& opponent, BattleSide side, int round, Rng& rng) const;
+    // Exact chance of each move chooseMove returns (index 0 = Rock)
+    std::array<double, 3> moveDistribution(const Character& self, const Character& opponent, BattleSide side, int round) const;
+};
+
+enum class BattleOutcome {
+    PLAYER_WINS,
+    BOT_WINS,
+    DOUBLE_KO,
+    ROUND_LIMIT
+};
+
+struct BattleResult {
+    BattleOutcome outcome = BattleOutcome::ROUND_LIMIT;
+    int rounds = 0;
+    int playerHp = 0;
+    int botHp = 0;
+};
+
+// Round rules shared by Game, GauntletGame and the headless simulator.
+// The phase functions return true once either fighter is defeated, so
+// interactive callers can print between phases exactly as before. Each comes
+// in two flavours: one reporting to a runtime sink, and a NullEventSink one
+// with all event reporting compiled out.
+class BattleEngine {
+public:
+    static const int DEFAULT_MAX_ROUNDS = 1000;
+
+    // 0 = tie, 1 = first move wins, 2 = second move wins
+    static int getRPSWinner(int playerMove, int botMove);
+
+    static bool beginRound(Character& player, Character& bot, BattleEventSink& sink);
+    static bool beginRound(Character& player, Character& bot, NullEventSink sink = {});
+    static bool resolveTie(Character& player, Character& bot, BattleEventSink& sink);
+    static bool resolveTie(Character& player, Character& bot, NullEventSink sink = {});
+    // Returns damage dealt
+    static int strike(Character& attacker, Character& defender, int move, BattleEventSink& sink);
+    static int strike(Character& attacker, Character& defender, int move, NullEventSink sink = {});
+    static bool afterStrike(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, BattleEventSink& sink);
+    static bool afterStrike(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, NullEventSink sink = {});
+    static bool resolveMoves(Character& player, Character& bot, int playerMove, int botMove, BattleEventSink& sink);
+    static bool resolveMoves(Character& player, Character& bot, int playerMove, int botMove, NullEventSink sink = {});
+
+    // Plays a full silent battle on copies of the two prototypes. With
+    // movePairs set, every round's moves are appended as (playerMove << 2 | botMove).
+    static BattleResult runBattle(const Character& playerProto, const Character& botProto,
+        const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+        uint64_t seed, int maxRounds = DEFAULT_MAX_ROUNDS, std::vector<uint8_t>* movePairs = nullptr);
+    // Same, on live instances: HP and buffs carry in and out (the Gauntlet's player).
+    // Matchups between two built-ins take their compiled kernel (BuiltinKernel.h).
+    static BattleResult playBattle(Character& player, Character& bot,
+        const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+        Rng& rng, int maxRounds = DEFAULT_MAX_ROUNDS, std::vector<uint8_t>* movePairs = nullptr);
+    // The data-driven loop behind playBattle, whoever is fighting
+    static BattleResult playGenericBattle(Character& player, Character& bot,
+        const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+        Rng& rng, int maxRounds = DEFAULT_MAX_ROUNDS, std::vector<uint8_t>* movePairs = nullptr);
+
+    // Outcome and HP of a battle that stopped after the given number of rounds
+    static BattleResult resultOf(const Character& player, const Character& bot, int rounds);
+
+private:
+    template <class Sink>
+    static bool beginRoundImpl(Character& player, Character& bot, Sink& sink);
+    template <class Sink>
+    static bool resolveTieImpl(Character& player, Character& bot, Sink& sink);
+    template <class Sink>
+    static int strikeImpl(Character& attacker, Character& defender, int move, Sink& sink);
+    template <class Sink>
+    static bool afterStrikeImpl(Character& attacker, Character& defender, int attackerMove, int defenderMove, int defenderHpBefore, Sink& sink);
+    template <class Sink>
+    static bool resolveMovesImpl(Character& player, Character& bot, int playerMove, int botMove, Sink& sink);
+};
+
+#endif // BATTLEENGINE_H
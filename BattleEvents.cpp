@@ -0,0 +1,72 @@
+#include "BattleEvents.h"
+#include "Character.h"
+
+using namespace std;
+
+ConsoleEventSink::ConsoleEventSink(ostream& out) : out(out) {}
+
+void ConsoleEventSink::record(const BattleEvent& e) {
+    const Passive* p = e.passive;
+    switch (e.type) {
+    case BattleEventType::PASSIVE_TRIGGERED:
+        out << e.source->getName() << "'s passive triggered (" << p->getDescription() << ")!\n";
+        break;
+    case BattleEventType::HEAL:
+        if (p && p->effect == PassiveEffect::HEAL_SELF_PERCENT_CURRENT) {
+            out << "  Healed " << e.amount << " HP (" << p->value << "% of current HP).\n";
+        }
+        else {
+            out << "  Healed " << e.amount << " HP.\n";
+        }
+        break;
+    case BattleEventType::DAMAGE:
+        if (!p) break; // Attack damage is announced by the battle screen
+        if (p->effect == PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT) {
+            out << "  Dealt " << e.amount << " damage to " << e.target->getName() << " (" << p->value << "% of their current HP).\n";
+        }
+        else {
+            out << "  Dealt " << e.amount << " damage to " << e.target->getName() << ".\n";
+        }
+        break;
+    case BattleEventType::NEXT_ATTACK_BUFF:
+        out << "  Next attack + " << e.amount << " damage.\n";
+        break;
+    case BattleEventType::PERMANENT_BUFF: {
+        const char* moveName = e.move == 1 ? "Rock" : (e.move == 2 ? "Paper" : "Scissors");
+        out << "  " << moveName << " damage permanently increased by " << e.amount << ".\n";
+        break;
+    }
+    case BattleEventType::DEFEAT:
+        if (!p) break; // Knock-outs from attacks are announced by the battle screen
+        if (e.target == e.source) {
+            out << e.target->getName() << " was defeated by their own passive effect!?\n";
+        }
+        else {
+            out << e.target->getName() << " was defeated by the passive effect!\n";
+        }
+        break;
+    }
+}
+
+RingBufferEventSink::RingBufferEventSink(size_t capacity)
+    : events(capacity > 0 ? capacity : 1), head(0), count(0) {
+}
+
+void RingBufferEventSink::record(const BattleEvent& event) {
+    events[head] = event;
+    head = (head + 1) % events.size();
+    if (count < events.size()) ++count;
+}
+
+size_t RingBufferEventSink::size() const { return count; }
+size_t RingBufferEventSink::capacity() const { return events.size(); }
+
+const BattleEvent& RingBufferEventSink::at(size_t index) const {
+    size_t oldest = (head + events.size() - count) % events.size();
+    return events[(oldest + index) % events.size()];
+}
+
+void RingBufferEventSink::clear() {
+    head = 0;
+    count = 0;
+}
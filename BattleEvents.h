@@ -0,0 +1,74 @@
+#ifndef BATTLEEVENTS_H
+#define BATTLEEVENTS_H
+
+#include "PassiveSystem.h"
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+class Character;
+
+enum class BattleEventType {
+    PASSIVE_TRIGGERED,
+    HEAL,
+    DAMAGE,
+    NEXT_ATTACK_BUFF,
+    PERMANENT_BUFF,
+    DEFEAT
+};
+
+// One thing that happened during a round. Pointers refer to the live fighters
+// and their passives, so they are only valid while those fighters exist.
+struct BattleEvent {
+    BattleEventType type = BattleEventType::DAMAGE;
+    const Character* source = nullptr;  // Passive owner or attacker
+    const Character* target = nullptr;  // Who was healed, hit or defeated
+    const Passive* passive = nullptr;   // Null for plain RPS attacks
+    int amount = 0;
+    int move = 0;                       // Attack move, or buffed move for PERMANENT_BUFF
+};
+
+// Runtime-pluggable sink. The engine and Character also accept NullEventSink,
+// which compiles every logging statement away for bulk simulation.
+class BattleEventSink {
+public:
+    static constexpr bool enabled = true;
+
+    virtual ~BattleEventSink() = default;
+    virtual void record(const BattleEvent& event) = 0;
+};
+
+struct NullEventSink {
+    static constexpr bool enabled = false;
+    void record(const BattleEvent&) {}
+};
+
+// Prints the same passive narration the game has always shown. Attack
+// headlines are left to the screen that owns the player's perspective.
+class ConsoleEventSink : public BattleEventSink {
+public:
+    explicit ConsoleEventSink(std::ostream& out = std::cout);
+    void record(const BattleEvent& event) override;
+
+private:
+    std::ostream& out;
+};
+
+// Keeps the most recent events in a fixed-size buffer, overwriting the oldest
+class RingBufferEventSink : public BattleEventSink {
+public:
+    explicit RingBufferEventSink(size_t capacity = 256);
+    void record(const BattleEvent& event) override;
+
+    size_t size() const;
+    size_t capacity() const;
+    const BattleEvent& at(size_t index) const; // 0 = oldest retained event
+    void clear();
+
+private:
+    std::vector<BattleEvent> events;
+    size_t head; // Next slot to write
+    size_t count;
+};
+
+#endif // BATTLEEVENTS_H
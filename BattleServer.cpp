@@ -0,0 +1,660 @@
+#include "BattleServer.h"
+#include "CharacterManager.h"
+#include "Metrics.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <utility>
+
+#if defined(__linux__)
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(__linux__)
+
+namespace {
+    const size_t K_MAX_LINE = 256;
+    const size_t K_MAX_PENDING_OUTPUT = 1 << 16; // Queued for a client that has stopped reading
+    const size_t K_READ_CHUNK = 4096;
+    const int K_MAX_EVENTS = 512;
+
+    // epoll tags for the server's own descriptors; clients are tagged with their fd
+    const uint64_t K_LISTEN_TAG = UINT64_MAX;
+    const uint64_t K_WAKE_TAG = UINT64_MAX - 1;
+    const uint64_t K_SIGNAL_TAG = UINT64_MAX - 2;
+
+    char moveLetter(int move) {
+        return "?RPS"[move & 3];
+    }
+
+    int parseMove(const string& s) {
+        if (s == "R" || s == "r" || s == "1") return 1;
+        if (s == "P" || s == "p" || s == "2") return 2;
+        if (s == "S" || s == "s" || s == "3") return 3;
+        return 0;
+    }
+
+    bool parseIndex(const string& s, size_t& out) {
+        if (s.empty() || s.size() > 9) return false;
+        size_t value = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + static_cast<size_t>(c - '0');
+        }
+        out = value;
+        return true;
+    }
+
+    bool parseDifficulty(const string& s, AIDifficulty& out) {
+        if (s == "easy") { out = AIDifficulty::EASY; return true; }
+        if (s == "hard") { out = AIDifficulty::HARD; return true; }
+        if (s == "optimal") { out = AIDifficulty::OPTIMAL; return true; }
+        if (s == "lookahead") { out = AIDifficulty::LOOKAHEAD; return true; }
+        return false;
+    }
+
+    vector<string> splitWords(const string& line) {
+        vector<string> words;
+        size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && line[i] == ' ') ++i;
+            size_t start = i;
+            while (i < line.size() && line[i] != ' ') ++i;
+            if (i > start) words.push_back(line.substr(start, i - start));
+        }
+        return words;
+    }
+
+    const char* outcomeWord(BattleOutcome outcome) {
+        switch (outcome) {
+        case BattleOutcome::PLAYER_WINS: return "WIN";
+        case BattleOutcome::BOT_WINS: return "LOSS";
+        case BattleOutcome::DOUBLE_KO: return "DRAW";
+        default: return "LIMIT";
+        }
+    }
+}
+
+struct BattleServer::Impl {
+    // What an AI worker needs for one decision. Reused round after round;
+    // a job that was abandoned mid-think keeps its own until it finishes.
+    struct AiRequest {
+        unique_ptr<Character> bot;
+        unique_ptr<Character> player;
+        AIDifficulty difficulty = AIDifficulty::HARD;
+        Rng rng;
+        int fd = -1;
+        uint64_t serial = 0;
+        uint64_t ticket = 0;
+    };
+
+    struct Completion {
+        int fd;
+        uint64_t serial;
+        uint64_t ticket;
+        int move;
+    };
+
+    // One connection and the battle it is playing, like Game for one player
+    struct Session {
+        int fd = -1;
+        uint64_t serial = 0;      // Tells this connection apart from a later one on the same fd
+        string in;
+        string out;
+        bool flushQueued = false;
+        bool watchingWrites = false;
+        bool closing = false;     // Hang up once out is sent
+        Rng rng;
+
+        bool inBattle = false;
+        unique_ptr<Character> player;
+        unique_ptr<Character> bot;
+        AIDifficulty difficulty = AIDifficulty::HARD;
+        int round = 0;
+        uint64_t ticket = 0;      // The AI decision this round waits for; bumped to drop stale ones
+        bool thinking = false;    // request is with a worker
+        int playerMove = 0;       // 0 until known
+        int botMove = 0;
+        shared_ptr<AiRequest> request;
+    };
+
+    ServerOptions options;
+    ServerStats stats;
+    Rng root;
+    unique_ptr<ThreadPool> pool;
+
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    int signalFd = -1;
+    int spareFd = -1; // Given up to accept() and close a connection when out of descriptors
+    bool socketBound = false;
+    sigset_t savedMask;
+    bool maskSaved = false;
+
+    vector<unique_ptr<Session>> sessions; // Indexed by fd
+    size_t activeSessions = 0;
+    uint64_t nextSerial = 1;
+    vector<int> flushList;
+
+    atomic<bool> stopping{ false };
+    mutex completionMutex;
+    vector<Completion> completions; // Filled by workers, drained by the loop
+    vector<Completion> draining;
+
+    explicit Impl(ServerOptions o) : options(std::move(o)), root(options.seed ? Rng(options.seed) : Rng::fromEntropy()) {}
+
+    ~Impl() {
+        if (pool) pool->wait();
+        pool.reset();
+        for (auto& s : sessions) {
+            if (s) ::close(s->fd);
+        }
+        for (int fd : { listenFd, epollFd, wakeFd, signalFd, spareFd }) {
+            if (fd >= 0) ::close(fd);
+        }
+        if (socketBound) ::unlink(options.socketPath.c_str());
+        if (maskSaved) pthread_sigmask(SIG_SETMASK, &savedMask, nullptr);
+    }
+
+    bool watch(int fd, uint32_t events, uint64_t tag, int op = EPOLL_CTL_ADD) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = tag;
+        return epoll_ctl(epollFd, op, fd, &ev) == 0;
+    }
+
+    bool bindSocket() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+            cerr << "Error: socket path must be 1-" << sizeof(address.sun_path) - 1 << " bytes." << endl;
+            return false;
+        }
+        memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+
+        // A socket file nobody answers on is left over from a server that died
+        struct stat info;
+        if (lstat(options.socketPath.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                cerr << "Error: " << options.socketPath << " exists and is not a socket." << endl;
+                return false;
+            }
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            if (probe >= 0) ::close(probe);
+            if (live) {
+                cerr << "Error: a server is already listening on " << options.socketPath << "." << endl;
+                return false;
+            }
+            ::unlink(options.socketPath.c_str());
+        }
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            cerr << "Error: cannot bind " << options.socketPath << ": " << strerror(errno) << endl;
+            return false;
+        }
+        socketBound = true;
+        if (listen(listenFd, SOMAXCONN) != 0) {
+            cerr << "Error: cannot listen on " << options.socketPath << ": " << strerror(errno) << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool start() {
+        size_t limit = raiseOpenFileLimit();
+        if (limit < options.maxSessions + 16) {
+            cerr << "Warning: only " << limit << " file descriptors available; about "
+                << (limit > 16 ? limit - 16 : 0) << " sessions will fit." << endl;
+        }
+
+        // SIGINT and SIGTERM are read from a signalfd, so block them before
+        // the workers start and inherit the mask
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &mask, &savedMask);
+        maskSaved = true;
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0 || signalFd < 0) {
+            cerr << "Error: cannot set up the event loop: " << strerror(errno) << endl;
+            return false;
+        }
+        if (!bindSocket()) return false;
+        if (!watch(listenFd, EPOLLIN, K_LISTEN_TAG) || !watch(wakeFd, EPOLLIN, K_WAKE_TAG)
+            || !watch(signalFd, EPOLLIN, K_SIGNAL_TAG)) {
+            cerr << "Error: epoll_ctl failed: " << strerror(errno) << endl;
+            return false;
+        }
+
+        pool = make_unique<ThreadPool>(options.threads);
+        return true;
+    }
+
+    // Called from workers: hand a decision back and wake the loop if it may be asleep
+    void complete(const Completion& c) {
+        bool wasEmpty;
+        {
+            lock_guard<mutex> lock(completionMutex);
+            wasEmpty = completions.empty();
+            completions.push_back(c);
+        }
+        if (wasEmpty) wake();
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void send(Session& s, const string& line) {
+        s.out += line;
+        s.out += '\n';
+        if (!s.flushQueued) {
+            s.flushQueued = true;
+            flushList.push_back(s.fd);
+        }
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if ((errno == EMFILE || errno == ENFILE) && spareFd >= 0) {
+                    // Out of descriptors: use the spare to take the connection off the
+                    // backlog and drop it, or the listening socket would stay readable forever
+                    ::close(spareFd);
+                    int dropped = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (dropped >= 0) ::close(dropped);
+                    spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                    ++stats.refused;
+                    continue;
+                }
+                return; // EAGAIN, or nothing to be done until a session closes
+            }
+            if (activeSessions >= options.maxSessions) {
+                static const char K_FULL[] = "ERR server full\n";
+                ssize_t ignored = ::send(fd, K_FULL, sizeof(K_FULL) - 1, MSG_NOSIGNAL);
+                (void)ignored;
+                ::close(fd);
+                ++stats.refused;
+                continue;
+            }
+            if (!watch(fd, EPOLLIN | EPOLLRDHUP, static_cast<uint64_t>(fd))) {
+                ::close(fd);
+                continue;
+            }
+
+            if (sessions.size() <= static_cast<size_t>(fd)) sessions.resize(fd + 1);
+            auto session = make_unique<Session>();
+            session->fd = fd;
+            session->serial = nextSerial++;
+            session->rng = root.fork(session->serial);
+            session->difficulty = options.difficulty;
+            sessions[fd] = std::move(session);
+            ++activeSessions;
+            ++stats.connections;
+            stats.peakSessions = max(stats.peakSessions, activeSessions);
+            send(*sessions[fd], "HELLO picbattle 1");
+        }
+    }
+
+    void closeSession(int fd) {
+        // Closing the fd takes it out of the epoll set; an AI job still running
+        // for it finds a different serial, or nobody, when it completes
+        ::close(fd);
+        sessions[fd].reset();
+        --activeSessions;
+    }
+
+    void readClient(Session& s) {
+        char buffer[K_READ_CHUNK];
+        ssize_t n = ::read(s.fd, buffer, sizeof(buffer));
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+        if (n <= 0) {
+            closeSession(s.fd);
+            return;
+        }
+        s.in.append(buffer, static_cast<size_t>(n));
+
+        size_t start = 0;
+        while (!s.closing) {
+            size_t end = s.in.find('\n', start);
+            if (end == string::npos) break;
+            size_t length = end - start;
+            if (length > 0 && s.in[end - 1] == '\r') --length;
+            handleLine(s, s.in.substr(start, length));
+            start = end + 1;
+        }
+        s.in.erase(0, start);
+        if (s.in.size() > K_MAX_LINE && !s.closing) {
+            send(s, "ERR line too long");
+            s.closing = true;
+        }
+        if (s.closing) s.in.clear();
+    }
+
+    void handleLine(Session& s, const string& line) {
+        vector<string> words = splitWords(line);
+        if (words.empty()) return;
+        const string& command = words[0];
+        if (command == "MOVE") handleMove(s, words);
+        else if (command == "NEW") handleNew(s, words);
+        else if (command == "LIST") handleList(s, words);
+        else if (command == "QUIT") {
+            send(s, "BYE");
+            s.closing = true;
+        }
+        else send(s, "ERR unknown command " + command.substr(0, 32));
+    }
+
+    void handleList(Session& s, const vector<string>& words) {
+        size_t first = 0, count = availableCharacters.size();
+        if ((words.size() > 1 && !parseIndex(words[1], first)) || (words.size() > 2 && !parseIndex(words[2], count))) {
+            send(s, "ERR usage: LIST [FIRST [COUNT]]");
+            return;
+        }
+        first = min(first, availableCharacters.size());
+        count = min(count, availableCharacters.size() - first);
+        send(s, "FIGHTERS " + to_string(count) + " " + to_string(availableCharacters.size()));
+        for (size_t id = first; id < first + count; ++id) {
+            const Character& c = *availableCharacters[static_cast<CharacterId>(id)];
+            send(s, "F " + to_string(id) + " " + to_string(c.getMaxHp()) + " " + to_string(c.getRockDamage()) + " "
+                + to_string(c.getPaperDamage()) + " " + to_string(c.getScissorsDamage()) + " " + c.getName());
+        }
+    }
+
+    void handleNew(Session& s, const vector<string>& words) {
+        size_t count = availableCharacters.size();
+        size_t playerId = 0, botId = count;
+        AIDifficulty difficulty = options.difficulty;
+        bool ok = words.size() >= 2 && words.size() <= 4 && parseIndex(words[1], playerId) && playerId < count;
+        if (ok && words.size() >= 3 && words[2] != "-") ok = parseIndex(words[2], botId) && botId < count;
+        if (ok && words.size() == 4) ok = parseDifficulty(words[3], difficulty);
+        if (!ok) {
+            send(s, "ERR usage: NEW <id> [<bot id>|-] [easy|hard|optimal|lookahead]");
+            return;
+        }
+        if (botId == count) {
+            // A random opponent other than the player, as Game picks one
+            if (count == 1) botId = playerId;
+            else {
+                botId = static_cast<size_t>(s.rng.nextInt(0, static_cast<int>(count) - 2));
+                if (botId >= playerId) ++botId;
+            }
+        }
+
+        // A battle in progress is abandoned; its pending AI decision is dropped
+        ++s.ticket;
+        s.player = availableCharacters[static_cast<CharacterId>(playerId)]->clone();
+        s.bot = availableCharacters[static_cast<CharacterId>(botId)]->clone();
+        s.player->resetStatsForNewBattle();
+        s.bot->resetStatsForNewBattle();
+        s.difficulty = difficulty;
+        s.round = 0;
+        s.inBattle = true;
+        send(s, "BATTLE " + to_string(botId) + " " + s.bot->getName());
+        startRound(s);
+    }
+
+    void handleMove(Session& s, const vector<string>& words) {
+        int move = words.size() == 2 ? parseMove(words[1]) : 0;
+        if (move == 0) send(s, "ERR usage: MOVE <R|P|S>");
+        else if (!s.inBattle) send(s, "ERR no battle");
+        else if (s.playerMove != 0) send(s, "ERR move already made");
+        else {
+            s.playerMove = move;
+            if (s.botMove != 0) resolveRound(s);
+        }
+    }
+
+    // The top of BattleEngine::playBattle's loop, stopping to wait for the player
+    void startRound(Session& s) {
+        Character& player = *s.player;
+        Character& bot = *s.bot;
+        if (player.isDefeated() || bot.isDefeated() || s.round >= options.maxRounds) {
+            finishBattle(s);
+            return;
+        }
+        ++s.round;
+        ++stats.rounds;
+        bool over;
+        {
+            MetricTimer timer(MetricHistogram::ROUND_BEGIN, MetricTimer::SAMPLED);
+            over = BattleEngine::beginRound(player, bot);
+        }
+        if (over) {
+            finishBattle(s);
+            return;
+        }
+        s.playerMove = 0;
+        s.botMove = 0;
+        send(s, "TURN " + to_string(s.round) + " " + to_string(player.getCurrentHp()) + " " + to_string(bot.getCurrentHp()));
+        requestBotMove(s);
+    }
+
+    // The bot's move does not depend on the player's, so it is worked out
+    // while the client is still deciding
+    void requestBotMove(Session& s) {
+        if (!s.request || s.thinking) s.request = make_shared<AiRequest>();
+        AiRequest& r = *s.request;
+        if (r.bot) *r.bot = *s.bot;
+        else r.bot = s.bot->clone();
+        if (r.player) *r.player = *s.player;
+        else r.player = s.player->clone();
+        r.difficulty = s.difficulty;
+        r.rng = s.rng.split();
+        r.fd = s.fd;
+        r.serial = s.serial;
+        r.ticket = ++s.ticket;
+        s.thinking = true;
+
+        pool->submit([this, request = s.request](unsigned) {
+            AiRequest& r = *request;
+            int move = AISystem::chooseMove(*r.bot, *r.player, r.difficulty, r.rng);
+            complete({ r.fd, r.serial, r.ticket, move });
+        });
+    }
+
+    void takeCompletions() {
+        uint64_t count;
+        ssize_t ignored = ::read(wakeFd, &count, sizeof(count));
+        (void)ignored;
+        {
+            lock_guard<mutex> lock(completionMutex);
+            draining.swap(completions);
+        }
+        for (const Completion& c : draining) {
+            if (static_cast<size_t>(c.fd) >= sessions.size() || !sessions[c.fd]) continue;
+            Session& s = *sessions[c.fd];
+            if (s.serial != c.serial) continue;
+            if (c.ticket == s.request->ticket) s.thinking = false;
+            if (!s.inBattle || c.ticket != s.ticket) continue;
+            s.botMove = c.move;
+            if (s.playerMove != 0) resolveRound(s);
+        }
+        draining.clear();
+    }
+
+    void resolveRound(Session& s) {
+        {
+            MetricTimer timer(MetricHistogram::ROUND_RESOLVE, MetricTimer::SAMPLED);
+            BattleEngine::resolveMoves(*s.player, *s.bot, s.playerMove, s.botMove);
+        }
+        string line = "ROUND ";
+        line += moveLetter(s.playerMove);
+        line += ' ';
+        line += moveLetter(s.botMove);
+        send(s, line + " " + to_string(s.player->getCurrentHp()) + " " + to_string(s.bot->getCurrentHp()));
+        startRound(s);
+    }
+
+    void finishBattle(Session& s) {
+        BattleResult result = BattleEngine::resultOf(*s.player, *s.bot, s.round);
+        Metrics::record(MetricHistogram::BATTLE_ROUNDS, static_cast<uint64_t>(result.rounds));
+        send(s, string("END ") + outcomeWord(result.outcome) + " " + to_string(result.rounds) + " "
+            + to_string(result.playerHp) + " " + to_string(result.botHp));
+        s.inBattle = false;
+        s.playerMove = 0;
+        s.botMove = 0;
+        ++s.ticket;
+        ++stats.battles;
+    }
+
+    // Sends what a session has queued; returns false if it was closed
+    bool flush(Session& s) {
+        while (!s.out.empty()) {
+            ssize_t n = ::send(s.fd, s.out.data(), s.out.size(), MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EAGAIN) break;
+            if (n <= 0) {
+                closeSession(s.fd);
+                return false;
+            }
+            s.out.erase(0, static_cast<size_t>(n));
+        }
+        if (s.out.empty() && s.closing) {
+            closeSession(s.fd);
+            return false;
+        }
+        if (s.out.size() > K_MAX_PENDING_OUTPUT) {
+            closeSession(s.fd);
+            return false;
+        }
+        bool wantWrites = !s.out.empty();
+        if (wantWrites != s.watchingWrites) {
+            s.watchingWrites = wantWrites;
+            // While a reply is stuck, stop reading: the client gets nothing more until it catches up
+            watch(s.fd, wantWrites ? EPOLLOUT | EPOLLRDHUP : EPOLLIN | EPOLLRDHUP, static_cast<uint64_t>(s.fd), EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+
+    void flushQueued() {
+        for (int fd : flushList) {
+            if (!sessions[fd]) continue;
+            sessions[fd]->flushQueued = false;
+            flush(*sessions[fd]);
+        }
+        flushList.clear();
+    }
+
+    int run() {
+        vector<epoll_event> events(K_MAX_EVENTS);
+        while (!stopping.load(memory_order_relaxed)) {
+            int n = epoll_wait(epollFd, events.data(), K_MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                cerr << "Error: epoll_wait failed: " << strerror(errno) << endl;
+                return 1;
+            }
+            for (int i = 0; i < n; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == K_LISTEN_TAG) acceptClients();
+                else if (tag == K_WAKE_TAG) takeCompletions();
+                else if (tag == K_SIGNAL_TAG) stopping = true;
+                else {
+                    int fd = static_cast<int>(tag);
+                    if (!sessions[fd]) continue; // Closed earlier in this batch
+                    Session& s = *sessions[fd];
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) closeSession(fd);
+                    else if (events[i].events & EPOLLOUT) flush(s);
+                    else if (events[i].events & (EPOLLIN | EPOLLRDHUP)) readClient(s);
+                }
+            }
+            flushQueued();
+        }
+        return 0;
+    }
+};
+
+size_t raiseOpenFileLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return 0;
+    if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+BattleServer::BattleServer(ServerOptions options) : impl(make_unique<Impl>(std::move(options))) {}
+
+BattleServer::~BattleServer() = default;
+
+bool BattleServer::start() {
+    return impl->start();
+}
+
+int BattleServer::run() {
+    return impl->run();
+}
+
+void BattleServer::stop() {
+    impl->stopping = true;
+    impl->wake();
+}
+
+const ServerStats& BattleServer::stats() const {
+    return impl->stats;
+}
+
+#else
+
+struct BattleServer::Impl {
+    ServerOptions options;
+    ServerStats stats;
+};
+
+size_t raiseOpenFileLimit() {
+    return 0;
+}
+
+BattleServer::BattleServer(ServerOptions options) : impl(make_unique<Impl>()) {
+    impl->options = std::move(options);
+}
+
+BattleServer::~BattleServer() = default;
+
+bool BattleServer::start() {
+    cerr << "Error: the battle server needs Linux (epoll and Unix domain sockets)." << endl;
+    return false;
+}
+
+int BattleServer::run() {
+    return 1;
+}
+
+void BattleServer::stop() {}
+
+const ServerStats& BattleServer::stats() const {
+    return impl->stats;
+}
+
+#endif
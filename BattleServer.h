@@ -0,0 +1,87 @@
+#ifndef BATTLESERVER_H
+#define BATTLESERVER_H
+
+#include "AISystem.h"
+#include "BattleEngine.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Hosts human-vs-AI battles for many clients at once over a Unix domain
+// socket. One thread runs an epoll loop over every connection; the AI's
+// moves are worked out on a thread pool, so a slow search never holds up
+// the other sessions. Linux only: elsewhere start() fails with a message.
+//
+// The protocol is line based, ASCII, one command or reply per '\n'. Moves
+// are R, P or S (1, 2, 3 are accepted too). On connect the server says
+//
+//   HELLO picbattle 1
+//
+// and then answers these commands:
+//
+//   LIST [FIRST [COUNT]]   FIGHTERS <n> <roster size>, then n lines of
+//                          F <id> <hp> <rock> <paper> <scissors> <name>
+//   NEW <id> [<bot id>|-] [easy|hard|optimal|lookahead]
+//                          BATTLE <bot id> <bot name>, then the first round.
+//                          "-" (the default) picks a random opponent; the
+//                          difficulty defaults to the server's.
+//   MOVE <R|P|S>           ROUND <your move> <bot move> <your hp> <bot hp>,
+//                          then the next round
+//   QUIT                   BYE, and the server hangs up
+//
+// A round opens with TURN <round> <your hp> <bot hp> once the turn-start
+// passives have fired; the AI starts thinking at that point, before the
+// move comes in. A battle closes with
+//
+//   END <WIN|LOSS|DRAW|LIMIT> <rounds> <your hp> <bot hp>
+//
+// Anything the server cannot act on gets ERR <reason> and the connection
+// stays up; a line over 256 bytes, or a client that stops reading, is
+// disconnected.
+
+struct ServerOptions {
+    std::string socketPath = "picbattle.sock";
+    AIDifficulty difficulty = AIDifficulty::HARD; // For NEW without one
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS;
+    unsigned threads = 0;                         // AI workers, 0 = one per hardware thread
+    size_t maxSessions = 10000;                   // Further connections are refused with ERR
+    uint64_t seed = 0;                            // Session RNGs fork from it; 0 = from entropy
+};
+
+struct ServerStats {
+    uint64_t connections = 0;
+    uint64_t refused = 0;
+    uint64_t battles = 0;   // Finished
+    uint64_t rounds = 0;
+    size_t peakSessions = 0;
+};
+
+// Lifts the soft open-file limit to the hard one, so thousands of sockets fit;
+// returns the limit now in force (0 where there is no such thing)
+size_t raiseOpenFileLimit();
+
+class BattleServer {
+public:
+    explicit BattleServer(ServerOptions options);
+    ~BattleServer();
+
+    BattleServer(const BattleServer&) = delete;
+    BattleServer& operator=(const BattleServer&) = delete;
+
+    // Binds the socket (replacing a stale one) and starts the AI workers.
+    // false, with the reason on cerr, if that fails.
+    bool start();
+    // Serves until stop(), SIGINT or SIGTERM; returns 0, or 1 on a fatal error
+    int run();
+    // Safe from any thread or a signal handler's caller; run() returns soon after
+    void stop();
+
+    const ServerStats& stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // BATTLESERVER_H
@@ -0,0 +1,285 @@
+#include "BenchCommand.h"
+#include "Benchmark.h"
+#include "BattleEngine.h"
+#include "CharacterPool.h"
+#include "CharacterManager.h"
+#include "CharacterRegistry.h"
+#include "Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    void printBenchUsage() {
+        cout << "Usage: bench [options]\n"
+            << "  --filter TEXT      Only benchmarks whose name contains TEXT\n"
+            << "  --min-time SEC     Shortest timed batch per benchmark (default 0.2)\n"
+            << "  --repetitions N    Timed batches per benchmark; the median is reported (default 3)\n"
+            << "  --max-rows N       Largest characters.txt to load (default 1000000)\n"
+            << "  --out FILE         Write the JSON there instead of to stdout\n"
+            << "  --baseline FILE    Compare with JSON saved by an earlier run\n"
+            << "  --threshold PCT    Slowdown that counts as a regression (default 10)\n";
+    }
+
+    const uint64_t K_SEED = 1;
+    const size_t K_LOAD_ROWS[] = { 1000, 100000, 1000000 };
+
+    string lowercase(string s) {
+        transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return s;
+    }
+
+    void benchAI(BenchmarkRunner& runner, const vector<const Character*>& builtins) {
+        // Every ordered pairing, so the AI caches see a realistic spread of states
+        vector<unique_ptr<Character>> bots, players;
+        for (const Character* bot : builtins) {
+            for (const Character* player : builtins) {
+                bots.push_back(bot->clone());
+                players.push_back(player->clone());
+            }
+        }
+
+        for (AIDifficulty difficulty : { AIDifficulty::EASY, AIDifficulty::HARD, AIDifficulty::OPTIMAL }) {
+            runner.run("ai.choose_move." + lowercase(difficultyName(difficulty)), [&](uint64_t n) {
+                Rng rng(K_SEED);
+                uint64_t sum = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    size_t pair = i % bots.size();
+                    sum += AISystem::chooseMove(*bots[pair], *players[pair], difficulty, rng);
+                }
+                keepValue(sum);
+                return uint64_t(0);
+            });
+        }
+    }
+
+    void benchPassives(BenchmarkRunner& runner, const Character& opponentProto) {
+        for (int t = 1; t < PASSIVE_TRIGGER_COUNT; ++t) {
+            PassiveTrigger trigger = static_cast<PassiveTrigger>(t);
+            // A passive that always fires but changes nothing, so every op does the same work
+            Character self("Bench", 20, 1, 2, 3, { Passive(trigger, PassiveEffect::HEAL_SELF_FLAT, 0, 50) });
+            unique_ptr<Character> opponent = opponentProto.clone();
+            if (trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) self.takeDamage(15);
+
+            int move = 0;
+            bool didWin = false;
+            if (t >= static_cast<int>(PassiveTrigger::ON_WIN_ROCK) && t <= static_cast<int>(PassiveTrigger::ON_WIN_SCISSORS)) {
+                move = t;
+                didWin = true;
+            }
+            else if (t >= static_cast<int>(PassiveTrigger::ON_LOSE_ROCK) && t <= static_cast<int>(PassiveTrigger::ON_LOSE_SCISSORS)) {
+                move = t - 3;
+            }
+
+            runner.run(string("passive.") + passiveTriggerKey(trigger), [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    self.resetTurnState();
+                    self.checkAndApplyPassives(trigger, self, *opponent, move, didWin);
+                }
+                keepValue(static_cast<uint64_t>(self.getCurrentHp()));
+                return uint64_t(0);
+            });
+        }
+
+        const string texts[] = { "9,1,2,0", "8,3,4,40", "1,4,1,0", "11,7,25,0" };
+        runner.run("passive.from_string", [&](uint64_t n) {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < n; ++i) sum += Passive::fromString(texts[i % 4]).value;
+            keepValue(sum);
+            return uint64_t(0);
+        });
+
+        const Passive passives[] = {
+            Passive(PassiveTrigger::ON_TURN_START, PassiveEffect::HEAL_SELF_FLAT, 2),
+            Passive(PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_NEXT_ATTACK_FLAT, 4, 40),
+            Passive(PassiveTrigger::ON_WIN_ROCK, PassiveEffect::INCREASE_ROCK_DMG_PERM, 1),
+            Passive(PassiveTrigger::AFTER_TAKING_HIT, PassiveEffect::HEAL_SELF_PERCENT_CURRENT, 25)
+        };
+        runner.run("passive.to_string", [&](uint64_t n) {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < n; ++i) sum += passives[i % 4].toString().size();
+            keepValue(sum);
+            return uint64_t(0);
+        });
+    }
+
+    void benchBattles(BenchmarkRunner& runner, const vector<const Character*>& builtins) {
+        const MovePolicy policy = MovePolicy::ai(AIDifficulty::HARD);
+        for (const Character* player : builtins) {
+            for (const Character* bot : builtins) {
+                runner.run("battle." + lowercase(player->getName()) + "_vs_" + lowercase(bot->getName()), [&](uint64_t n) {
+                    const Rng root(K_SEED);
+                    uint64_t rounds = 0;
+                    for (uint64_t i = 0; i < n; ++i) {
+                        rounds += BattleEngine::runBattle(*player, *bot, policy, policy, root.fork(i).next()).rounds;
+                    }
+                    return max<uint64_t>(rounds, 1); // Items = rounds played
+                });
+            }
+        }
+    }
+
+    // The whole built-in ladder under random moves, where the round rules rather
+    // than the AI dominate: once through the compiled kernels, once data-driven
+    void benchLadder(BenchmarkRunner& runner, const vector<const Character*>& builtins) {
+        const MovePolicy policy = MovePolicy::random();
+        for (bool kernels : { true, false }) {
+            runner.run(string("ladder.builtin.") + (kernels ? "kernel" : "generic"), [&](uint64_t n) {
+                CharacterPool& pool = CharacterPool::local();
+                const Rng root(K_SEED);
+                uint64_t rounds = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    CharacterPool::Scope scope(pool);
+                    Character& player = pool.acquire(*builtins[i % builtins.size()]);
+                    Character& bot = pool.acquire(*builtins[(i / builtins.size()) % builtins.size()]);
+                    Rng rng = root.fork(i);
+                    rounds += (kernels ? BattleEngine::playBattle(player, bot, policy, policy, rng)
+                        : BattleEngine::playGenericBattle(player, bot, policy, policy, rng)).rounds;
+                }
+                return max<uint64_t>(rounds, 1);
+            });
+        }
+    }
+
+    // loadCharacters reads the working directory, so each size gets its own scratch directory
+    void benchLoad(BenchmarkRunner& runner, size_t maxRows) {
+        error_code ec;
+        filesystem::path home = filesystem::current_path();
+        filesystem::path scratch = filesystem::temp_directory_path(ec) /
+            ("picbattle_bench_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+
+        for (size_t rows : K_LOAD_ROWS) {
+            if (rows > maxRows) continue;
+            string name = "load.characters_txt." + to_string(rows);
+            if (!runner.selected(name)) continue;
+
+            filesystem::create_directories(scratch, ec);
+            {
+                ofstream out(scratch / SAVE_FILE, ios::binary);
+                out << "# Format: TYPE;NAME;HP;ROCK;PAPER;SCISSORS;PASSIVE1_STR;PASSIVE2_STR;...\n";
+                for (size_t i = 0; i < rows; ++i) {
+                    out << "CUSTOM;Bench" << i << ";" << (20 + i % 80) << ";" << (i % 7) << ";" << (i % 9) << ";" << (i % 11);
+                    if (i % 2 == 0) out << ";" << (1 + i % 11) << "," << (1 + i % 8) << "," << (i % 20) << ",0";
+                    out << "\n";
+                }
+                if (!out) {
+                    cerr << "Error: Could not write " << (scratch / SAVE_FILE).string() << endl;
+                    break;
+                }
+            }
+
+            filesystem::current_path(scratch, ec);
+            streambuf* console = cout.rdbuf(nullptr); // loadCharacters narrates every load
+            runner.run(name, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) loadCharacters();
+                return n * rows;
+            });
+            cout.rdbuf(console);
+            cout.clear();
+            filesystem::current_path(home, ec);
+            filesystem::remove_all(scratch, ec);
+        }
+        availableCharacters.clear();
+    }
+}
+
+int runBenchCommand(int argc, char* argv[]) {
+    string filter;
+    double minSeconds = 0.2;
+    int repetitions = 3;
+    size_t maxRows = K_LOAD_ROWS[2];
+    string outPath;
+    string baselinePath;
+    double thresholdPercent = 10.0;
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printBenchUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--filter") filter = value;
+            else if (opt == "--min-time") minSeconds = stod(value);
+            else if (opt == "--repetitions") repetitions = stoi(value);
+            else if (opt == "--max-rows") maxRows = static_cast<size_t>(stoull(value));
+            else if (opt == "--out") outPath = value;
+            else if (opt == "--baseline") baselinePath = value;
+            else if (opt == "--threshold") thresholdPercent = stod(value);
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || minSeconds <= 0 || repetitions < 1 || thresholdPercent < 0) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printBenchUsage();
+            return 1;
+        }
+    }
+
+    vector<BenchmarkResult> baseline;
+    if (!baselinePath.empty() && !readBenchmarkJson(baselinePath, baseline)) {
+        cerr << "Error: Could not open " << baselinePath << endl;
+        return 1;
+    }
+
+    // The built-ins on their own, so the benchmarks never depend on the saved roster
+    CharacterRegistry roster;
+    addBuiltinCharacters(roster);
+    vector<const Character*> builtins;
+    for (const auto& c : roster) builtins.push_back(c.get());
+
+    setAllocationCounting(true);
+    BenchmarkRunner runner(minSeconds, repetitions, filter);
+    benchAI(runner, builtins);
+    benchPassives(runner, *builtins[0]);
+    benchBattles(runner, builtins);
+    benchLadder(runner, builtins);
+    benchLoad(runner, maxRows);
+
+    // Progress and the comparison go to cerr, so stdout stays pure JSON
+    cerr << fixed << setprecision(1);
+    for (const BenchmarkResult& r : runner.results()) {
+        cerr << left << setw(36) << r.name << right << setw(14) << r.nsPerOp << " ns/op"
+            << setw(16) << r.itemsPerSecond << " items/s" << setw(10) << r.allocsPerOp << " allocs/op\n";
+    }
+
+    if (outPath.empty()) {
+        writeBenchmarkJson(cout, runner.results(), minSeconds, repetitions);
+    }
+    else {
+        ofstream out(outPath);
+        if (!out) {
+            cerr << "Error: Could not open " << outPath << " for writing!" << endl;
+            return 1;
+        }
+        writeBenchmarkJson(out, runner.results(), minSeconds, repetitions);
+        cerr << "Benchmarks written to " << outPath << endl;
+    }
+
+    if (baselinePath.empty()) return 0;
+
+    vector<BenchmarkComparison> comparisons = compareBenchmarks(baseline, runner.results(), thresholdPercent / 100.0);
+    int regressions = 0;
+    cerr << "\n=== Compared with " << baselinePath << " (threshold " << thresholdPercent << "%) ===\n";
+    for (const BenchmarkComparison& c : comparisons) {
+        const char* verdict = c.regressed ? "REGRESSION" : c.improved ? "improved" : "";
+        cerr << left << setw(36) << c.name << right << setw(14) << c.baselineNs << " -> " << setw(14) << c.currentNs
+            << " ns/op " << showpos << setw(8) << 100 * c.change << noshowpos << "%  " << verdict << "\n";
+        if (c.regressed) ++regressions;
+    }
+    cerr << regressions << " regression(s) in " << comparisons.size() << " compared benchmark(s)" << endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+#ifndef BENCHCOMMAND_H
+#define BENCHCOMMAND_H
+
+// Entry point for "bench": micro- and macro-benchmarks, reported as JSON and
+// optionally compared with a saved baseline (exit code 1 on a regression)
+int runBenchCommand(int argc, char* argv[]);
+
+#endif // BENCHCOMMAND_H
@@ -0,0 +1,199 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Off outside "bench": then operator new only reads the flag, which no
+    // one writes, instead of bumping a counter every thread shares
+    atomic<bool> countingAllocations{ false };
+    atomic<uint64_t> allocations{ 0 };
+
+    volatile uint64_t keptValue = 0;
+
+    // Longest a calibration batch may grow in one step
+    const double K_MAX_GROWTH = 10.0;
+
+    // Value of "key": in one JSON object's text, as written by writeBenchmarkJson
+    bool findField(const string& object, const string& key, string& value) {
+        size_t at = object.find("\"" + key + "\"");
+        if (at == string::npos) return false;
+        size_t colon = object.find(':', at);
+        if (colon == string::npos) return false;
+        size_t start = object.find_first_not_of(" \t\r\n", colon + 1);
+        if (start == string::npos) return false;
+        if (object[start] == '"') {
+            size_t end = object.find('"', start + 1);
+            if (end == string::npos) return false;
+            value = object.substr(start + 1, end - start - 1);
+        }
+        else {
+            size_t end = object.find_first_of(",}\r\n", start);
+            value = object.substr(start, end == string::npos ? string::npos : end - start);
+        }
+        return true;
+    }
+}
+
+void* operator new(size_t size) {
+    if (countingAllocations.load(memory_order_relaxed)) allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void setAllocationCounting(bool enabled) {
+    countingAllocations.store(enabled, memory_order_relaxed);
+}
+
+uint64_t allocationCount() {
+    return allocations.load(memory_order_relaxed);
+}
+
+void keepValue(uint64_t value) {
+    keptValue = keptValue + value;
+}
+
+BenchmarkRunner::BenchmarkRunner(double minSeconds, int repetitions, string filter)
+    : minSeconds(minSeconds), repetitions(max(1, repetitions)), filter(std::move(filter)) {
+}
+
+bool BenchmarkRunner::selected(const string& name) const {
+    return filter.empty() || name.find(filter) != string::npos;
+}
+
+void BenchmarkRunner::run(const string& name, const function<uint64_t(uint64_t)>& body) {
+    if (!selected(name)) return;
+    body(1); // Warm-up: caches, pools and lazy tables
+
+    struct Batch {
+        double seconds;
+        uint64_t items;
+        uint64_t allocated;
+    };
+    auto timeBatch = [&](uint64_t iterations) {
+        uint64_t allocationsBefore = allocationCount();
+        auto start = chrono::steady_clock::now();
+        uint64_t items = body(iterations);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return Batch{ seconds, items, allocationCount() - allocationsBefore };
+    };
+
+    uint64_t iterations = 1;
+    vector<Batch> batches{ timeBatch(iterations) };
+    while (batches.back().seconds < minSeconds) {
+        // Aim a little past the target so the next batch usually is long enough
+        double seconds = batches.back().seconds;
+        double growth = seconds > 0 ? minSeconds * 1.4 / seconds : K_MAX_GROWTH;
+        iterations = static_cast<uint64_t>(iterations * clamp(growth, 2.0, K_MAX_GROWTH));
+        batches.assign(1, timeBatch(iterations));
+    }
+    while (static_cast<int>(batches.size()) < repetitions) batches.push_back(timeBatch(iterations));
+
+    // The median batch shrugs off a preempted one in either direction
+    sort(batches.begin(), batches.end(), [](const Batch& a, const Batch& b) { return a.seconds < b.seconds; });
+    const Batch& median = batches[batches.size() / 2];
+
+    BenchmarkResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.nsPerOp = median.seconds * 1e9 / iterations;
+    r.opsPerSecond = iterations / median.seconds;
+    r.itemsPerOp = median.items ? static_cast<double>(median.items) / iterations : 1.0;
+    r.itemsPerSecond = r.opsPerSecond * r.itemsPerOp;
+    r.allocsPerOp = static_cast<double>(median.allocated) / iterations;
+    measured.push_back(r);
+}
+
+void writeBenchmarkJson(ostream& out, const vector<BenchmarkResult>& results, double minSeconds, int repetitions) {
+    out << "{\n";
+    out << "  \"context\": {\"hardware_threads\": " << thread::hardware_concurrency()
+        << ", \"min_seconds\": " << minSeconds << ", \"repetitions\": " << repetitions
+#if defined(NDEBUG)
+        << ", \"build\": \"release\""
+#else
+        << ", \"build\": \"debug\""
+#endif
+        << "},\n";
+    out << "  \"benchmarks\": [\n";
+    out << setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        // One object per line keeps diffs of saved baselines readable
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.nsPerOp << ", \"ops_per_sec\": " << r.opsPerSecond
+            << ", \"items_per_op\": " << r.itemsPerOp << ", \"items_per_sec\": " << r.itemsPerSecond
+            << ", \"allocs_per_op\": " << r.allocsPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool readBenchmarkJson(const string& path, vector<BenchmarkResult>& out) {
+    ifstream in(path);
+    if (!in) return false;
+    ostringstream buffer;
+    buffer << in.rdbuf();
+    string text = buffer.str();
+
+    // Every benchmark is a flat object, so splitting at '}' isolates each one
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('}', pos);
+        if (end == string::npos) break;
+        string object = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        string name, value;
+        if (!findField(object, "name", name)) continue;
+        BenchmarkResult r;
+        r.name = name;
+        try {
+            if (findField(object, "iterations", value)) r.iterations = stoull(value);
+            if (findField(object, "ns_per_op", value)) r.nsPerOp = stod(value);
+            if (findField(object, "ops_per_sec", value)) r.opsPerSecond = stod(value);
+            if (findField(object, "items_per_op", value)) r.itemsPerOp = stod(value);
+            if (findField(object, "items_per_sec", value)) r.itemsPerSecond = stod(value);
+            if (findField(object, "allocs_per_op", value)) r.allocsPerOp = stod(value);
+        }
+        catch (...) {
+            continue; // Not one of ours
+        }
+        out.push_back(r);
+    }
+    return true;
+}
+
+vector<BenchmarkComparison> compareBenchmarks(const vector<BenchmarkResult>& baseline,
+    const vector<BenchmarkResult>& current, double threshold) {
+    vector<BenchmarkComparison> comparisons;
+    for (const BenchmarkResult& now : current) {
+        auto base = find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& b) { return b.name == now.name; });
+        if (base == baseline.end() || base->nsPerOp <= 0) continue;
+
+        BenchmarkComparison c;
+        c.name = now.name;
+        c.baselineNs = base->nsPerOp;
+        c.currentNs = now.nsPerOp;
+        c.change = (now.nsPerOp - base->nsPerOp) / base->nsPerOp;
+        c.regressed = c.change > threshold;
+        c.improved = c.change < -threshold;
+        comparisons.push_back(c);
+    }
+    return comparisons;
+}
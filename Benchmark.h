@@ -0,0 +1,69 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations = 0;  // Ops in the timed batch
+    double nsPerOp = 0.0;
+    double opsPerSecond = 0.0;
+    double itemsPerOp = 1.0;  // Rounds, rows, ... per op; 1 when an op is the item
+    double itemsPerSecond = 0.0;
+    double allocsPerOp = 0.0; // operator new calls on any thread during the batch
+};
+
+// Verdict for one benchmark of a run compared with a saved baseline
+struct BenchmarkComparison {
+    std::string name;
+    double baselineNs = 0.0;
+    double currentNs = 0.0;
+    double change = 0.0;      // (current - baseline) / baseline
+    bool regressed = false;
+    bool improved = false;
+};
+
+// Runs body in growing batches until one takes at least minSeconds, then
+// repeats that batch and reports the median one. body(n) performs n ops and
+// returns how many items they covered (0 = one per op). One untimed op runs
+// first as a warm-up.
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(double minSeconds = 0.2, int repetitions = 3, std::string filter = "");
+
+    // Whether name passes the filter, so callers can skip expensive setup
+    bool selected(const std::string& name) const;
+    void run(const std::string& name, const std::function<uint64_t(uint64_t)>& body);
+
+    const std::vector<BenchmarkResult>& results() const { return measured; }
+
+private:
+    double minSeconds;
+    int repetitions;
+    std::string filter;
+    std::vector<BenchmarkResult> measured;
+};
+
+// operator new calls while counting was on, counted by the replacement in
+// Benchmark.cpp. Counting is off by default so the game's other commands
+// pay nothing for it; runBenchCommand switches it on.
+void setAllocationCounting(bool enabled);
+uint64_t allocationCount();
+
+// Stops the optimizer from discarding a value a benchmark computed
+void keepValue(uint64_t value);
+
+void writeBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results, double minSeconds, int repetitions);
+// Reads the benchmarks back from a file writeBenchmarkJson wrote; false if it could not be opened
+bool readBenchmarkJson(const std::string& path, std::vector<BenchmarkResult>& out);
+
+// Pairs results by name. A benchmark regresses when it is slower than
+// baseline by more than threshold (0.10 = 10%); missing ones are skipped.
+std::vector<BenchmarkComparison> compareBenchmarks(const std::vector<BenchmarkResult>& baseline,
+    const std::vector<BenchmarkResult>& current, double threshold);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,384 @@
+#include "BuildOptimizer.h"
+#include "CharacterManager.h"
+#include "MatchupSolver.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+namespace {
+    // Matchups (build, opponent) per stolen chunk; each is two solver runs
+    const size_t K_MATCHUPS_PER_GRAIN = 4;
+    // Largest steps a mutation takes
+    const int K_HP_STEP = 15;
+    const int K_DAMAGE_STEP = 2;
+    // Fresh random builds tried before a generation gives up looking for unseen ones
+    const int K_MAX_DUPLICATE_TRIES = 8;
+
+    using Objectives = array<double, 3>; // All maximised
+
+    Objectives objectivesOf(const BuildFitness& f) {
+        return { f.meanWinRate, f.worstWinRate, -f.statBudget };
+    }
+
+    bool isPercentEffect(PassiveEffect effect) {
+        return effect == PassiveEffect::HEAL_SELF_PERCENT_CURRENT || effect == PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT;
+    }
+
+    int maxValueFor(PassiveEffect effect) {
+        return isPercentEffect(effect) ? CUSTOM_MAX_PERCENT_VALUE : CUSTOM_MAX_FLAT_VALUE;
+    }
+
+    Passive randomPassive(Rng& rng) {
+        PassiveTrigger trigger = static_cast<PassiveTrigger>(rng.nextInt(1, PASSIVE_TRIGGER_COUNT - 1));
+        PassiveEffect effect = static_cast<PassiveEffect>(rng.nextInt(1, PASSIVE_EFFECT_COUNT - 1));
+        int threshold = trigger == PassiveTrigger::ON_HP_BELOW_PERCENT ? rng.nextInt(1, CUSTOM_MAX_HP_THRESHOLD) : 0;
+        return Passive(trigger, effect, rng.nextInt(1, maxValueFor(effect)), threshold);
+    }
+
+    void mutate(CharacterBuild& b, double rate, Rng& rng) {
+        auto hit = [&]() { return rng.nextDouble() < rate; };
+        if (hit()) b.hp = clamp(b.hp + rng.nextInt(-K_HP_STEP, K_HP_STEP), 1, CUSTOM_MAX_HP);
+        for (int* damage : { &b.rock, &b.paper, &b.scissors }) {
+            if (hit()) *damage = clamp(*damage + rng.nextInt(-K_DAMAGE_STEP, K_DAMAGE_STEP), 0, CUSTOM_MAX_MOVE_DAMAGE);
+        }
+        if (!hit()) return;
+
+        int count = static_cast<int>(b.passives.size());
+        switch (rng.nextInt(0, 3)) {
+        case 0: // Add
+            if (count < CUSTOM_MAX_PASSIVES) {
+                b.passives.push_back(randomPassive(rng));
+                break;
+            }
+            [[fallthrough]];
+        case 1: // Replace
+            if (count > 0) b.passives[rng.nextInt(0, count - 1)] = randomPassive(rng);
+            else b.passives.push_back(randomPassive(rng));
+            break;
+        case 2: // Remove
+            if (count > 0) b.passives.erase(b.passives.begin() + rng.nextInt(0, count - 1));
+            break;
+        default: // Retune a value or threshold, keeping trigger and effect
+            if (count > 0) {
+                Passive& p = b.passives[rng.nextInt(0, count - 1)];
+                int step = max(1, maxValueFor(p.effect) / 10);
+                p.value = clamp(p.value + rng.nextInt(-step, step), 1, maxValueFor(p.effect));
+                if (p.trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
+                    p.threshold = clamp(p.threshold + rng.nextInt(-10, 10), 1, CUSTOM_MAX_HP_THRESHOLD);
+                }
+            }
+            break;
+        }
+    }
+
+    // Uniform crossover: each stat, and each passive slot, from either parent
+    CharacterBuild crossover(const CharacterBuild& a, const CharacterBuild& b, Rng& rng) {
+        CharacterBuild child;
+        child.hp = rng.nextInt(0, 1) ? a.hp : b.hp;
+        child.rock = rng.nextInt(0, 1) ? a.rock : b.rock;
+        child.paper = rng.nextInt(0, 1) ? a.paper : b.paper;
+        child.scissors = rng.nextInt(0, 1) ? a.scissors : b.scissors;
+        for (size_t slot = 0; slot < static_cast<size_t>(CUSTOM_MAX_PASSIVES); ++slot) {
+            const CharacterBuild& from = rng.nextInt(0, 1) ? a : b;
+            if (slot < from.passives.size()) child.passives.push_back(from.passives[slot]);
+        }
+        return child;
+    }
+
+    // Fast non-dominated sort: rank 0 is the Pareto front
+    vector<int> paretoRanks(const vector<BuildFitness>& fitness) {
+        size_t n = fitness.size();
+        vector<int> rank(n, 0);
+        vector<int> dominatedBy(n, 0);
+        vector<vector<size_t>> dominates(n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                if (fitness[i].dominates(fitness[j])) {
+                    dominates[i].push_back(j);
+                    ++dominatedBy[j];
+                }
+                else if (fitness[j].dominates(fitness[i])) {
+                    dominates[j].push_back(i);
+                    ++dominatedBy[i];
+                }
+            }
+        }
+        vector<size_t> current;
+        for (size_t i = 0; i < n; ++i) {
+            if (dominatedBy[i] == 0) current.push_back(i);
+        }
+        for (int level = 0; !current.empty(); ++level) {
+            vector<size_t> next;
+            for (size_t i : current) {
+                rank[i] = level;
+                for (size_t j : dominates[i]) {
+                    if (--dominatedBy[j] == 0) next.push_back(j);
+                }
+            }
+            current.swap(next);
+        }
+        return rank;
+    }
+
+    // Crowding distance within one front; the extremes of each objective are kept first
+    void crowding(const vector<size_t>& front, const vector<BuildFitness>& fitness, vector<double>& distance) {
+        for (size_t i : front) distance[i] = 0.0;
+        if (front.size() < 3) {
+            for (size_t i : front) distance[i] = numeric_limits<double>::infinity();
+            return;
+        }
+        vector<size_t> sorted = front;
+        for (size_t objective = 0; objective < 3; ++objective) {
+            auto value = [&](size_t i) { return objectivesOf(fitness[i])[objective]; };
+            sort(sorted.begin(), sorted.end(), [&](size_t x, size_t y) { return value(x) < value(y); });
+            double span = value(sorted.back()) - value(sorted.front());
+            distance[sorted.front()] = distance[sorted.back()] = numeric_limits<double>::infinity();
+            if (span <= 0) continue;
+            for (size_t k = 1; k + 1 < sorted.size(); ++k) {
+                distance[sorted[k]] += (value(sorted[k + 1]) - value(sorted[k - 1])) / span;
+            }
+        }
+    }
+
+    // Pareto rank of every build, and its crowding distance within its front
+    vector<vector<size_t>> rankAndCrowd(const vector<BuildFitness>& fitness, vector<int>& rank, vector<double>& distance) {
+        rank = paretoRanks(fitness);
+        distance.assign(fitness.size(), 0.0);
+        int levels = fitness.empty() ? 0 : *max_element(rank.begin(), rank.end()) + 1;
+        vector<vector<size_t>> fronts(levels);
+        for (size_t i = 0; i < fitness.size(); ++i) fronts[rank[i]].push_back(i);
+        for (const vector<size_t>& front : fronts) crowding(front, fitness, distance);
+        return fronts;
+    }
+
+    // Parents and children together: keep whole fronts, then the least crowded of the first that does not fit
+    vector<size_t> selectSurvivors(const vector<BuildFitness>& fitness, size_t keep) {
+        vector<int> rank;
+        vector<double> distance;
+        vector<size_t> survivors;
+        for (vector<size_t>& front : rankAndCrowd(fitness, rank, distance)) {
+            if (survivors.size() + front.size() <= keep) {
+                survivors.insert(survivors.end(), front.begin(), front.end());
+                continue;
+            }
+            // stable_sort keeps index order among equals, so ties break the same way every run
+            stable_sort(front.begin(), front.end(), [&](size_t x, size_t y) { return distance[x] > distance[y]; });
+            survivors.insert(survivors.end(), front.begin(), front.begin() + (keep - survivors.size()));
+            break;
+        }
+        return survivors;
+    }
+
+    // Scores builds in parallel, each (build, opponent) matchup its own work item
+    class BuildScorer {
+    public:
+        BuildScorer(const vector<const Character*>& opponents, const OptimizerOptions& options)
+            : opponents(opponents), options(options), pool(options.threads) {
+            solver.maxStates = options.maxStates;
+            solver.maxRounds = options.maxRounds;
+            solver.samples = options.fallbackSamples;
+            solver.seed = options.seed;
+        }
+
+        // Fills fitness for every build not scored before
+        void score(const vector<CharacterBuild>& builds) {
+            vector<const CharacterBuild*> fresh;
+            unordered_set<uint64_t> queued;
+            for (const CharacterBuild& b : builds) {
+                uint64_t key = b.key();
+                if (!cache.count(key) && queued.insert(key).second) fresh.push_back(&b);
+            }
+            if (fresh.empty()) return;
+
+            vector<unique_ptr<Character>> fighters;
+            for (size_t i = 0; i < fresh.size(); ++i) fighters.push_back(fresh[i]->toCharacter("Build" + to_string(i)));
+            size_t m = opponents.size();
+            vector<double> winRate(fresh.size() * m);
+            vector<char> exact(fresh.size() * m);
+
+            pool.parallelFor(0, fresh.size() * m, K_MATCHUPS_PER_GRAIN, [&](size_t first, size_t last, unsigned) {
+                for (size_t unit = first; unit < last; ++unit) {
+                    const Character& build = *fighters[unit / m];
+                    const Character& opponent = *opponents[unit % m];
+                    MatchupSolution asPlayer = solveMatchup(build, opponent, options.policy, options.policy, solver);
+                    MatchupSolution asBot = solveMatchup(opponent, build, options.policy, options.policy, solver);
+                    winRate[unit] = (asPlayer.playerWin + asBot.botWin) / 2;
+                    exact[unit] = asPlayer.exact && asBot.exact;
+                }
+            });
+            matchups += 2 * fresh.size() * m;
+
+            for (size_t i = 0; i < fresh.size(); ++i) {
+                BuildFitness f;
+                f.statBudget = fresh[i]->statBudget();
+                f.worstWinRate = m ? 1.0 : 0.0;
+                for (size_t j = 0; j < m; ++j) {
+                    f.meanWinRate += winRate[i * m + j];
+                    f.worstWinRate = min(f.worstWinRate, winRate[i * m + j]);
+                    f.exact = f.exact && exact[i * m + j];
+                }
+                if (m) f.meanWinRate /= static_cast<double>(m);
+                cache[fresh[i]->key()] = f;
+            }
+        }
+
+        const BuildFitness& fitnessOf(const CharacterBuild& b) const { return cache.at(b.key()); }
+        bool seen(const CharacterBuild& b) const { return cache.count(b.key()) != 0; }
+        uint64_t evaluations() const { return cache.size(); }
+        uint64_t solverCalls() const { return matchups; }
+
+    private:
+        const vector<const Character*>& opponents;
+        const OptimizerOptions& options;
+        ThreadPool pool;
+        SolverOptions solver;
+        unordered_map<uint64_t, BuildFitness> cache;
+        uint64_t matchups = 0;
+    };
+}
+
+CharacterBuild CharacterBuild::random(Rng& rng) {
+    CharacterBuild b;
+    b.hp = rng.nextInt(1, CUSTOM_MAX_HP);
+    b.rock = rng.nextInt(0, CUSTOM_MAX_MOVE_DAMAGE);
+    b.paper = rng.nextInt(0, CUSTOM_MAX_MOVE_DAMAGE);
+    b.scissors = rng.nextInt(0, CUSTOM_MAX_MOVE_DAMAGE);
+    int count = rng.nextInt(0, CUSTOM_MAX_PASSIVES);
+    for (int i = 0; i < count; ++i) b.passives.push_back(randomPassive(rng));
+    return b;
+}
+
+unique_ptr<Character> CharacterBuild::toCharacter(const string& name) const {
+    return make_unique<Character>(name, hp, rock, paper, scissors, passives, CharacterType::CUSTOM);
+}
+
+uint64_t CharacterBuild::key() const {
+    // FNV-1a; passive order matters, since passives fire in order
+    uint64_t h = 0xCBF29CE484222325ULL;
+    auto mix = [&](int v) {
+        h ^= static_cast<uint32_t>(v);
+        h *= 0x100000001B3ULL;
+    };
+    mix(hp);
+    mix(rock);
+    mix(paper);
+    mix(scissors);
+    for (const Passive& p : passives) {
+        mix(static_cast<int>(p.trigger));
+        mix(static_cast<int>(p.effect));
+        mix(p.value);
+        mix(p.threshold);
+    }
+    return h;
+}
+
+double CharacterBuild::statBudget() const {
+    double hpShare = static_cast<double>(hp) / CUSTOM_MAX_HP;
+    double damageShare = static_cast<double>(rock + paper + scissors) / (3 * CUSTOM_MAX_MOVE_DAMAGE);
+    return (hpShare + damageShare) / 2;
+}
+
+bool BuildFitness::dominates(const BuildFitness& other) const {
+    Objectives mine = objectivesOf(*this), theirs = objectivesOf(other);
+    bool better = false;
+    for (size_t i = 0; i < mine.size(); ++i) {
+        if (mine[i] < theirs[i]) return false;
+        if (mine[i] > theirs[i]) better = true;
+    }
+    return better;
+}
+
+BuildFitness evaluateBuild(const CharacterBuild& build, const vector<const Character*>& opponents, const OptimizerOptions& options) {
+    BuildScorer scorer(opponents, options);
+    scorer.score({ build });
+    return scorer.fitnessOf(build);
+}
+
+OptimizerReport evolveBuilds(const vector<const Character*>& opponents, const OptimizerOptions& options) {
+    OptimizerReport report;
+    auto start = chrono::steady_clock::now();
+    size_t size = static_cast<size_t>(max(2, options.population));
+    Rng rng(options.seed);
+    BuildScorer scorer(opponents, options);
+
+    vector<CharacterBuild> population;
+    unordered_set<uint64_t> keys;
+    for (int tries = 0; population.size() < size && tries < static_cast<int>(size) * K_MAX_DUPLICATE_TRIES; ++tries) {
+        CharacterBuild b = CharacterBuild::random(rng);
+        if (keys.insert(b.key()).second) population.push_back(b);
+    }
+    scorer.score(population);
+
+    vector<BuildFitness> fitness;
+    vector<int> rank;
+    vector<double> distance;
+    auto refresh = [&]() {
+        fitness.clear();
+        for (const CharacterBuild& b : population) fitness.push_back(scorer.fitnessOf(b));
+        rankAndCrowd(fitness, rank, distance);
+    };
+    refresh();
+
+    for (int generation = 1; generation <= options.generations; ++generation) {
+        // Binary tournament: lower rank wins, then the less crowded one
+        auto pick = [&]() -> const CharacterBuild& {
+            size_t x = static_cast<size_t>(rng.nextInt(0, static_cast<int>(population.size()) - 1));
+            size_t y = static_cast<size_t>(rng.nextInt(0, static_cast<int>(population.size()) - 1));
+            if (rank[x] != rank[y]) return population[rank[x] < rank[y] ? x : y];
+            return population[distance[x] >= distance[y] ? x : y];
+        };
+
+        vector<CharacterBuild> children;
+        for (size_t tries = 0; children.size() < size && tries < size * K_MAX_DUPLICATE_TRIES; ++tries) {
+            CharacterBuild child = crossover(pick(), pick(), rng);
+            mutate(child, options.mutationRate, rng);
+            if (keys.insert(child.key()).second) children.push_back(std::move(child));
+        }
+        uint64_t scoredBefore = scorer.evaluations();
+        scorer.score(children);
+
+        vector<CharacterBuild> combined = population;
+        combined.insert(combined.end(), children.begin(), children.end());
+        vector<BuildFitness> combinedFitness;
+        for (const CharacterBuild& b : combined) combinedFitness.push_back(scorer.fitnessOf(b));
+        vector<size_t> survivors = selectSurvivors(combinedFitness, size);
+        population.clear();
+        for (size_t i : survivors) population.push_back(combined[i]);
+        refresh();
+        report.generations = generation;
+
+        if (options.verbose) {
+            size_t frontSize = 0;
+            double bestMean = 0.0, bestWorst = 0.0;
+            for (size_t i = 0; i < population.size(); ++i) {
+                if (rank[i] != 0) continue;
+                ++frontSize;
+                bestMean = max(bestMean, fitness[i].meanWinRate);
+                bestWorst = max(bestWorst, fitness[i].worstWinRate);
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Generation " << generation << ": " << (scorer.evaluations() - scoredBefore) << " new builds, front "
+                << frontSize << ", best mean " << bestMean << ", best worst case " << bestWorst << ", " << seconds << " s" << endl;
+        }
+    }
+
+    for (size_t i = 0; i < population.size(); ++i) {
+        if (rank[i] == 0) report.front.push_back(EvolvedBuild{ population[i], fitness[i] });
+    }
+    sort(report.front.begin(), report.front.end(), [](const EvolvedBuild& x, const EvolvedBuild& y) {
+        if (x.fitness.meanWinRate != y.fitness.meanWinRate) return x.fitness.meanWinRate > y.fitness.meanWinRate;
+        return x.fitness.statBudget < y.fitness.statBudget;
+    });
+    report.evaluations = scorer.evaluations();
+    report.matchups = scorer.solverCalls();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,81 @@
+#ifndef BUILDOPTIMIZER_H
+#define BUILDOPTIMIZER_H
+
+#include "BattleEngine.h"
+#include "PassiveSystem.h"
+#include "Rng.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A custom character as createNewCharacter would accept it
+struct CharacterBuild {
+    int hp = 1;
+    int rock = 0;
+    int paper = 0;
+    int scissors = 0;
+    std::vector<Passive> passives; // At most CUSTOM_MAX_PASSIVES
+
+    static CharacterBuild random(Rng& rng);
+    std::unique_ptr<Character> toCharacter(const std::string& name) const;
+    // Same for builds that would play identically under any name
+    uint64_t key() const;
+    // Stat spend as a fraction of the maximum: HP and the three damages weigh
+    // equally, so 0 is the weakest build and 1 the strongest before passives
+    double statBudget() const;
+};
+
+// Fitness of one build against the roster, every term as seen by the build.
+// Win rates average the build's chances as player and as bot.
+struct BuildFitness {
+    double meanWinRate = 0.0;  // Over the opponents
+    double worstWinRate = 0.0; // Its worst matchup
+    double statBudget = 0.0;   // Lower is cheaper; cheap builds that win are the degenerate ones
+    bool exact = true;         // False if any matchup needed the solver's sampling fallback
+
+    // At least as good in every objective and better in one
+    bool dominates(const BuildFitness& other) const;
+};
+
+struct EvolvedBuild {
+    CharacterBuild build;
+    BuildFitness fitness;
+};
+
+struct OptimizerOptions {
+    int population = 48;
+    int generations = 20;
+    uint64_t seed = 1;
+    unsigned threads = 0;          // 0 = all hardware threads
+    MovePolicy policy = MovePolicy::ai(AIDifficulty::HARD); // Both sides of every matchup
+    int maxRounds = 200;           // Below the game's 1000: AI mirror stalls dominate the cost otherwise
+    size_t maxStates = 20000;      // Per matchup before the solver samples instead
+    int fallbackSamples = 200;     // Battles per matchup when it does
+    double mutationRate = 0.3;     // Chance each gene changes in a child
+    bool verbose = false;          // One progress line per generation on stdout
+};
+
+struct OptimizerReport {
+    std::vector<EvolvedBuild> front; // Pareto-best builds of the final population, best mean win rate first
+    int generations = 0;
+    uint64_t evaluations = 0;        // Distinct builds scored
+    uint64_t matchups = 0;           // Solver calls
+    double seconds = 0.0;
+};
+
+// Scores one build against each opponent with the exact matchup solver (no
+// sampling noise, so selection is not fooled by lucky runs), both sides.
+BuildFitness evaluateBuild(const CharacterBuild& build, const std::vector<const Character*>& opponents,
+    const OptimizerOptions& options);
+
+// NSGA-II over the custom build space: each generation breeds a child
+// population (binary tournaments on Pareto rank and crowding, uniform
+// crossover, then mutation of stats and passives), scores the new builds in
+// parallel against the opponents, and keeps the best of parents and children
+// by non-dominated sorting. Objectives: mean win rate and worst-matchup win
+// rate up, stat budget down. Deterministic for a seed whatever the thread count.
+OptimizerReport evolveBuilds(const std::vector<const Character*>& opponents, const OptimizerOptions& options);
+
+#endif // BUILDOPTIMIZER_H
@@ -0,0 +1,198 @@
+#include "BuiltinKernel.h"
+#include "Metrics.h"
+#include <array>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    bool eitherDefeated(const Character& a, const Character& b) {
+        return a.isDefeated() || b.isDefeated();
+    }
+
+    // One built-in's passives, resolved against its BUILTIN_ROSTER row
+    template <size_t I>
+    struct BuiltinFighter {
+        static constexpr const BuiltinSpec& spec = BUILTIN_ROSTER[I];
+
+        template <PassiveTrigger T>
+        static constexpr bool has = spec.hasPassiveFor(T);
+
+        static constexpr bool hasLossPassive = has<PassiveTrigger::ON_LOSE_ROCK>
+            || has<PassiveTrigger::ON_LOSE_PAPER> || has<PassiveTrigger::ON_LOSE_SCISSORS>;
+
+        template <PassiveEffect E>
+        static void applyEffect(int value, Character& self, Character& opponent) {
+            if constexpr (E == PassiveEffect::HEAL_SELF_FLAT) self.heal(value);
+            else if constexpr (E == PassiveEffect::DAMAGE_OPPONENT_FLAT) opponent.takeDamage(value);
+            else if constexpr (E == PassiveEffect::INCREASE_NEXT_ATTACK_FLAT) self.addBonusDamageNextAttack(value);
+            else if constexpr (E == PassiveEffect::INCREASE_ROCK_DMG_PERM) self.increaseBaseRockDamage(value);
+            else if constexpr (E == PassiveEffect::INCREASE_PAPER_DMG_PERM) self.increaseBasePaperDamage(value);
+            else if constexpr (E == PassiveEffect::INCREASE_SCISSORS_DMG_PERM) self.increaseBaseScissorsDamage(value);
+            else if constexpr (E == PassiveEffect::HEAL_SELF_PERCENT_CURRENT) self.heal((self.getCurrentHp() * value) / 100);
+            else if constexpr (E == PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT) opponent.takeDamage((opponent.getCurrentHp() * value) / 100);
+        }
+
+        // Passive K if it answers to T; the same checks as Character::applyPassives
+        template <PassiveTrigger T, size_t K>
+        static void fireOne(Character& self, Character& opponent) {
+            if constexpr (K < spec.passiveCount && spec.passives[K].trigger == T) {
+                constexpr BuiltinPassive p = spec.passives[K];
+                if constexpr (T == PassiveTrigger::ON_HP_BELOW_PERCENT) {
+                    constexpr int floor = spec.hpTriggerFloor();
+                    constexpr int cutoff = spec.hpCutoff(K);
+                    int hp = self.getCurrentHp();
+                    if (hp < floor || hp > cutoff) return;
+                }
+                if (!self.markPassiveFired(K)) return;
+                Metrics::countPassive(p.trigger, p.effect);
+                applyEffect<p.effect>(p.value, self, opponent);
+            }
+        }
+
+        // Every passive for T, in table order; nothing at all without one
+        template <PassiveTrigger T>
+        static void fire(Character& self, Character& opponent) {
+            if constexpr (has<T>) {
+                fireOne<T, 0>(self, opponent);
+                fireOne<T, 1>(self, opponent);
+                fireOne<T, 2>(self, opponent);
+            }
+        }
+
+        // The generic round tests for a K.O. after every trigger step. A step
+        // with no passive changes nothing, so only steps that can fire test,
+        // before they fire. Returns true if the round is over.
+        template <PassiveTrigger T>
+        static bool fireUnlessOver(Character& self, Character& opponent) {
+            if constexpr (has<T>) {
+                if (eitherDefeated(self, opponent)) return true;
+                fire<T>(self, opponent);
+            }
+            return false;
+        }
+
+        static void fireWin(int move, Character& self, Character& opponent) {
+            switch (move) {
+            case 1: fire<PassiveTrigger::ON_WIN_ROCK>(self, opponent); break;
+            case 2: fire<PassiveTrigger::ON_WIN_PAPER>(self, opponent); break;
+            case 3: fire<PassiveTrigger::ON_WIN_SCISSORS>(self, opponent); break;
+            }
+        }
+
+        static bool fireLossUnlessOver(int move, Character& self, Character& opponent) {
+            if constexpr (hasLossPassive) {
+                if (eitherDefeated(self, opponent)) return true;
+                switch (move) {
+                case 1: fire<PassiveTrigger::ON_LOSE_ROCK>(self, opponent); break;
+                case 2: fire<PassiveTrigger::ON_LOSE_PAPER>(self, opponent); break;
+                case 3: fire<PassiveTrigger::ON_LOSE_SCISSORS>(self, opponent); break;
+                }
+            }
+            return false;
+        }
+    };
+
+    // The round phases of BattleEngine, step for step, for built-ins P and B
+    template <size_t P, size_t B>
+    struct MatchupKernel {
+        using PlayerSide = BuiltinFighter<P>;
+        using BotSide = BuiltinFighter<B>;
+
+        static bool beginRound(Character& player, Character& bot) {
+            if constexpr (PlayerSide::spec.passiveCount > 0) player.resetTurnState();
+            if constexpr (BotSide::spec.passiveCount > 0) bot.resetTurnState();
+
+            PlayerSide::template fire<PassiveTrigger::ON_TURN_START>(player, bot);
+            if (BotSide::template fireUnlessOver<PassiveTrigger::ON_TURN_START>(bot, player)
+                || PlayerSide::template fireUnlessOver<PassiveTrigger::ON_HP_BELOW_PERCENT>(player, bot)
+                || BotSide::template fireUnlessOver<PassiveTrigger::ON_HP_BELOW_PERCENT>(bot, player)) {
+                return true;
+            }
+            return eitherDefeated(player, bot);
+        }
+
+        template <class Attacker, class Defender>
+        static void strike(Character& attacker, Character& defender, int attackerMove, int defenderMove) {
+            int defenderHpBefore = defender.getCurrentHp();
+            BattleEngine::strike(attacker, defender, attackerMove);
+
+            Attacker::fireWin(attackerMove, attacker, defender);
+            if (Attacker::template fireUnlessOver<PassiveTrigger::AFTER_ANY_ATTACK>(attacker, defender)
+                || Defender::fireLossUnlessOver(defenderMove, defender, attacker)
+                || Defender::template fireUnlessOver<PassiveTrigger::AFTER_TAKING_HIT>(defender, attacker)) {
+                return;
+            }
+            if constexpr (Defender::template has<PassiveTrigger::ON_HP_BELOW_PERCENT>) {
+                if (!eitherDefeated(attacker, defender) && defender.getCurrentHp() != defenderHpBefore) {
+                    Defender::template fire<PassiveTrigger::ON_HP_BELOW_PERCENT>(defender, attacker);
+                }
+            }
+        }
+
+        static void resolveMoves(Character& player, Character& bot, int playerMove, int botMove) {
+            int winner = BattleEngine::getRPSWinner(playerMove, botMove);
+            if (winner == 0) {
+                PlayerSide::template fire<PassiveTrigger::ON_TIE>(player, bot);
+                BotSide::template fireUnlessOver<PassiveTrigger::ON_TIE>(bot, player);
+            }
+            else if (winner == 1) strike<PlayerSide, BotSide>(player, bot, playerMove, botMove);
+            else strike<BotSide, PlayerSide>(bot, player, botMove, playerMove);
+        }
+
+        // BattleEngine::playBattle's loop over the phases above
+        static BattleResult play(Character& player, Character& bot, const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+            Rng& rng, int maxRounds, vector<uint8_t>* movePairs) {
+            int rounds = 0;
+            while (!eitherDefeated(player, bot) && rounds < maxRounds) {
+                int round = rounds++;
+                bool over;
+                {
+                    MetricTimer timer(MetricHistogram::ROUND_BEGIN, MetricTimer::SAMPLED);
+                    over = beginRound(player, bot);
+                }
+                if (over) break;
+                int playerMove, botMove;
+                {
+                    MetricTimer timer(MetricHistogram::ROUND_CHOOSE, MetricTimer::SAMPLED);
+                    playerMove = playerPolicy.chooseMove(player, bot, BattleSide::PLAYER, round, rng);
+                    botMove = botPolicy.chooseMove(bot, player, BattleSide::BOT, round, rng);
+                }
+                if (movePairs) movePairs->push_back(static_cast<uint8_t>(playerMove << 2 | botMove));
+                MetricTimer timer(MetricHistogram::ROUND_RESOLVE, MetricTimer::SAMPLED);
+                resolveMoves(player, bot, playerMove, botMove);
+            }
+            Metrics::record(MetricHistogram::BATTLE_ROUNDS, static_cast<uint64_t>(rounds));
+            return BattleEngine::resultOf(player, bot, rounds);
+        }
+    };
+
+    // Kernel of matchup (P, B) at P * BUILTIN_COUNT + B
+    template <size_t... I>
+    constexpr array<BuiltinBattleKernel, sizeof...(I)> makeKernels(index_sequence<I...>) {
+        return { { &MatchupKernel<I / BUILTIN_COUNT, I % BUILTIN_COUNT>::play... } };
+    }
+
+    constexpr array<BuiltinBattleKernel, BUILTIN_COUNT * BUILTIN_COUNT> K_KERNELS =
+        makeKernels(make_index_sequence<BUILTIN_COUNT * BUILTIN_COUNT>{});
+}
+
+size_t builtinIndexOf(const Character& character) {
+    if (character.getType() != CharacterType::BUILTIN) return BUILTIN_COUNT;
+    static const array<uint64_t, BUILTIN_COUNT> hashes = [] {
+        array<uint64_t, BUILTIN_COUNT> h{};
+        for (size_t i = 0; i < BUILTIN_COUNT; ++i) h[i] = Character(BUILTIN_ROSTER[i]).getDefinitionHash();
+        return h;
+    }();
+    for (size_t i = 0; i < BUILTIN_COUNT; ++i) {
+        if (hashes[i] == character.getDefinitionHash()) return i;
+    }
+    return BUILTIN_COUNT;
+}
+
+BuiltinBattleKernel builtinBattleKernel(const Character& player, const Character& bot) {
+    size_t p = builtinIndexOf(player);
+    size_t b = builtinIndexOf(bot);
+    if (p == BUILTIN_COUNT || b == BUILTIN_COUNT) return nullptr;
+    return K_KERNELS[p * BUILTIN_COUNT + b];
+}
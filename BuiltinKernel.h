@@ -0,0 +1,24 @@
+#ifndef BUILTINKERNEL_H
+#define BUILTINKERNEL_H
+
+#include "BattleEngine.h"
+#include "BuiltinRoster.h"
+#include <cstdint>
+#include <vector>
+
+// BattleEngine::playBattle for one built-in matchup, instantiated from
+// BUILTIN_ROSTER: each side only checks the triggers it has a passive for,
+// and every passive it has fires with its effect and value known at compile
+// time. Plays exactly the battle the data-driven loop would.
+using BuiltinBattleKernel = BattleResult(*)(Character& player, Character& bot,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, Rng& rng, int maxRounds, std::vector<uint8_t>* movePairs);
+
+// Row of BUILTIN_ROSTER the character was built from, or BUILTIN_COUNT.
+// Matches on the definition hash, so a character with a built-in's name but
+// other passives or max HP is not taken for it.
+size_t builtinIndexOf(const Character& character);
+
+// Kernel for the matchup, or nullptr unless both fighters are built-ins
+BuiltinBattleKernel builtinBattleKernel(const Character& player, const Character& bot);
+
+#endif // BUILTINKERNEL_H
@@ -0,0 +1,83 @@
+#ifndef BUILTINROSTER_H
+#define BUILTINROSTER_H
+
+#include "PassiveSystem.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The stat block of a built-in character, fixed at compile time. The
+// OG ... Sunny constructors build from it, and the built-in battle kernels
+// (BuiltinKernel.h) are specialised on it.
+struct BuiltinPassive {
+    PassiveTrigger trigger = PassiveTrigger::NONE;
+    PassiveEffect effect = PassiveEffect::NONE;
+    int value = 0;
+    int threshold = 0;
+};
+
+struct BuiltinSpec {
+    const char* name;
+    int hp;
+    int rock;
+    int paper;
+    int scissors;
+    std::array<BuiltinPassive, 3> passives;
+    size_t passiveCount;
+
+    constexpr uint32_t triggerMask() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < passiveCount; ++i) mask |= 1u << static_cast<int>(passives[i].trigger);
+        return mask;
+    }
+
+    constexpr bool hasPassiveFor(PassiveTrigger trigger) const {
+        return (triggerMask() >> static_cast<int>(trigger)) & 1u;
+    }
+
+    // The same truncated percentage Character::indexPassives works from
+    constexpr int hpPercent(int currentHp) const {
+        return hp > 0 ? static_cast<int>(static_cast<double>(currentHp) / hp * 100) : 0;
+    }
+
+    // Lowest HP that counts as above 0% for ON_HP_BELOW_PERCENT
+    constexpr int hpTriggerFloor() const {
+        for (int h = 0; h <= hp; ++h) {
+            if (hpPercent(h) > 0) return h;
+        }
+        return hp + 1;
+    }
+
+    // Highest HP at or below the passive's threshold
+    constexpr int hpCutoff(size_t passive) const {
+        for (int h = hp; h >= 0; --h) {
+            if (hpPercent(h) <= passives[passive].threshold) return h;
+        }
+        return -1;
+    }
+};
+
+enum BuiltinIndex : size_t {
+    BUILTIN_OG,
+    BUILTIN_HELIOS,
+    BUILTIN_DURAN,
+    BUILTIN_PHILIP,
+    BUILTIN_RAZOR,
+    BUILTIN_SUNNY,
+    BUILTIN_COUNT
+};
+
+inline constexpr std::array<BuiltinSpec, BUILTIN_COUNT> BUILTIN_ROSTER = { {
+    { "OG", 20, 1, 2, 3, {}, 0 },
+    { "Helios", 25, 1, 0, 2, { { { PassiveTrigger::ON_WIN_PAPER, PassiveEffect::HEAL_SELF_FLAT, 5, 0 } } }, 1 },
+    { "Duran", 15, 2, 1, 3, { { { PassiveTrigger::ON_WIN_SCISSORS, PassiveEffect::INCREASE_NEXT_ATTACK_FLAT, 3, 0 } } }, 1 },
+    { "Philip", 18, 1, 2, 1, { { { PassiveTrigger::ON_TIE, PassiveEffect::DAMAGE_OPPONENT_FLAT, 1, 0 } } }, 1 },
+    { "Razor", 7, 3, 4, 5, {}, 0 },
+    { "Sunny", 14, 1, 3, 2, { {
+        { PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_ROCK_DMG_PERM, 4, 28 },
+        { PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_PAPER_DMG_PERM, 2, 28 },
+        { PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_SCISSORS_DMG_PERM, 3, 28 }
+    } }, 3 }
+} };
+
+#endif // BUILTINROSTER_H
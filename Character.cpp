@@ -1,5 +1,7 @@
 #include "Character.h"
 #include "PassiveSystem.h"
+#include "BuiltinRoster.h"
+#include "Metrics.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
@@ -7,19 +9,115 @@
 
 using namespace std; // OK in .cpp file
 
-Character::Character(const string& n, int hp, int rock, int paper, int scissors, string type)
+Character::Character(const string& n, int hp, int rock, int paper, int scissors, CharacterType type)
     : name(n), maxHp(hp), currentHp(hp), baseRockDamage(rock), basePaperDamage(paper),
-    baseScissorsDamage(scissors), bonusDamageNextAttack(0), characterType(type) {
+    baseScissorsDamage(scissors), bonusDamageNextAttack(0), characterType(type),
+    builtState{ hp, 0, rock, paper, scissors, 0 } {
+    indexPassives();
 }
 
-Character::Character(const string& n, int hp, int rock, int paper, int scissors, vector<Passive> p, string type)
+Character::Character(const string& n, int hp, int rock, int paper, int scissors, vector<Passive> p, CharacterType type)
     : name(n), maxHp(hp), currentHp(hp), baseRockDamage(rock), basePaperDamage(paper),
-    baseScissorsDamage(scissors), bonusDamageNextAttack(0), passives(std::move(p)), characterType(type) {
+    baseScissorsDamage(scissors), bonusDamageNextAttack(0), passives(std::move(p)), characterType(type),
+    builtState{ hp, 0, rock, paper, scissors, 0 } {
+    indexPassives();
+}
+
+namespace {
+    vector<Passive> builtinPassives(const BuiltinSpec& spec) {
+        vector<Passive> passives;
+        for (size_t i = 0; i < spec.passiveCount; ++i) {
+            const BuiltinPassive& p = spec.passives[i];
+            passives.emplace_back(p.trigger, p.effect, p.value, p.threshold);
+        }
+        return passives;
+    }
+}
+
+Character::Character(const BuiltinSpec& spec)
+    : Character(spec.name, spec.hp, spec.rock, spec.paper, spec.scissors, builtinPassives(spec), CharacterType::BUILTIN) {
 }
 
 Character::~Character() {}
 
-string Character::getName() const { return name; }
+unique_ptr<Character> Character::clone() const {
+    return make_unique<Character>(*this);
+}
+
+const char* characterTypeName(CharacterType type) {
+    return type == CharacterType::BUILTIN ? "BUILTIN" : "CUSTOM";
+}
+
+namespace {
+    // The percentage the HP-below trigger has always compared against (truncated, not rounded)
+    int hpPercentOf(int hp, int maxHp) {
+        return (maxHp > 0) ? static_cast<int>(static_cast<double>(hp) / maxHp * 100) : 0;
+    }
+
+    // FNV-1a step
+    uint64_t hashMix(uint64_t h, uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= (value >> (i * 8)) & 0xFF;
+            h *= 0x100000001B3ULL;
+        }
+        return h;
+    }
+}
+
+void Character::indexPassives() {
+    passiveTriggerMask = 0;
+    passiveOrder.clear();
+    triggerBucketStart.fill(0);
+
+    for (int t = 0; t < PASSIVE_TRIGGER_COUNT; ++t) {
+        triggerBucketStart[t] = static_cast<uint8_t>(passiveOrder.size());
+        for (size_t i = 0; i < passives.size() && passiveOrder.size() < 255; ++i) {
+            if (static_cast<int>(passives[i].trigger) == t) {
+                passiveOrder.push_back(static_cast<uint8_t>(i));
+                passiveTriggerMask |= 1u << t;
+            }
+        }
+    }
+    triggerBucketStart[PASSIVE_TRIGGER_COUNT] = static_cast<uint8_t>(passiveOrder.size());
+
+    // HP only moves between 0 and maxHp and the percentage is monotonic in HP,
+    // so "0% < percent <= threshold" is exactly the HP range [floor, cutoff].
+    hpTriggerFloor = maxHp + 1;
+    for (int hp = 0; hp <= maxHp; ++hp) {
+        if (hpPercentOf(hp, maxHp) > 0) { hpTriggerFloor = hp; break; }
+    }
+    for (auto& p : passives) {
+        if (p.trigger != PassiveTrigger::ON_HP_BELOW_PERCENT) continue;
+        p.hpCutoff = -1;
+        for (int hp = maxHp; hp >= 0; --hp) {
+            if (hpPercentOf(hp, maxHp) <= p.threshold) { p.hpCutoff = hp; break; }
+        }
+    }
+
+    definitionHash = 0xCBF29CE484222325ULL;
+    for (char c : name) definitionHash = hashMix(definitionHash, static_cast<unsigned char>(c));
+    definitionHash = hashMix(definitionHash, static_cast<uint64_t>(maxHp));
+    for (const auto& p : passives) {
+        definitionHash = hashMix(definitionHash, static_cast<uint64_t>(p.trigger) | static_cast<uint64_t>(p.effect) << 8
+            | static_cast<uint64_t>(static_cast<uint32_t>(p.value)) << 16);
+        definitionHash = hashMix(definitionHash, static_cast<uint64_t>(static_cast<uint32_t>(p.threshold)));
+    }
+    rehashState();
+}
+
+void Character::rehashState() {
+    stateHash = definitionHash
+        ^ zobristKey(ZobristField::HP, currentHp)
+        ^ zobristKey(ZobristField::BONUS, bonusDamageNextAttack)
+        ^ zobristKey(ZobristField::ROCK, baseRockDamage)
+        ^ zobristKey(ZobristField::PAPER, basePaperDamage)
+        ^ zobristKey(ZobristField::SCISSORS, baseScissorsDamage);
+    for (size_t i = 0; i < passives.size(); ++i) {
+        if (passives[i].triggeredThisTurn) stateHash ^= zobristKey(ZobristField::TRIGGERED, static_cast<int>(i));
+    }
+}
+
+const string& Character::getName() const { return name; }
 int Character::getMaxHp() const { return maxHp; }
 int Character::getCurrentHp() const { return currentHp; }
 int Character::getRockDamage() const { return baseRockDamage; }
@@ -27,24 +125,34 @@ int Character::getPaperDamage() const { return basePaperDamage; }
 int Character::getScissorsDamage() const { return baseScissorsDamage; }
 int Character::getBonusDamageNextAttack() const { return bonusDamageNextAttack; } // Added for AI
 const vector<Passive>& Character::getPassives() const { return passives; }
-string Character::getType() const { return characterType; }
+CharacterType Character::getType() const { return characterType; }
 
 bool Character::isDefeated() const { return currentHp <= 0; }
 
 void Character::resetStatsForNewBattle() {
+    rehashField(ZobristField::HP, currentHp, maxHp);
+    rehashField(ZobristField::BONUS, bonusDamageNextAttack, 0);
     currentHp = maxHp;
     bonusDamageNextAttack = 0;
     // Note: Passives' triggeredThisTurn is reset by resetTurnState
 }
 
+void Character::resetToDefinition() {
+    restoreBattleState(builtState);
+}
+
 void Character::takeDamage(int damage) {
+    int oldHp = currentHp;
     currentHp -= damage;
     if (currentHp < 0) currentHp = 0;
+    rehashField(ZobristField::HP, oldHp, currentHp);
 }
 
 void Character::heal(int amount) {
+    int oldHp = currentHp;
     currentHp += amount;
     if (currentHp > maxHp) currentHp = maxHp;
+    rehashField(ZobristField::HP, oldHp, currentHp);
 }
 
 int Character::calculateDamage(int move) {
@@ -55,22 +163,62 @@ int Character::calculateDamage(int move) {
     case 3: damage = baseScissorsDamage; break;
     }
     damage += bonusDamageNextAttack;
+    rehashField(ZobristField::BONUS, bonusDamageNextAttack, 0);
     bonusDamageNextAttack = 0;
     return damage;
 }
 
 void Character::addBonusDamageNextAttack(int amount) {
+    rehashField(ZobristField::BONUS, bonusDamageNextAttack, bonusDamageNextAttack + amount);
     bonusDamageNextAttack += amount;
 }
 
-void Character::increaseBaseRockDamage(int amount) { baseRockDamage += amount; }
-void Character::increaseBasePaperDamage(int amount) { basePaperDamage += amount; }
-void Character::increaseBaseScissorsDamage(int amount) { baseScissorsDamage += amount; }
+void Character::increaseBaseRockDamage(int amount) {
+    rehashField(ZobristField::ROCK, baseRockDamage, baseRockDamage + amount);
+    baseRockDamage += amount;
+}
+
+void Character::increaseBasePaperDamage(int amount) {
+    rehashField(ZobristField::PAPER, basePaperDamage, basePaperDamage + amount);
+    basePaperDamage += amount;
+}
+
+void Character::increaseBaseScissorsDamage(int amount) {
+    rehashField(ZobristField::SCISSORS, baseScissorsDamage, baseScissorsDamage + amount);
+    baseScissorsDamage += amount;
+}
 
 void Character::resetTurnState() {
-    for (auto& p : passives) {
-        p.triggeredThisTurn = false;
+    if (passiveTriggerMask == 0) return;
+    for (size_t i = 0; i < passives.size(); ++i) {
+        if (passives[i].triggeredThisTurn) stateHash ^= zobristKey(ZobristField::TRIGGERED, static_cast<int>(i));
+        passives[i].triggeredThisTurn = false;
+    }
+}
+
+Character::BattleState Character::captureBattleState() const {
+    BattleState state;
+    state.hp = currentHp;
+    state.bonus = bonusDamageNextAttack;
+    state.rock = baseRockDamage;
+    state.paper = basePaperDamage;
+    state.scissors = baseScissorsDamage;
+    for (size_t i = 0; i < passives.size() && i < 32; ++i) {
+        if (passives[i].triggeredThisTurn) state.triggered |= 1u << i;
     }
+    return state;
+}
+
+void Character::restoreBattleState(const BattleState& state) {
+    currentHp = state.hp;
+    bonusDamageNextAttack = state.bonus;
+    baseRockDamage = state.rock;
+    basePaperDamage = state.paper;
+    baseScissorsDamage = state.scissors;
+    for (size_t i = 0; i < passives.size() && i < 32; ++i) {
+        passives[i].triggeredThisTurn = (state.triggered >> i) & 1u;
+    }
+    rehashState();
 }
 
 string Character::getMoveDescription(int move) const {
@@ -102,104 +250,136 @@ string Character::getFullDescription() const {
     return ss.str();
 }
 
-void Character::checkAndApplyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin) {
+template <class Sink>
+void Character::applyPassiveEffect(const Passive& p, Character& self, Character& opponent, Sink& sink) {
+    BattleEvent e;
+    e.source = &self;
+    e.passive = &p;
+    e.amount = p.value;
+
+    switch (p.effect) {
+    case PassiveEffect::HEAL_SELF_FLAT:
+        self.heal(p.value);
+        e.type = BattleEventType::HEAL;
+        e.target = &self;
+        break;
+    case PassiveEffect::DAMAGE_OPPONENT_FLAT:
+        opponent.takeDamage(p.value);
+        e.type = BattleEventType::DAMAGE;
+        e.target = &opponent;
+        break;
+    case PassiveEffect::INCREASE_NEXT_ATTACK_FLAT:
+        self.addBonusDamageNextAttack(p.value);
+        e.type = BattleEventType::NEXT_ATTACK_BUFF;
+        e.target = &self;
+        break;
+    case PassiveEffect::INCREASE_ROCK_DMG_PERM:
+        self.increaseBaseRockDamage(p.value);
+        e.type = BattleEventType::PERMANENT_BUFF;
+        e.target = &self;
+        e.move = 1;
+        break;
+    case PassiveEffect::INCREASE_PAPER_DMG_PERM:
+        self.increaseBasePaperDamage(p.value);
+        e.type = BattleEventType::PERMANENT_BUFF;
+        e.target = &self;
+        e.move = 2;
+        break;
+    case PassiveEffect::INCREASE_SCISSORS_DMG_PERM:
+        self.increaseBaseScissorsDamage(p.value);
+        e.type = BattleEventType::PERMANENT_BUFF;
+        e.target = &self;
+        e.move = 3;
+        break;
+    case PassiveEffect::HEAL_SELF_PERCENT_CURRENT:
+        e.amount = (self.getCurrentHp() * p.value) / 100;
+        self.heal(e.amount);
+        e.type = BattleEventType::HEAL;
+        e.target = &self;
+        break;
+    case PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT:
+        e.amount = (opponent.getCurrentHp() * p.value) / 100;
+        opponent.takeDamage(e.amount);
+        e.type = BattleEventType::DAMAGE;
+        e.target = &opponent;
+        break;
+    default:
+        return;
+    }
+    if constexpr (Sink::enabled) sink.record(e);
+}
+
+template <class Sink>
+void Character::applyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, Sink& sink) {
+    int bucket = static_cast<int>(triggerType);
+    int first = triggerBucketStart[bucket];
+    int last = triggerBucketStart[bucket + 1];
+
     if (triggerType == PassiveTrigger::ON_HP_BELOW_PERCENT) {
-        for (auto& p : passives) {
-            if (!p.triggeredThisTurn && p.trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
-                int hpPercent = (maxHp > 0) ? (static_cast<double>(currentHp) / maxHp * 100) : 0;
-                if (hpPercent <= p.threshold && hpPercent > 0) { // Added hpPercent > 0 to avoid triggering if already 0 or less
-                    cout << self.getName() << "'s passive triggered (" << p.getDescription() << ")!\n";
-                    p.triggeredThisTurn = true;
-                    // ... (rest of effect switch)
-                    switch (p.effect) {
-                    case PassiveEffect::HEAL_SELF_FLAT: self.heal(p.value); cout << "  Healed " << p.value << " HP.\n"; break;
-                    case PassiveEffect::DAMAGE_OPPONENT_FLAT: opponent.takeDamage(p.value); cout << "  Dealt " << p.value << " damage to " << opponent.getName() << ".\n"; break;
-                    case PassiveEffect::INCREASE_NEXT_ATTACK_FLAT: self.addBonusDamageNextAttack(p.value); cout << "  Next attack + " << p.value << " damage.\n"; break;
-                    case PassiveEffect::INCREASE_ROCK_DMG_PERM: self.increaseBaseRockDamage(p.value); cout << "  Rock damage permanently increased by " << p.value << ".\n"; break;
-                    case PassiveEffect::INCREASE_PAPER_DMG_PERM: self.increaseBasePaperDamage(p.value); cout << "  Paper damage permanently increased by " << p.value << ".\n"; break;
-                    case PassiveEffect::INCREASE_SCISSORS_DMG_PERM: self.increaseBaseScissorsDamage(p.value); cout << "  Scissors damage permanently increased by " << p.value << ".\n"; break;
-                    case PassiveEffect::HEAL_SELF_PERCENT_CURRENT: {
-                        int healAmount = (self.getCurrentHp() * p.value) / 100;
-                        self.heal(healAmount);
-                        cout << "  Healed " << healAmount << " HP (" << p.value << "% of current HP).\n";
-                        break;
-                    }
-                    case PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT: {
-                        int damageAmount = (opponent.getCurrentHp() * p.value) / 100;
-                        opponent.takeDamage(damageAmount);
-                        cout << "  Dealt " << damageAmount << " damage to " << opponent.getName() << " (" << p.value << "% of their current HP).\n";
-                        break;
-                    }
-                    default: break;
-                    }
-                }
+        for (int i = first; i < last; ++i) {
+            Passive& p = passives[passiveOrder[i]];
+            // Same test as the old percentage check, done on precomputed HP cutoffs
+            if (!p.triggeredThisTurn && currentHp >= hpTriggerFloor && currentHp <= p.hpCutoff) {
+                if constexpr (Sink::enabled) sink.record({ BattleEventType::PASSIVE_TRIGGERED, &self, &self, &p });
+                p.triggeredThisTurn = true;
+                Metrics::countPassive(p.trigger, p.effect);
+                stateHash ^= zobristKey(ZobristField::TRIGGERED, passiveOrder[i]);
+                applyPassiveEffect(p, self, opponent, sink);
             }
         }
         return;
     }
 
-    for (auto& p : passives) {
-        if (p.triggeredThisTurn) continue;
+    bool conditionMet = true;
+    switch (triggerType) {
+    case PassiveTrigger::ON_WIN_ROCK: conditionMet = (move == 1 && didWin); break;
+    case PassiveTrigger::ON_WIN_PAPER: conditionMet = (move == 2 && didWin); break;
+    case PassiveTrigger::ON_WIN_SCISSORS: conditionMet = (move == 3 && didWin); break;
+    case PassiveTrigger::ON_LOSE_ROCK: conditionMet = (move == 1 && !didWin); break;
+    case PassiveTrigger::ON_LOSE_PAPER: conditionMet = (move == 2 && !didWin); break;
+    case PassiveTrigger::ON_LOSE_SCISSORS: conditionMet = (move == 3 && !didWin); break;
+    case PassiveTrigger::ON_TIE: conditionMet = !didWin; break; // For ties, didWin is false
+    case PassiveTrigger::ON_TURN_START:
+    case PassiveTrigger::AFTER_ANY_ATTACK:
+    case PassiveTrigger::AFTER_TAKING_HIT: break;
+    default: conditionMet = false; break;
+    }
+    if (!conditionMet) return;
 
-        bool triggerMatches = false;
-        switch (triggerType) {
-        case PassiveTrigger::ON_WIN_ROCK: triggerMatches = (p.trigger == triggerType && move == 1 && didWin); break;
-        case PassiveTrigger::ON_WIN_PAPER: triggerMatches = (p.trigger == triggerType && move == 2 && didWin); break;
-        case PassiveTrigger::ON_WIN_SCISSORS: triggerMatches = (p.trigger == triggerType && move == 3 && didWin); break;
-        case PassiveTrigger::ON_LOSE_ROCK: triggerMatches = (p.trigger == triggerType && move == 1 && !didWin); break;
-        case PassiveTrigger::ON_LOSE_PAPER: triggerMatches = (p.trigger == triggerType && move == 2 && !didWin); break;
-        case PassiveTrigger::ON_LOSE_SCISSORS: triggerMatches = (p.trigger == triggerType && move == 3 && !didWin); break;
-        case PassiveTrigger::ON_TIE: triggerMatches = (p.trigger == triggerType && !didWin); break; // For ties, didWin is false
-        case PassiveTrigger::ON_TURN_START: triggerMatches = (p.trigger == triggerType); break;
-        case PassiveTrigger::AFTER_ANY_ATTACK: triggerMatches = (p.trigger == triggerType); break;
-        case PassiveTrigger::AFTER_TAKING_HIT: triggerMatches = (p.trigger == triggerType); break;
-        default: break;
-        }
+    for (int i = first; i < last; ++i) {
+        Passive& p = passives[passiveOrder[i]];
+        if (p.triggeredThisTurn) continue;
 
-        if (triggerMatches) {
-            cout << self.getName() << "'s passive triggered (" << p.getDescription() << ")!\n";
-            p.triggeredThisTurn = true;
-            // ... (rest of effect switch)
-            switch (p.effect) {
-            case PassiveEffect::HEAL_SELF_FLAT: self.heal(p.value); cout << "  Healed " << p.value << " HP.\n"; break;
-            case PassiveEffect::DAMAGE_OPPONENT_FLAT: opponent.takeDamage(p.value); cout << "  Dealt " << p.value << " damage to " << opponent.getName() << ".\n"; break;
-            case PassiveEffect::INCREASE_NEXT_ATTACK_FLAT: self.addBonusDamageNextAttack(p.value); cout << "  Next attack + " << p.value << " damage.\n"; break;
-            case PassiveEffect::INCREASE_ROCK_DMG_PERM: self.increaseBaseRockDamage(p.value); cout << "  Rock damage permanently increased by " << p.value << ".\n"; break;
-            case PassiveEffect::INCREASE_PAPER_DMG_PERM: self.increaseBasePaperDamage(p.value); cout << "  Paper damage permanently increased by " << p.value << ".\n"; break;
-            case PassiveEffect::INCREASE_SCISSORS_DMG_PERM: self.increaseBaseScissorsDamage(p.value); cout << "  Scissors damage permanently increased by " << p.value << ".\n"; break;
-            case PassiveEffect::HEAL_SELF_PERCENT_CURRENT: {
-                int healAmount = (self.getCurrentHp() * p.value) / 100;
-                self.heal(healAmount);
-                cout << "  Healed " << healAmount << " HP (" << p.value << "% of current HP).\n";
-                break;
-            }
-            case PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT: {
-                int damageAmount = (opponent.getCurrentHp() * p.value) / 100;
-                opponent.takeDamage(damageAmount);
-                cout << "  Dealt " << damageAmount << " damage to " << opponent.getName() << " (" << p.value << "% of their current HP).\n";
-                break;
-            }
-            default: break;
-            }
-            if (opponent.isDefeated()) {
-                cout << opponent.getName() << " was defeated by the passive effect!\n";
-            }
-            if (self.isDefeated()) {
-                cout << self.getName() << " was defeated by their own passive effect!?\n";
-            }
+        if constexpr (Sink::enabled) sink.record({ BattleEventType::PASSIVE_TRIGGERED, &self, &self, &p });
+        p.triggeredThisTurn = true;
+        Metrics::countPassive(p.trigger, p.effect);
+        stateHash ^= zobristKey(ZobristField::TRIGGERED, passiveOrder[i]);
+        applyPassiveEffect(p, self, opponent, sink);
+        if constexpr (Sink::enabled) {
+            if (opponent.isDefeated()) sink.record({ BattleEventType::DEFEAT, &self, &opponent, &p });
+            if (self.isDefeated()) sink.record({ BattleEventType::DEFEAT, &self, &self, &p });
         }
     }
 }
 
-OG::OG() : Character("OG", 20, 1, 2, 3, {}, "BUILTIN") {}
-Helios::Helios() : Character("Helios", 25, 1, 0, 2, { Passive(PassiveTrigger::ON_WIN_PAPER, PassiveEffect::HEAL_SELF_FLAT, 5) }, "BUILTIN") {}
-Duran::Duran() : Character("Duran", 15, 2, 1, 3, { Passive(PassiveTrigger::ON_WIN_SCISSORS, PassiveEffect::INCREASE_NEXT_ATTACK_FLAT, 3) }, "BUILTIN") {}
-Philip::Philip() : Character("Philip", 18, 1, 2, 1, { Passive(PassiveTrigger::ON_TIE, PassiveEffect::DAMAGE_OPPONENT_FLAT, 1) }, "BUILTIN") {}
-Razor::Razor() : Character("Razor", 7, 3, 4, 5, {}, "BUILTIN") {}
-Sunny::Sunny() : Character("Sunny", 14, 1, 3, 2,
-    {
-        Passive(PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_ROCK_DMG_PERM, 4, 28),
-        Passive(PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_PAPER_DMG_PERM, 2, 28),
-        Passive(PassiveTrigger::ON_HP_BELOW_PERCENT, PassiveEffect::INCREASE_SCISSORS_DMG_PERM, 3, 28)
-    }, "BUILTIN") {
-}
\ No newline at end of file
+void Character::dispatchPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, BattleEventSink& sink) {
+    applyPassives(triggerType, self, opponent, move, didWin, sink);
+}
+
+void Character::dispatchPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, NullEventSink sink) {
+    applyPassives(triggerType, self, opponent, move, didWin, sink);
+}
+
+OG::OG() : Character(BUILTIN_ROSTER[BUILTIN_OG]) {}
+Helios::Helios() : Character(BUILTIN_ROSTER[BUILTIN_HELIOS]) {}
+Duran::Duran() : Character(BUILTIN_ROSTER[BUILTIN_DURAN]) {}
+Philip::Philip() : Character(BUILTIN_ROSTER[BUILTIN_PHILIP]) {}
+Razor::Razor() : Character(BUILTIN_ROSTER[BUILTIN_RAZOR]) {}
+Sunny::Sunny() : Character(BUILTIN_ROSTER[BUILTIN_SUNNY]) {}
+
+unique_ptr<Character> OG::clone() const { return make_unique<OG>(*this); }
+unique_ptr<Character> Helios::clone() const { return make_unique<Helios>(*this); }
+unique_ptr<Character> Duran::clone() const { return make_unique<Duran>(*this); }
+unique_ptr<Character> Philip::clone() const { return make_unique<Philip>(*this); }
+unique_ptr<Character> Razor::clone() const { return make_unique<Razor>(*this); }
+unique_ptr<Character> Sunny::clone() const { return make_unique<Sunny>(*this); }
@@ -3,11 +3,45 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 #include "PassiveSystem.h"
+#include "BattleEvents.h"
+#include "Zobrist.h"
+
+struct BuiltinSpec;
+
+// Dense roster index handed out by CharacterRegistry
+using CharacterId = uint32_t;
+const CharacterId INVALID_CHARACTER_ID = UINT32_MAX;
+
+enum class CharacterType : uint8_t {
+    BUILTIN,
+    CUSTOM
+};
+
+// "BUILTIN"/"CUSTOM", as written in the save file
+const char* characterTypeName(CharacterType type);
 
 class Character {
+    friend class CharacterRegistry;
+
+public:
+    // Everything a battle changes on a fighter, so solvers and searches can
+    // rewind one without copying the whole character
+    struct BattleState {
+        int hp = 0;
+        int bonus = 0;
+        int rock = 0;
+        int paper = 0;
+        int scissors = 0;
+        uint32_t triggered = 0; // Bit i = passives[i].triggeredThisTurn
+
+        bool operator==(const BattleState&) const = default;
+    };
+
 protected:
     std::string name;
     int maxHp;
@@ -17,16 +51,36 @@ protected:
     int baseScissorsDamage;
     int bonusDamageNextAttack;
     std::vector<Passive> passives;
-    std::string characterType; // "BUILTIN" or "CUSTOM"
+    CharacterType characterType;
+    CharacterId id = INVALID_CHARACTER_ID; // Copies keep the roster ID of their prototype
+
+    // Passive indices grouped by trigger (original order kept within a group),
+    // so a trigger check only visits the passives that can fire for it
+    std::vector<uint8_t> passiveOrder;
+    std::array<uint8_t, PASSIVE_TRIGGER_COUNT + 1> triggerBucketStart{};
+    uint32_t passiveTriggerMask = 0; // Bit per PassiveTrigger that has at least one passive
+    int hpTriggerFloor = 1;          // Lowest HP that counts as above 0% for ON_HP_BELOW_PERCENT
+    uint64_t definitionHash = 0;     // Name, max HP and passives; fixed for the character's lifetime
+    uint64_t stateHash = 0;          // definitionHash plus Zobrist keys of the battle state, kept current
+    BattleState builtState;          // Full HP and the move damage the character was built with
 
 public:
-    Character(const std::string& n, int hp, int rock, int paper, int scissors, std::string type = "BUILTIN");
-    Character(const std::string& n, int hp, int rock, int paper, int scissors, std::vector<Passive> p, std::string type = "CUSTOM");
+    Character(const std::string& n, int hp, int rock, int paper, int scissors, CharacterType type = CharacterType::BUILTIN);
+    Character(const std::string& n, int hp, int rock, int paper, int scissors, std::vector<Passive> p, CharacterType type = CharacterType::CUSTOM);
+    // A built-in, from its row of BUILTIN_ROSTER
+    explicit Character(const BuiltinSpec& spec);
 
     void resetStatsForNewBattle();
+    // Also undoes permanent buffs, which resetStatsForNewBattle keeps: the
+    // character as it was built, whatever battles it fought since
+    void resetToDefinition();
     virtual ~Character();
 
-    std::string getName() const;
+    // Copy with the same dynamic type. Subclasses that add state must override
+    // this; CharacterPool relies on it and on copy assignment.
+    virtual std::unique_ptr<Character> clone() const;
+
+    const std::string& getName() const;
     int getMaxHp() const;
     int getCurrentHp() const;
     int getRockDamage() const;
@@ -34,14 +88,40 @@ public:
     int getScissorsDamage() const;
     int getBonusDamageNextAttack() const; // Added for AI
     const std::vector<Passive>& getPassives() const;
-    std::string getType() const;
+    CharacterType getType() const;
+    CharacterId getId() const { return id; }
 
     bool isDefeated() const;
 
     virtual void takeDamage(int damage);
     virtual void heal(int amount);
     virtual int calculateDamage(int move);
-    virtual void checkAndApplyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move = 0, bool didWin = false);
+    bool hasPassiveFor(PassiveTrigger trigger) const {
+        return (passiveTriggerMask >> static_cast<int>(trigger)) & 1u;
+    }
+    uint32_t getPassiveTriggerMask() const { return passiveTriggerMask; }
+    int getHpTriggerFloor() const { return hpTriggerFloor; }
+    // Tells apart fighters whose battle states could otherwise look identical (AI caches)
+    uint64_t getDefinitionHash() const { return definitionHash; }
+    // Everything captureBattleState covers, updated incrementally on every change
+    uint64_t getStateHash() const { return stateHash; }
+    // Fires every matching passive, reporting what happened to the sink.
+    // Triggers this character has no passive for cost a single bit test.
+    void checkAndApplyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, BattleEventSink& sink) {
+        if (hasPassiveFor(triggerType)) dispatchPassives(triggerType, self, opponent, move, didWin, sink);
+    }
+    void checkAndApplyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move = 0, bool didWin = false, NullEventSink sink = {}) {
+        if (hasPassiveFor(triggerType)) dispatchPassives(triggerType, self, opponent, move, didWin, sink);
+    }
+    // Marks passives[index] as fired this turn; false if it already had. For the
+    // built-in kernels, which resolve triggers at compile time and apply effects themselves.
+    bool markPassiveFired(size_t index) {
+        Passive& p = passives[index];
+        if (p.triggeredThisTurn) return false;
+        p.triggeredThisTurn = true;
+        stateHash ^= zobristKey(ZobristField::TRIGGERED, static_cast<int>(index));
+        return true;
+    }
     void addBonusDamageNextAttack(int amount);
     void increaseBaseRockDamage(int amount);
     void increaseBasePaperDamage(int amount);
@@ -52,36 +132,58 @@ public:
     virtual std::string getFullDescription() const;
 
     void resetTurnState();
+
+    BattleState captureBattleState() const;
+    void restoreBattleState(const BattleState& state);
+
+private:
+    void indexPassives();
+    void rehashState();
+    void rehashField(ZobristField field, int oldValue, int newValue) {
+        stateHash ^= zobristKey(field, oldValue) ^ zobristKey(field, newValue);
+    }
+    void dispatchPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, BattleEventSink& sink);
+    void dispatchPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, NullEventSink sink);
+    template <class Sink>
+    void applyPassives(PassiveTrigger triggerType, Character& self, Character& opponent, int move, bool didWin, Sink& sink);
+    template <class Sink>
+    void applyPassiveEffect(const Passive& p, Character& self, Character& opponent, Sink& sink);
 };
 
 class OG : public Character {
 public:
     OG();
+    std::unique_ptr<Character> clone() const override;
 };
 
 class Helios : public Character {
 public:
     Helios();
+    std::unique_ptr<Character> clone() const override;
 };
 
 class Duran : public Character {
 public:
     Duran();
+    std::unique_ptr<Character> clone() const override;
 };
 
 class Philip : public Character {
 public:
     Philip();
+    std::unique_ptr<Character> clone() const override;
 };
 
 class Razor : public Character {
 public:
     Razor();
+    std::unique_ptr<Character> clone() const override;
 };
 
 class Sunny : public Character {
 public:
     Sunny();
+    std::unique_ptr<Character> clone() const override;
 };
 
 #endif // CHARACTER_H
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "CharacterImporter.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Chunks per worker, so an uneven file still keeps every thread busy
+    const size_t K_CHUNKS_PER_THREAD = 4;
+    // Smaller files are not worth waking the pool for
+    const size_t K_MIN_CHUNK_BYTES = 256 * 1024;
+
+    const string_view K_CUSTOM_TYPE = characterTypeName(CharacterType::CUSTOM);
+    const string_view K_BUILTIN_TYPE = characterTypeName(CharacterType::BUILTIN);
+
+    bool isSpace(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    // stoi's rules on a field, without exceptions
+    SaveLineStatus parseInt(string_view field, int& out) {
+        // Fast path: up to 9 plain digits cannot overflow an int
+        if (!field.empty() && field.size() <= 9) {
+            int value = 0;
+            size_t i = 0;
+            while (i < field.size() && field[i] >= '0' && field[i] <= '9') value = value * 10 + (field[i++] - '0');
+            if (i == field.size()) {
+                out = value;
+                return SaveLineStatus::CHARACTER;
+            }
+        }
+
+        const char* p = field.data();
+        const char* end = p + field.size();
+        while (p < end && isSpace(*p)) ++p;
+        if (p < end && *p == '+') {
+            ++p;
+            if (p == end || *p < '0' || *p > '9') return SaveLineStatus::INVALID_NUMBER;
+        }
+        auto [next, ec] = from_chars(p, end, out);
+        if (ec == errc::result_out_of_range) return SaveLineStatus::OUT_OF_RANGE;
+        if (ec != errc() || next == p) return SaveLineStatus::INVALID_NUMBER;
+        return SaveLineStatus::CHARACTER;
+    }
+
+    // Next separator-delimited field, with getline's behavior: no empty field after a trailing separator
+    // Fields are a few bytes long, so a plain scan beats a memchr call per field.
+    bool nextField(string_view text, size_t& pos, char separator, string_view& field) {
+        if (pos >= text.size()) return false;
+        size_t stop = pos;
+        while (stop < text.size() && text[stop] != separator) ++stop;
+        field = string_view(text.data() + pos, stop - pos);
+        pos = stop + 1;
+        return true;
+    }
+
+    // Passive::fromString: up to four readable numbers, unreadable ones skipped
+    Passive parsePassive(string_view text) {
+        int data[4] = { 0 };
+        int count = 0;
+        size_t pos = 0;
+        string_view field;
+        while (count < 4 && nextField(text, pos, ',', field)) {
+            int value;
+            if (parseInt(field, value) == SaveLineStatus::CHARACTER) data[count++] = value;
+        }
+        Passive p;
+        if (count >= 2) { // Need at least trigger and effect
+            p.trigger = static_cast<PassiveTrigger>(data[0]);
+            p.effect = static_cast<PassiveEffect>(data[1]);
+            p.value = data[2];
+            p.threshold = data[3];
+        }
+        return p;
+    }
+
+    struct Chunk {
+        size_t begin = 0;
+        size_t end = 0;
+        size_t lines = 0;
+        vector<unique_ptr<Character>> characters;
+        vector<ImportError> errors; // Line numbers relative to the chunk until merged
+    };
+
+    void importChunk(string_view text, Chunk& chunk) {
+        SaveLine line;
+        size_t pos = chunk.begin;
+        while (pos < chunk.end) {
+            const char* newline = static_cast<const char*>(memchr(text.data() + pos, '\n', chunk.end - pos));
+            size_t stop = newline ? static_cast<size_t>(newline - text.data()) : chunk.end;
+            string_view raw = text.substr(pos, stop - pos);
+            if (!raw.empty() && raw.back() == '\r') raw.remove_suffix(1); // What text mode does on Windows
+            pos = stop + 1;
+            ++chunk.lines;
+
+            SaveLineStatus status = parseSaveLine(raw, line);
+            if (status == SaveLineStatus::CHARACTER) {
+                chunk.characters.push_back(makeCustomCharacter(line));
+            }
+            else if (status != SaveLineStatus::SKIPPED) {
+                chunk.errors.push_back({ chunk.lines, status, string(raw) });
+            }
+        }
+    }
+}
+
+SaveLineStatus parseSaveLine(string_view line, SaveLine& out) {
+    if (line.empty() || line[0] == '#') return SaveLineStatus::SKIPPED;
+    out.passives.clear();
+
+    string_view fields[6];
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < 6 && nextField(line, pos, ';', fields[count])) ++count;
+
+    if (count < 6 || fields[0] != K_CUSTOM_TYPE) {
+        return fields[0] == K_BUILTIN_TYPE ? SaveLineStatus::SKIPPED : SaveLineStatus::MALFORMED;
+    }
+
+    out.name = fields[1];
+    int* numbers[4] = { &out.hp, &out.rock, &out.paper, &out.scissors };
+    for (int i = 0; i < 4; ++i) {
+        SaveLineStatus status = parseInt(fields[i + 2], *numbers[i]);
+        if (status != SaveLineStatus::CHARACTER) return status;
+    }
+
+    string_view field;
+    while (nextField(line, pos, ';', field)) {
+        if (!field.empty()) out.passives.push_back(parsePassive(field));
+    }
+    return SaveLineStatus::CHARACTER;
+}
+
+const char* saveLineStatusMessage(SaveLineStatus status) {
+    switch (status) {
+    case SaveLineStatus::MALFORMED: return "Skipping malformed line or non-custom character entry";
+    case SaveLineStatus::INVALID_NUMBER: return "Error parsing line (invalid number)";
+    case SaveLineStatus::OUT_OF_RANGE: return "Error parsing line (number out of range)";
+    default: return "";
+    }
+}
+
+unique_ptr<Character> makeCustomCharacter(const SaveLine& line) {
+    return make_unique<Character>(string(line.name), line.hp, line.rock, line.paper, line.scissors,
+        line.passives, CharacterType::CUSTOM);
+}
+
+CharacterImport importCharacterText(string_view text, unsigned threads) {
+    CharacterImport result;
+    result.opened = true;
+    result.bytes = text.size();
+
+    unsigned workers = threads ? threads : max(1u, thread::hardware_concurrency());
+    size_t chunkCount = min(static_cast<size_t>(workers) * K_CHUNKS_PER_THREAD, text.size() / K_MIN_CHUNK_BYTES);
+    if (workers == 1 || chunkCount < 2) chunkCount = 1;
+
+    // Cut at even offsets, then move each cut just past the next newline
+    vector<Chunk> chunks(chunkCount);
+    size_t start = 0;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        size_t cut = text.size();
+        if (i + 1 < chunkCount) {
+            cut = max(start, text.size() / chunkCount * (i + 1));
+            size_t newline = text.find('\n', cut);
+            cut = (newline == string_view::npos) ? text.size() : newline + 1;
+        }
+        chunks[i].begin = start;
+        chunks[i].end = cut;
+        start = cut;
+    }
+
+    if (chunkCount == 1) {
+        importChunk(text, chunks[0]);
+    }
+    else {
+        ThreadPool pool(min<unsigned>(workers, static_cast<unsigned>(chunkCount)));
+        pool.parallelFor(0, chunkCount, 1, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) importChunk(text, chunks[i]);
+        });
+    }
+
+    size_t characterCount = 0;
+    for (const Chunk& chunk : chunks) characterCount += chunk.characters.size();
+    result.characters.reserve(characterCount);
+
+    size_t firstLine = 0;
+    for (Chunk& chunk : chunks) {
+        for (auto& character : chunk.characters) result.characters.push_back(std::move(character));
+        for (ImportError& error : chunk.errors) {
+            error.lineNumber += firstLine;
+            result.errors.push_back(std::move(error));
+        }
+        firstLine += chunk.lines;
+    }
+    return result;
+}
+
+CharacterImport importCharacterFile(const string& path, unsigned threads) {
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in) return CharacterImport();
+
+    string text(static_cast<size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(text.data(), static_cast<streamsize>(text.size()));
+    if (!in) {
+        cerr << "Error: failed while reading " << path << endl;
+        CharacterImport failed;
+        failed.opened = true; // It exists, so the caller must not replace it
+        return failed;
+    }
+    return importCharacterText(text, threads);
+}
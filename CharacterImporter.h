@@ -0,0 +1,62 @@
+#ifndef CHARACTERIMPORTER_H
+#define CHARACTERIMPORTER_H
+
+#include "Character.h"
+#include "PassiveSystem.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Outcome of parsing one line of the text save file
+enum class SaveLineStatus {
+    CHARACTER,      // A CUSTOM line; the fields are filled in
+    SKIPPED,        // Blank, comment or BUILTIN line
+    MALFORMED,      // Too few fields or an unknown type
+    INVALID_NUMBER,
+    OUT_OF_RANGE
+};
+
+// Fields of one CUSTOM line. name views the line it was parsed from.
+struct SaveLine {
+    std::string_view name;
+    int hp = 0;
+    int rock = 0;
+    int paper = 0;
+    int scissors = 0;
+    std::vector<Passive> passives; // Cleared per line, so its capacity is reused
+};
+
+// Parses "CUSTOM;NAME;HP;ROCK;PAPER;SCISSORS;T,E,V,TH;..." without allocating
+// (beyond growing out.passives). Numbers follow stoi's rules: leading
+// whitespace and a sign are allowed and anything after the digits is ignored.
+// Passive fields follow Passive::fromString: unreadable numbers are skipped.
+SaveLineStatus parseSaveLine(std::string_view line, SaveLine& out);
+
+// "Error parsing line (invalid number)" and friends; empty for CHARACTER/SKIPPED
+const char* saveLineStatusMessage(SaveLineStatus status);
+
+std::unique_ptr<Character> makeCustomCharacter(const SaveLine& line);
+
+struct ImportError {
+    size_t lineNumber;    // 1-based
+    SaveLineStatus status;
+    std::string text;
+};
+
+struct CharacterImport {
+    bool opened = false;
+    size_t bytes = 0;
+    std::vector<std::unique_ptr<Character>> characters; // File order, duplicates included
+    std::vector<ImportError> errors;                     // File order
+};
+
+// Reads a save file in one go, splits it into line-aligned chunks and parses
+// and builds the characters on worker threads (0 = one per hardware thread).
+// Results come back in file order, so adding them in sequence gives the same
+// roster as reading the file line by line.
+CharacterImport importCharacterFile(const std::string& path, unsigned threads = 0);
+CharacterImport importCharacterText(std::string_view text, unsigned threads = 0);
+
+#endif // CHARACTERIMPORTER_H
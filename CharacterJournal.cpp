@@ -0,0 +1,200 @@
+#include "CharacterJournal.h"
+#include "FileSync.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+namespace {
+    // FNV-1a over the op and the payload
+    uint32_t entryChecksum(char op, const string& payload) {
+        uint32_t h = 0x811C9DC5u;
+        h = (h ^ static_cast<unsigned char>(op)) * 0x01000193u;
+        for (char c : payload) h = (h ^ static_cast<unsigned char>(c)) * 0x01000193u;
+        return h;
+    }
+
+    bool readWholeFile(const string& path, string& out) {
+        ifstream in(path, ios::binary);
+        if (!in) return false;
+        ostringstream buffer;
+        buffer << in.rdbuf();
+        out = buffer.str();
+        return true;
+    }
+
+    // Applies every intact entry and returns the length of the good prefix
+    size_t replayEntries(const string& data, const function<void(JournalOp, const string&)>& apply, size_t& applied) {
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t end = data.find('\n', pos);
+            if (end == string::npos) break; // Torn final line
+
+            // "<op> <8 hex digits> <payload>"
+            const size_t headerLength = 11;
+            if (end - pos < headerLength || data[pos + 1] != ' ' || data[pos + 10] != ' ') break;
+            char op = data[pos];
+            if (op != static_cast<char>(JournalOp::CREATE) && op != static_cast<char>(JournalOp::DELETE)) break;
+            uint32_t stored = 0;
+            bool hexOk = true;
+            for (size_t i = pos + 2; i < pos + 10 && hexOk; ++i) {
+                char c = data[i];
+                int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+                hexOk = digit >= 0;
+                stored = (stored << 4) | static_cast<uint32_t>(digit);
+            }
+            string payload = data.substr(pos + headerLength, end - pos - headerLength);
+            if (!hexOk || stored != entryChecksum(op, payload)) break;
+
+            apply(static_cast<JournalOp>(op), payload);
+            ++applied;
+            pos = end + 1;
+        }
+        return pos;
+    }
+}
+
+CharacterJournal::CharacterJournal(string path, uint64_t compactBytes)
+    : path(std::move(path)), compactBytes(compactBytes) {
+    oldPath = this->path + ".old";
+}
+
+CharacterJournal::~CharacterJournal() {
+    finishCompaction();
+    close();
+}
+
+size_t CharacterJournal::replay(const function<void(JournalOp, const string&)>& apply) {
+    finishCompaction();
+    close();
+
+    size_t applied = 0;
+    string data;
+    if (readWholeFile(oldPath, data)) {
+        // Never appended to again, so a bad tail here is only skipped
+        replayEntries(data, apply, applied);
+    }
+
+    liveBytes = 0;
+    if (readWholeFile(path, data)) {
+        size_t good = replayEntries(data, apply, applied);
+        if (good < data.size()) {
+            cerr << "Warning: dropping " << (data.size() - good) << " unreadable bytes at the end of " << path << endl;
+            error_code ec;
+            filesystem::resize_file(path, good, ec);
+            if (ec) cerr << "Error: could not truncate " << path << ": " << ec.message() << endl;
+        }
+        liveBytes = good;
+    }
+    return applied;
+}
+
+bool CharacterJournal::openForAppend() {
+    if (file) return true;
+    error_code ec;
+    bool created = !filesystem::exists(path, ec);
+    file = fopen(path.c_str(), "ab");
+    if (!file) {
+        cerr << "Error: Could not open " << path << " for writing!" << endl;
+        return false;
+    }
+    // Synced entries in a file whose name never reached the disk would be lost with it
+    if (created && !syncParentDirectory(path)) {
+        cerr << "Error: could not flush the directory of " << path << endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CharacterJournal::close() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+bool CharacterJournal::append(JournalOp op, const string& payload) {
+    if (payload.find('\n') != string::npos || !openForAppend()) return false;
+
+    char header[16];
+    snprintf(header, sizeof(header), "%c %08x ", static_cast<char>(op), entryChecksum(static_cast<char>(op), payload));
+    string line = header + payload + '\n';
+    if (fwrite(line.data(), 1, line.size(), file) != line.size() || !syncFile(file)) {
+        cerr << "Error: failed while writing " << path << endl;
+        return false;
+    }
+    liveBytes += line.size();
+    return true;
+}
+
+bool CharacterJournal::compacting() const {
+    return pending.valid() && pending.wait_for(chrono::seconds(0)) != future_status::ready;
+}
+
+bool CharacterJournal::rotate() {
+    close();
+    error_code ec;
+    if (!filesystem::exists(oldPath, ec)) {
+        filesystem::rename(path, oldPath, ec);
+        if (ec) {
+            cerr << "Error: could not rotate " << path << ": " << ec.message() << endl;
+            return false;
+        }
+        if (!syncParentDirectory(oldPath)) {
+            cerr << "Error: could not flush the rotation of " << path << endl;
+            return false;
+        }
+    }
+    else {
+        // A failed compaction left its entries behind; they must survive until a snapshot lands
+        string data;
+        FILE* old = fopen(oldPath.c_str(), "ab");
+        bool ok = old && readWholeFile(path, data)
+            && fwrite(data.data(), 1, data.size(), old) == data.size() && syncFile(old);
+        if (old) fclose(old);
+        if (!ok) {
+            cerr << "Error: could not rotate " << path << " into " << oldPath << endl;
+            return false;
+        }
+        filesystem::remove(path, ec);
+    }
+    liveBytes = 0;
+    return true;
+}
+
+bool CharacterJournal::compact(function<bool()> writeSnapshot) {
+    if (compacting()) return false;
+    finishCompaction(); // Collect a result that is ready but unreported
+    if (!rotate()) return false;
+
+    string rotated = oldPath;
+    pending = async(launch::async, [writeSnapshot = std::move(writeSnapshot), rotated]() {
+        // The snapshot is durable once this returns true; only then may its entries go
+        if (!writeSnapshot()) return false;
+        error_code ec;
+        filesystem::remove(rotated, ec);
+        return true;
+    });
+    return true;
+}
+
+bool CharacterJournal::finishCompaction() {
+    if (!pending.valid()) return true;
+    bool ok = pending.get();
+    if (!ok) cerr << "Error: journal compaction failed; its entries stay in " << oldPath << endl;
+    return ok;
+}
+
+void CharacterJournal::clear() {
+    finishCompaction();
+    close();
+    error_code ec;
+    filesystem::remove(oldPath, ec);
+    filesystem::remove(path, ec);
+    liveBytes = 0;
+}
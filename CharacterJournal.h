@@ -0,0 +1,69 @@
+#ifndef CHARACTERJOURNAL_H
+#define CHARACTERJOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <string>
+
+enum class JournalOp : char {
+    CREATE = '+', // Payload: the character's save file line
+    DELETE = '-'  // Payload: the character's name
+};
+
+// Append-only log of roster edits, kept beside the save file so an edit costs
+// one small append instead of a full rewrite. Each entry is one line,
+// "<op> <checksum> <payload>", flushed to disk before append() returns; a
+// line torn by a crash fails its checksum and is dropped on replay.
+//
+// Compaction folds the log into the save file. The live log is rotated to
+// path.old, the caller's snapshot is written on a background thread, and
+// path.old is deleted once the snapshot is in place, while new edits go to a
+// fresh live log. Replaying a create of a name that exists, or a delete of a
+// name that does not, is a no-op, so replaying entries the save file already
+// holds (after a crash mid-compaction) leaves the same roster.
+class CharacterJournal {
+public:
+    static const uint64_t DEFAULT_COMPACT_BYTES = 256 * 1024;
+
+    explicit CharacterJournal(std::string path, uint64_t compactBytes = DEFAULT_COMPACT_BYTES);
+    ~CharacterJournal(); // Waits for a running compaction
+
+    CharacterJournal(const CharacterJournal&) = delete;
+    CharacterJournal& operator=(const CharacterJournal&) = delete;
+
+    // Feeds path.old, then path, to apply in order and returns the entry count.
+    // A bad tail on the live log is cut off so later appends follow good data.
+    size_t replay(const std::function<void(JournalOp, const std::string&)>& apply);
+
+    bool append(JournalOp op, const std::string& payload);
+
+    uint64_t size() const { return liveBytes; } // Bytes in the live log
+    bool compactionDue() const { return liveBytes >= compactBytes && !compacting(); }
+    bool compacting() const;
+
+    // writeSnapshot must capture every edit appended so far before this is
+    // called, and return true only once the snapshot is synced and renamed
+    // into place durably (replaceFileDurably); it runs on another thread. false if a compaction is already
+    // running or the log could not be rotated.
+    bool compact(std::function<bool()> writeSnapshot);
+    // Waits for a running compaction; false if it failed (its entries stay in path.old)
+    bool finishCompaction();
+    // After a synchronous full save that is already durable: drops both logs
+    void clear();
+
+private:
+    std::string path;
+    std::string oldPath;
+    uint64_t compactBytes;
+    uint64_t liveBytes = 0;
+    std::FILE* file = nullptr;
+    std::future<bool> pending;
+
+    bool openForAppend();
+    void close();
+    bool rotate();
+};
+
+#endif // CHARACTERJOURNAL_H
@@ -1,118 +1,314 @@
 #include "CharacterManager.h"
 #include "Utils.h"
+#include "TerminalRenderer.h"
 #include "PassiveSystem.h"
 #include "Character.h"
+#include "RosterFile.h"
+#include "CharacterJournal.h"
+#include "CharacterImporter.h"
+#include "FileSync.h"
+#include "Metrics.h"
+#include "BalanceEstimate.h"
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <algorithm>
 #include <limits>
 #include <vector> 
+#include <filesystem>
+#include <functional>
+#include <chrono>
+#include <cstdio>
 
 using namespace std; 
 
 // Definition of global available characters list
-vector<unique_ptr<Character>> availableCharacters;
+CharacterRegistry availableCharacters;
 
-// Definition of save file constant
+// Definition of save file constants
 const string SAVE_FILE = "characters.txt";
+const string ROSTER_FILE = "characters.roster";
+const string JOURNAL_FILE = "characters.journal";
+
+namespace {
+    // Set when the roster was mapped at load, so saves keep using the binary format
+    bool savesToRoster = false;
+
+    // Creates and deletes since the last full save
+    CharacterJournal journal(JOURNAL_FILE);
+
+    const char* K_TEXT_HEADER =
+        "# Format: TYPE;NAME;HP;ROCK;PAPER;SCISSORS;PASSIVE1_STR;PASSIVE2_STR;...\n"
+        "# Passive Str: TRIGGER_ID,EFFECT_ID,VALUE,THRESHOLD\n";
+
+    // Writes the roster beside the old one, maps the new file, then renames it
+    // into place. The old mapping is released before the rename, which Windows needs.
+    bool saveRoster() {
+        RosterWriter writer;
+        availableCharacters.writeCustoms(writer);
+        const string tempFile = ROSTER_FILE + ".tmp";
+        if (!writer.write(tempFile)) return false;
+
+        shared_ptr<const RosterFile> saved = RosterFile::open(tempFile);
+        if (!saved || !availableCharacters.reattach(std::move(saved))) {
+            cerr << "Error: could not reopen the saved roster " << tempFile << endl;
+            return false;
+        }
+        return replaceFileDurably(tempFile, ROSTER_FILE);
+    }
+
+    // Copies every custom into memory and returns the job that writes them out,
+    // so the disk work can run on another thread while the roster keeps changing.
+    // A mapped roster is not remapped here: the old mapping stays readable after
+    // the rename (on Windows because it was opened with FILE_SHARE_DELETE).
+    function<bool()> snapshotCustoms() {
+        if (savesToRoster) {
+            auto writer = make_shared<RosterWriter>();
+            availableCharacters.writeCustoms(*writer);
+            return [writer]() {
+                const string tempFile = ROSTER_FILE + ".tmp";
+                return writer->write(tempFile) && replaceFileDurably(tempFile, ROSTER_FILE);
+            };
+        }
+
+        ostringstream text;
+        text << K_TEXT_HEADER;
+        for (CharacterId id : availableCharacters.idsOfType(CharacterType::CUSTOM)) {
+            writeCharacterLine(text, *availableCharacters[id]);
+            text << '\n';
+        }
+        auto contents = make_shared<string>(text.str());
+        return [contents]() {
+            const string tempFile = SAVE_FILE + ".tmp";
+            FILE* outfile = fopen(tempFile.c_str(), "wb");
+            if (!outfile) {
+                cerr << "Error: Could not open " << tempFile << " for writing!" << endl;
+                return false;
+            }
+            bool written = fwrite(contents->data(), 1, contents->size(), outfile) == contents->size() && syncFile(outfile);
+            written &= fclose(outfile) == 0;
+            if (!written) {
+                cerr << "Error: failed while writing " << tempFile << endl;
+                return false;
+            }
+            return replaceFileDurably(tempFile, SAVE_FILE);
+        };
+    }
+
+    void reportImportErrors(const CharacterImport& imported) {
+        for (const ImportError& error : imported.errors) {
+            cerr << saveLineStatusMessage(error.status) << " (line " << error.lineNumber << "): " << error.text << endl;
+        }
+    }
+
+    void replayJournal() {
+        size_t applied = journal.replay([](JournalOp op, const string& payload) {
+            if (op == JournalOp::CREATE) {
+                unique_ptr<Character> created = parseCharacterLine(payload);
+                if (created) availableCharacters.add(std::move(created));
+            }
+            else {
+                CharacterId id = availableCharacters.idOf(payload);
+                if (id != INVALID_CHARACTER_ID && availableCharacters[id]->getType() == CharacterType::CUSTOM) {
+                    availableCharacters.remove(id);
+                }
+            }
+        });
+        if (applied > 0) {
+            cout << "Replayed " << applied << " edits from " << JOURNAL_FILE << ". Total characters: " << availableCharacters.size() << endl;
+        }
+    }
+
+    // Logs one edit; past the size threshold the journal is folded into the save file in the background
+    void journalEdit(JournalOp op, const string& payload) {
+        bool appended;
+        {
+            MetricTimer timer(MetricHistogram::JOURNAL_APPEND);
+            appended = journal.append(op, payload);
+        }
+        if (!appended) {
+            cerr << "Falling back to a full save" << endl;
+            saveCharacters();
+            return;
+        }
+        cout << "Change saved to " << JOURNAL_FILE << endl;
+        if (journal.compactionDue()) journal.compact(snapshotCustoms());
+    }
+
+    const char* verdictLabel(const MatchupEstimate& m) {
+        if (!m.decided) return "undecided";
+        switch (m.verdict) {
+        case SprtVerdict::FAVOURED: return "favoured";
+        case SprtVerdict::UNFAVOURED: return "unfavoured";
+        default: return "close";
+        }
+    }
+
+    // Win rates against the built-ins, shown before the new character is saved.
+    // The roster entries may carry buffs from menu battles, so it plays copies without them.
+    void printBalanceEstimate(const Character& created) {
+        vector<unique_ptr<Character>> builtins;
+        vector<const Character*> opponents;
+        for (CharacterId id : availableCharacters.idsOfType(CharacterType::BUILTIN)) {
+            builtins.push_back(availableCharacters[id]->clone());
+            builtins.back()->resetToDefinition();
+            opponents.push_back(builtins.back().get());
+        }
+        if (opponents.empty()) return;
+
+        BalanceReport report = estimateBalance(created, opponents);
+        cout << "\n--- Estimated win rates (optimal AI on both sides) ---\n";
+        for (const MatchupEstimate& m : report.matchups) {
+            cout << "  vs " << left << setw(12) << m.opponent->getName() << right << fixed << setprecision(0)
+                << setw(4) << 100.0 * m.winRate() << "%  " << left << setw(11) << verdictLabel(m) << right
+                << "(" << m.battles() << " battles";
+            if (m.draws > 0) cout << ", " << m.draws << " drawn";
+            cout << ")\n";
+        }
+        cout << defaultfloat << setprecision(6);
+        cout << "Estimated in " << static_cast<int>(report.milliseconds) << " ms"
+            << (report.timedOut ? "; undecided matchups stopped at the time limit" : "") << ".\n";
+    }
+}
+
+void addBuiltinCharacters(CharacterRegistry& registry) {
+    registry.add(make_unique<OG>());
+    registry.add(make_unique<Helios>());
+    registry.add(make_unique<Duran>());
+    registry.add(make_unique<Philip>());
+    registry.add(make_unique<Razor>());
+    registry.add(make_unique<Sunny>());
+}
+
+unique_ptr<Character> parseCharacterLine(const string& line) {
+    SaveLine fields;
+    SaveLineStatus status = parseSaveLine(line, fields);
+    if (status == SaveLineStatus::CHARACTER) return makeCustomCharacter(fields);
+    if (status != SaveLineStatus::SKIPPED) cerr << saveLineStatusMessage(status) << ": " << line << endl;
+    return nullptr;
+}
+
+void writeCharacterLine(ostream& out, const Character& character) {
+    out << characterTypeName(character.getType()) << ";";
+    out << character.getName() << ";";
+    out << character.getMaxHp() << ";";
+    out << character.getRockDamage() << ";";
+    out << character.getPaperDamage() << ";";
+    out << character.getScissorsDamage();
+    for (const auto& p_data : character.getPassives()) { // Renamed loop var
+        out << ";" << p_data.toString();
+    }
+}
 
 void loadCharacters() {
+    MetricTimer timer(MetricHistogram::ROSTER_LOAD);
     availableCharacters.clear();
+    addBuiltinCharacters(availableCharacters);
+    savesToRoster = false;
+
+    // The binary roster wins over the text file; the game saves back to whichever it loaded
+    error_code ec;
+    if (filesystem::exists(ROSTER_FILE, ec)) {
+        shared_ptr<const RosterFile> roster = RosterFile::open(ROSTER_FILE);
+        if (roster) {
+            availableCharacters.attach(std::move(roster));
+            savesToRoster = true;
+            cout << "Mapped " << availableCharacters.idsOfType(CharacterType::CUSTOM).size()
+                << " custom characters from " << ROSTER_FILE << ". Total characters: " << availableCharacters.size() << endl;
+            replayJournal();
+            return;
+        }
+        cerr << "Falling back to " << SAVE_FILE << endl;
+    }
 
-    availableCharacters.push_back(make_unique<OG>());
-    availableCharacters.push_back(make_unique<Helios>());
-    availableCharacters.push_back(make_unique<Duran>());
-    availableCharacters.push_back(make_unique<Philip>());
-    availableCharacters.push_back(make_unique<Razor>());
-    availableCharacters.push_back(make_unique<Sunny>());
-
-    ifstream infile(SAVE_FILE);
-    string line;
+    auto start = chrono::steady_clock::now();
+    CharacterImport imported = importCharacterFile(SAVE_FILE);
 
-    if (!infile) {
+    if (!imported.opened) {
         cout << "No custom character file found (" << SAVE_FILE << "). Starting with built-in characters.\n";
         ofstream outfile(SAVE_FILE);
         if (outfile) { // Add header to new file
-            outfile << "# Format: TYPE;NAME;HP;ROCK;PAPER;SCISSORS;PASSIVE1_STR;PASSIVE2_STR;..." << endl;
-            outfile << "# Passive Str: TRIGGER_ID,EFFECT_ID,VALUE,THRESHOLD" << endl;
+            outfile << K_TEXT_HEADER;
         }
         outfile.close();
+        replayJournal();
         return;
     }
 
-    while (getline(infile, line)) {
-        if (line.empty() || line[0] == '#') continue;
-
-        stringstream ss(line);
-        string segment;
-        vector<string> parts;
-
-        while (getline(ss, segment, ';')) {
-            parts.push_back(segment);
-        }
-
-        if (parts.size() >= 6 && parts[0] == "CUSTOM") {
-            try {
-                string name = parts[1];
-                int hp = stoi(parts[2]);
-                int rock = stoi(parts[3]);
-                int paper = stoi(parts[4]);
-                int scissors = stoi(parts[5]);
-                vector<Passive> passives_data; // Renamed to avoid conflict with Character member
-
-                for (size_t i = 6; i < parts.size(); ++i) {
-                    if (!parts[i].empty()) {
-                        passives_data.push_back(Passive::fromString(parts[i]));
-                    }
-                }
-                availableCharacters.push_back(make_unique<Character>(name, hp, rock, paper, scissors, std::move(passives_data), "CUSTOM"));
-                cout << "Loaded custom character: " << name << endl;
-            }
-            catch (const std::invalid_argument& e) {
-                cerr << "Error parsing line (invalid number): " << line << " Why: " << e.what() << endl;
-            }
-            catch (const std::out_of_range& e) {
-                cerr << "Error parsing line (number out of range): " << line << " Why: " << e.what() << endl;
-            }
-            catch (...) {
-                cerr << "Unknown error parsing line: " << line << endl;
-            }
-        }
-        else if (parts[0] != "BUILTIN") {
-            cerr << "Skipping malformed line or non-custom character entry: " << line << endl;
+    reportImportErrors(imported);
+    availableCharacters.reserve(imported.characters.size());
+    size_t added = 0;
+    for (auto& loaded : imported.characters) {
+        string name = loaded->getName();
+        if (availableCharacters.add(std::move(loaded)) == INVALID_CHARACTER_ID) {
+            cerr << "Skipping duplicate character name: " << name << endl;
+            continue;
         }
+        ++added;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (added > 0) {
+        cout << "Loaded " << added << " custom characters from " << SAVE_FILE << " in "
+            << static_cast<int>(seconds * 1000) << " ms" << endl;
     }
     cout << "Finished loading characters. Total characters: " << availableCharacters.size() << endl;
-    infile.close();
+    replayJournal();
 }
 
 void saveCharacters() {
-    ofstream outfile(SAVE_FILE);
-    if (!outfile) {
-        cerr << "Error: Could not open " << SAVE_FILE << " for writing!" << endl;
-        return;
-    }
+    MetricTimer timer(MetricHistogram::ROSTER_SAVE);
+    // A full save holds every journaled edit, so both logs can go once it is written
+    journal.finishCompaction();
+    bool saved = savesToRoster ? saveRoster() : snapshotCustoms()();
+    if (!saved) return;
+    journal.clear();
+    cout << "Custom characters saved to " << (savesToRoster ? ROSTER_FILE : SAVE_FILE) << endl;
+}
 
-    outfile << "# Format: TYPE;NAME;HP;ROCK;PAPER;SCISSORS;PASSIVE1_STR;PASSIVE2_STR;..." << endl;
-    outfile << "# Passive Str: TRIGGER_ID,EFFECT_ID,VALUE,THRESHOLD" << endl;
-
-    for (const auto& characterPtr : availableCharacters) {
-        if (characterPtr->getType() == "CUSTOM") {
-            outfile << characterPtr->getType() << ";";
-            outfile << characterPtr->getName() << ";";
-            outfile << characterPtr->getMaxHp() << ";";
-            outfile << characterPtr->getRockDamage() << ";";
-            outfile << characterPtr->getPaperDamage() << ";";
-            outfile << characterPtr->getScissorsDamage();
-            for (const auto& p_data : characterPtr->getPassives()) { // Renamed loop var
-                outfile << ";" << p_data.toString();
-            }
-            outfile << endl;
+bool convertTextToRoster(const string& textPath, const string& rosterPath) {
+    CharacterImport imported = importCharacterFile(textPath);
+    if (!imported.opened) {
+        cerr << "Error: Could not open " << textPath << endl;
+        return false;
+    }
+    reportImportErrors(imported);
+
+    // Same rules as loadCharacters: built-in names and repeats are skipped
+    CharacterRegistry builtins;
+    addBuiltinCharacters(builtins);
+    RosterWriter writer;
+    for (const auto& loaded : imported.characters) {
+        if (builtins.contains(loaded->getName()) || !writer.add(*loaded)) {
+            cerr << "Skipping duplicate character name: " << loaded->getName() << endl;
         }
     }
+    if (!writer.write(rosterPath)) return false;
+    cout << "Wrote " << writer.size() << " characters to " << rosterPath << endl;
+    return true;
+}
+
+bool convertRosterToText(const string& rosterPath, const string& textPath) {
+    shared_ptr<const RosterFile> roster = RosterFile::open(rosterPath);
+    if (!roster) return false;
+
+    ofstream outfile(textPath);
+    if (!outfile) {
+        cerr << "Error: Could not open " << textPath << " for writing!" << endl;
+        return false;
+    }
+    outfile << K_TEXT_HEADER;
+    for (uint32_t i = 0; i < roster->size(); ++i) {
+        writeCharacterLine(outfile, *roster->load(i));
+        outfile << '\n';
+    }
     outfile.close();
-    cout << "Custom characters saved to " << SAVE_FILE << endl;
+    if (!outfile) {
+        cerr << "Error: failed while writing " << textPath << endl;
+        return false;
+    }
+    cout << "Wrote " << roster->size() << " characters to " << textPath << endl;
+    return true;
 }
 
 void displayPassiveOptions() {
@@ -145,19 +341,12 @@ void displayPassiveOptions() {
 }
 
 void createNewCharacter() {
-    system("cls"); 
+    TerminalRenderer::clearScreen();
     cout << "=== Create New Character ===\n\n";
 
     string name = getStringInput("Enter character name: ");
 
-    bool nameExists = false;
-    for (const auto& ch : availableCharacters) {
-        if (ch->getName() == name) {
-            nameExists = true;
-            break;
-        }
-    }
-    if (nameExists) {
+    if (availableCharacters.contains(name)) {
         cout << "Error: A character with this name already exists.\n";
         cout << "Press Enter to return to the menu...";
         cin.ignore(numeric_limits<streamsize>::max(), '\n'); 
@@ -165,15 +354,16 @@ void createNewCharacter() {
         return;
     }
 
-    int hp = getIntInput("Enter Max HP (1-100): ", 1, 100);
-    int rock = getIntInput("Enter Rock Damage (0-10): ", 0, 10);
-    int paper = getIntInput("Enter Paper Damage (0-10): ", 0, 10);
-    int scissors = getIntInput("Enter Scissors Damage (0-10): ", 0, 10);
+    const string damageRange = " (0-" + to_string(CUSTOM_MAX_MOVE_DAMAGE) + "): ";
+    int hp = getIntInput("Enter Max HP (1-" + to_string(CUSTOM_MAX_HP) + "): ", 1, CUSTOM_MAX_HP);
+    int rock = getIntInput("Enter Rock Damage" + damageRange, 0, CUSTOM_MAX_MOVE_DAMAGE);
+    int paper = getIntInput("Enter Paper Damage" + damageRange, 0, CUSTOM_MAX_MOVE_DAMAGE);
+    int scissors = getIntInput("Enter Scissors Damage" + damageRange, 0, CUSTOM_MAX_MOVE_DAMAGE);
 
     vector<Passive> passives_data; 
-    cout << "\n--- Add Passives (up to 3, enter 0 for trigger to skip) ---" << endl;
+    cout << "\n--- Add Passives (up to " << CUSTOM_MAX_PASSIVES << ", enter 0 for trigger to skip) ---" << endl;
 
-    for (int i = 0; i < 3; ++i) {
+    for (int i = 0; i < CUSTOM_MAX_PASSIVES; ++i) {
         cout << "\n-- Passive " << (i + 1) << " --\n";
         displayPassiveOptions();
 
@@ -193,20 +383,20 @@ void createNewCharacter() {
         int threshold = 0;
 
         if (effect == PassiveEffect::HEAL_SELF_PERCENT_CURRENT || effect == PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT) {
-            value = getIntInput("Enter Percentage Value (1-100): ", 1, 100);
+            value = getIntInput("Enter Percentage Value (1-" + to_string(CUSTOM_MAX_PERCENT_VALUE) + "): ", 1, CUSTOM_MAX_PERCENT_VALUE);
         }
         else {
-            value = getIntInput("Enter Flat Value (1-50): ", 1, 50);
+            value = getIntInput("Enter Flat Value (1-" + to_string(CUSTOM_MAX_FLAT_VALUE) + "): ", 1, CUSTOM_MAX_FLAT_VALUE);
         }
 
         if (trigger == PassiveTrigger::ON_HP_BELOW_PERCENT) {
-            threshold = getIntInput("Enter HP Threshold Percentage (1-99): ", 1, 99);
+            threshold = getIntInput("Enter HP Threshold Percentage (1-" + to_string(CUSTOM_MAX_HP_THRESHOLD) + "): ", 1, CUSTOM_MAX_HP_THRESHOLD);
         }
 
         passives_data.emplace_back(trigger, effect, value, threshold);
         cout << "Added Passive: " << passives_data.back().getDescription() << endl;
 
-        if (i < 2) {
+        if (i < CUSTOM_MAX_PASSIVES - 1) {
             char addAnother = ' ';
             cout << "Add another passive? (y/n): ";
             cin >> addAnother;
@@ -217,22 +407,25 @@ void createNewCharacter() {
         }
     }
 
-    availableCharacters.push_back(make_unique<Character>(name, hp, rock, paper, scissors, std::move(passives_data), "CUSTOM"));
+    CharacterId createdId = availableCharacters.add(make_unique<Character>(name, hp, rock, paper, scissors, std::move(passives_data), CharacterType::CUSTOM));
     cout << "\nCharacter '" << name << "' created successfully!\n";
-    saveCharacters();
+    printBalanceEstimate(*availableCharacters[createdId]);
+    ostringstream line;
+    writeCharacterLine(line, *availableCharacters[createdId]);
+    journalEdit(JournalOp::CREATE, line.str());
     cout << "Press Enter to return to the menu...";
     cin.get();
 }
 
 void viewCharacters() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== Available Characters ===\n\n";
     if (availableCharacters.empty()) {
         cout << "No characters available. Load or create some first.\n";
     }
     else {
         for (size_t i = 0; i < availableCharacters.size(); ++i) {
-            cout << (i + 1) << ". [" << availableCharacters[i]->getType() << "] "
+            cout << (i + 1) << ". [" << characterTypeName(availableCharacters[i]->getType()) << "] "
                 << availableCharacters[i]->getFullDescription() << "\n" << endl;
         }
     }
@@ -241,17 +434,14 @@ void viewCharacters() {
 }
 
 void deleteCharacter() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== Delete Custom Character ===\n\n";
 
-    vector<size_t> customCharIndices;
+    const vector<CharacterId>& customCharIndices = availableCharacters.idsOfType(CharacterType::CUSTOM);
     cout << "Select a custom character to delete:\n";
     cout << "0. Cancel\n";
-    for (size_t i = 0; i < availableCharacters.size(); ++i) {
-        if (availableCharacters[i]->getType() == "CUSTOM") {
-            cout << (customCharIndices.size() + 1) << ". " << availableCharacters[i]->getName() << endl;
-            customCharIndices.push_back(i);
-        }
+    for (size_t i = 0; i < customCharIndices.size(); ++i) {
+        cout << (i + 1) << ". " << availableCharacters[customCharIndices[i]]->getName() << endl;
     }
 
     if (customCharIndices.empty()) {
@@ -267,11 +457,11 @@ void deleteCharacter() {
         cout << "Deletion cancelled.\n";
     }
     else {
-        size_t originalIndex = customCharIndices[choice - 1];
+        CharacterId originalIndex = customCharIndices[choice - 1];
         string deletedName = availableCharacters[originalIndex]->getName();
-        availableCharacters.erase(availableCharacters.begin() + originalIndex);
+        availableCharacters.remove(originalIndex);
         cout << "Character '" << deletedName << "' deleted.\n";
-        saveCharacters();
+        journalEdit(JournalOp::DELETE, deletedName);
     }
     cout << "Press Enter to return to the menu...";
     cin.get();
@@ -2,20 +2,43 @@
 #define CHARACTERMANAGER_H
 
 #include "Character.h"
+#include "CharacterRegistry.h"
 #include "PassiveSystem.h"
+#include <iosfwd>
 #include <string>
 #include <vector> // For std::vector
 #include <memory> // For std::unique_ptr
 
-// Global available characters list
-extern std::vector<std::unique_ptr<Character>> availableCharacters;
+// Global roster: built-ins first, then customs in file order
+extern CharacterRegistry availableCharacters;
 
-// Save file constant
+// Save file constants. ROSTER_FILE, the mapped binary roster, is used instead
+// of SAVE_FILE when it exists. Creates and deletes are appended to
+// JOURNAL_FILE and replayed on load; saveCharacters folds them in.
 extern const std::string SAVE_FILE;
+extern const std::string ROSTER_FILE;
+extern const std::string JOURNAL_FILE;
+
+// Limits createNewCharacter puts on a custom build
+const int CUSTOM_MAX_HP = 100;              // Min 1
+const int CUSTOM_MAX_MOVE_DAMAGE = 10;      // Min 0
+const int CUSTOM_MAX_PASSIVES = 3;
+const int CUSTOM_MAX_FLAT_VALUE = 50;       // Min 1
+const int CUSTOM_MAX_PERCENT_VALUE = 100;   // Min 1; the *_PERCENT_CURRENT effects
+const int CUSTOM_MAX_HP_THRESHOLD = 99;     // Min 1; ON_HP_BELOW_PERCENT
 
 // Function declarations
+void addBuiltinCharacters(CharacterRegistry& registry);
+// One SAVE_FILE line as a custom character; nullptr for comments, BUILTIN
+// lines and (with a message on cerr) anything malformed
+std::unique_ptr<Character> parseCharacterLine(const std::string& line);
+// The SAVE_FILE line for a character, without the newline
+void writeCharacterLine(std::ostream& out, const Character& character);
 void loadCharacters();
 void saveCharacters();
+// Converters between SAVE_FILE's text format and the binary roster
+bool convertTextToRoster(const std::string& textPath, const std::string& rosterPath);
+bool convertRosterToText(const std::string& rosterPath, const std::string& textPath);
 void displayPassiveOptions();
 void createNewCharacter();
 void viewCharacters();
@@ -0,0 +1,35 @@
+#include "CharacterPool.h"
+#include <typeinfo>
+#include <utility>
+
+using namespace std;
+
+Character& CharacterPool::acquire(const Character& prototype) {
+    // Prefer a free slot of the same type; assignment then keeps its buffers
+    size_t match = slots.size();
+    for (size_t i = used; i < slots.size(); ++i) {
+        if (typeid(*slots[i]) == typeid(prototype)) {
+            match = i;
+            break;
+        }
+    }
+
+    if (match == slots.size()) {
+        slots.push_back(prototype.clone());
+    }
+    else {
+        // Same dynamic type, and the built-in subclasses only differ in their
+        // constructor, so assigning the base part copies the whole fighter
+        *slots[match] = prototype;
+    }
+    swap(slots[used], slots[match]);
+
+    Character& instance = *slots[used++];
+    instance.resetStatsForNewBattle();
+    return instance;
+}
+
+CharacterPool& CharacterPool::local() {
+    thread_local CharacterPool pool;
+    return pool;
+}
@@ -0,0 +1,44 @@
+#ifndef CHARACTERPOOL_H
+#define CHARACTERPOOL_H
+
+#include "Character.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Reusable per-battle fighter instances. acquire() copy-assigns the prototype
+// into a free slot that last held the same dynamic type, so once the pool is
+// warm the name, passive and index vectors reuse their capacity and a new
+// battle instance costs a few small copies instead of heap allocations.
+// Slots are handed out stack-fashion: a Scope gives back everything acquired
+// since it was opened.
+class CharacterPool {
+public:
+    class Scope {
+    public:
+        explicit Scope(CharacterPool& pool) : pool(pool), mark(pool.used) {}
+        ~Scope() { pool.used = mark; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        CharacterPool& pool;
+        size_t mark;
+    };
+
+    // Fresh copy of prototype with full HP, valid until the enclosing Scope ends
+    Character& acquire(const Character& prototype);
+
+    size_t inUse() const { return used; }
+    size_t capacity() const { return slots.size(); }
+
+    // One pool per thread, for engines that run many battles back to back
+    static CharacterPool& local();
+
+private:
+    std::vector<std::unique_ptr<Character>> slots; // [0, used) are handed out
+    size_t used = 0;
+};
+
+#endif // CHARACTERPOOL_H
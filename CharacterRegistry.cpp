@@ -0,0 +1,147 @@
+#include "CharacterRegistry.h"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+CharacterId CharacterRegistry::add(Entry character) {
+    if (!character || contains(character->getName())) return INVALID_CHARACTER_ID;
+
+    CharacterId id = static_cast<CharacterId>(characters.size());
+    character->id = id;
+    byName.emplace(string_view(character->getName()), id);
+    (character->getType() == CharacterType::BUILTIN ? builtinIds : customIds).push_back(id);
+    characters.push_back(std::move(character));
+    ++changes;
+    return id;
+}
+
+void CharacterRegistry::remove(CharacterId id) {
+    if (id >= characters.size()) return;
+    if (characters[id]) {
+        // A loaded roster character is not in byName, and its name may not be either
+        auto it = byName.find(characters[id]->getName());
+        if (it != byName.end() && it->second == id) byName.erase(it);
+    }
+    if (isMapped(id)) {
+        uint32_t record = recordOf(id);
+        removedRecords.insert(upper_bound(removedRecords.begin(), removedRecords.end(), record), record);
+    }
+    else if (id < mappedFirst) {
+        --mappedFirst;
+    }
+    characters.erase(characters.begin() + id);
+    reindexFrom(id);
+    ++changes;
+}
+
+void CharacterRegistry::clear() {
+    byName.clear();
+    builtinIds.clear();
+    customIds.clear();
+    characters.clear();
+    roster.reset();
+    removedRecords.clear();
+    ++changes;
+}
+
+void CharacterRegistry::reserve(size_t additional) {
+    characters.reserve(characters.size() + additional);
+    byName.reserve(byName.size() + additional);
+}
+
+void CharacterRegistry::attach(shared_ptr<const RosterFile> file) {
+    if (!file || roster) return;
+    mappedFirst = static_cast<CharacterId>(characters.size());
+    characters.resize(characters.size() + file->size());
+    customIds.reserve(customIds.size() + file->size());
+    for (CharacterId id = mappedFirst; id < characters.size(); ++id) customIds.push_back(id);
+    roster = std::move(file);
+    ++changes;
+}
+
+bool CharacterRegistry::reattach(shared_ptr<const RosterFile> file) {
+    if (!file || file->size() != customIds.size()) return false;
+    CharacterId first = customIds.empty() ? static_cast<CharacterId>(characters.size()) : customIds.front();
+    if (first + file->size() != characters.size()) return false; // Customs are not one block at the end
+    mappedFirst = first;
+    roster = std::move(file);
+    removedRecords.clear();
+    return true;
+}
+
+void CharacterRegistry::writeCustoms(RosterWriter& out) const {
+    // Mapped IDs are one block in record order, so the holes can be skipped in a single walk
+    uint32_t record = 0;
+    size_t hole = 0;
+    for (CharacterId id : customIds) {
+        uint32_t source = RosterFile::NOT_FOUND;
+        if (isMapped(id)) {
+            while (hole < removedRecords.size() && removedRecords[hole] == record) { ++hole; ++record; }
+            source = record++;
+        }
+        if (characters[id]) out.add(*characters[id]);
+        else out.add(*roster, source);
+    }
+}
+
+uint32_t CharacterRegistry::recordOf(CharacterId id) const {
+    uint32_t record = id - mappedFirst;
+    for (uint32_t removed : removedRecords) {
+        if (removed > record) break;
+        ++record;
+    }
+    return record;
+}
+
+void CharacterRegistry::load(CharacterId id) const {
+    characters[id] = roster->load(recordOf(id));
+    characters[id]->id = id;
+}
+
+void CharacterRegistry::loadAll() const {
+    if (!roster) return;
+    uint32_t record = 0;
+    size_t hole = 0;
+    for (CharacterId id = mappedFirst; isMapped(id); ++id, ++record) {
+        while (hole < removedRecords.size() && removedRecords[hole] == record) { ++hole; ++record; }
+        if (!characters[id]) {
+            characters[id] = roster->load(record);
+            characters[id]->id = id;
+        }
+    }
+}
+
+Character* CharacterRegistry::find(string_view name) const {
+    CharacterId id = idOf(name);
+    return id == INVALID_CHARACTER_ID ? nullptr : (*this)[id].get();
+}
+
+CharacterId CharacterRegistry::idOf(string_view name) const {
+    auto it = byName.find(name);
+    if (it != byName.end()) return it->second;
+    if (roster) {
+        uint32_t record = roster->find(name);
+        if (record != RosterFile::NOT_FOUND) {
+            auto hole = lower_bound(removedRecords.begin(), removedRecords.end(), record);
+            if (hole != removedRecords.end() && *hole == record) return INVALID_CHARACTER_ID;
+            return mappedFirst + record - static_cast<CharacterId>(hole - removedRecords.begin());
+        }
+    }
+    return INVALID_CHARACTER_ID;
+}
+
+void CharacterRegistry::reindexFrom(CharacterId first) {
+    for (CharacterId id = first; id < characters.size(); ++id) {
+        if (!characters[id]) continue; // Still mapped; its ID is derived from the holes
+        characters[id]->id = id;
+        auto it = byName.find(characters[id]->getName());
+        if (it != byName.end()) it->second = id;
+    }
+    builtinIds.clear();
+    customIds.clear();
+    for (CharacterId id = 0; id < characters.size(); ++id) {
+        bool builtin = characters[id] && characters[id]->getType() == CharacterType::BUILTIN;
+        (builtin ? builtinIds : customIds).push_back(id);
+    }
+}
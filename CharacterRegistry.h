@@ -0,0 +1,90 @@
+#ifndef CHARACTERREGISTRY_H
+#define CHARACTERREGISTRY_H
+
+#include "Character.h"
+#include "RosterFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The roster: owns every loaded character in menu order. A character's ID
+// is its position, so IDs stay dense (0..size()-1); removing one shifts the
+// later IDs down. Names are interned in a hash index for O(1) lookup, and
+// built-ins and customs are kept as separate ID lists so callers that only
+// want one kind do not scan the rest.
+//
+// Customs can also come from a mapped RosterFile. Those are built on first
+// access, and their names are looked up in the file's own index, so attaching
+// a large roster costs about as much as reserving its slots. Removing a mapped
+// character only records its record index as a hole. Lazy loading
+// happens inside const accessors, so like the rest of the registry it is
+// single-threaded: resolve the characters before handing them to workers.
+class CharacterRegistry {
+public:
+    using Entry = std::unique_ptr<Character>;
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    // Takes ownership and returns the new ID, or INVALID_CHARACTER_ID if the name is taken
+    CharacterId add(Entry character);
+    void remove(CharacterId id);
+    void clear();
+    void reserve(size_t additional); // Room for that many more adds without rehashing
+
+    // Appends the roster's characters as customs. Names are trusted to be
+    // unique and distinct from the built-ins (RosterWriter guarantees the former).
+    void attach(std::shared_ptr<const RosterFile> roster);
+    // After saving: roster holds exactly the current customs, in order. Loaded
+    // characters stay as they are; the rest now come from the new file.
+    // false (nothing changed) if it does not line up with the customs.
+    bool reattach(std::shared_ptr<const RosterFile> roster);
+    const RosterFile* mappedRoster() const { return roster.get(); }
+    // Every custom, in order, without loading the ones still in the mapping
+    void writeCustoms(RosterWriter& out) const;
+
+    size_t size() const { return characters.size(); }
+    bool empty() const { return characters.empty(); }
+    // Goes up whenever characters are added or removed (reattach changes
+    // nothing), so a cache of something ID-dependent can tell it is stale
+    uint64_t generation() const { return changes; }
+    const Entry& operator[](CharacterId id) const {
+        if (!characters[id]) load(id);
+        return characters[id];
+    }
+    // Iterating visits everything, so it loads whatever is still mapped
+    const_iterator begin() const { loadAll(); return characters.begin(); }
+    const_iterator end() const { return characters.end(); }
+
+    Character* find(std::string_view name) const; // nullptr if unknown
+    CharacterId idOf(std::string_view name) const; // INVALID_CHARACTER_ID if unknown
+    bool contains(std::string_view name) const { return idOf(name) != INVALID_CHARACTER_ID; }
+
+    // IDs of one type, in roster order
+    const std::vector<CharacterId>& idsOfType(CharacterType type) const {
+        return type == CharacterType::BUILTIN ? builtinIds : customIds;
+    }
+
+private:
+    mutable std::vector<Entry> characters; // Null while still only in the mapped roster
+    // Keys view the characters' own name strings, which live as long as the entry.
+    // Mapped characters are found through the roster's index instead.
+    std::unordered_map<std::string_view, CharacterId> byName;
+    std::vector<CharacterId> builtinIds;
+    std::vector<CharacterId> customIds;
+    std::shared_ptr<const RosterFile> roster;
+    CharacterId mappedFirst = 0;          // ID of the first roster record still present
+    std::vector<uint32_t> removedRecords; // Sorted; records after a hole sit one ID lower
+    uint64_t changes = 0;
+
+    void reindexFrom(CharacterId first);
+    size_t mappedCount() const { return roster ? roster->size() - removedRecords.size() : 0; }
+    bool isMapped(CharacterId id) const { return id >= mappedFirst && id - mappedFirst < mappedCount(); }
+    uint32_t recordOf(CharacterId id) const;
+    void load(CharacterId id) const;
+    void loadAll() const;
+};
+
+#endif // CHARACTERREGISTRY_H
@@ -0,0 +1,78 @@
+#include "FileSync.h"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool syncFile(FILE* f) {
+    if (fflush(f) != 0) return false;
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+bool syncPath(const string& path) {
+#if defined(_WIN32)
+    int fd = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd < 0) return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+#endif
+    return ok;
+}
+
+bool syncParentDirectory(const string& path) {
+#if defined(_WIN32)
+    (void)path;
+    return true;
+#else
+    filesystem::path directory = filesystem::path(path).parent_path();
+    if (directory.empty()) directory = ".";
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0 || errno == EINVAL; // Some filesystems cannot sync a directory
+    close(fd);
+    return ok;
+#endif
+}
+
+bool replaceFileDurably(const string& tempFile, const string& path) {
+#if defined(_WIN32)
+    if (!MoveFileExA(tempFile.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        cerr << "Error: could not replace " << path << " (error " << GetLastError() << ")" << endl;
+        return false;
+    }
+#else
+    error_code ec;
+    filesystem::rename(tempFile, path, ec);
+    if (ec) {
+        cerr << "Error: could not replace " << path << ": " << ec.message() << endl;
+        return false;
+    }
+    if (!syncParentDirectory(path)) {
+        cerr << "Error: could not flush the directory of " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+#endif
+    return true;
+}
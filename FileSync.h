@@ -0,0 +1,23 @@
+#ifndef FILESYNC_H
+#define FILESYNC_H
+
+#include <cstdio>
+#include <string>
+
+// Durability for the save files. A new file may only be renamed over the old
+// one once its data is on disk, and anything that relies on the rename (such
+// as deleting the journal it replaces) must wait until the directory entry is
+// on disk too.
+
+// fflush, then fsync (_commit on Windows)
+bool syncFile(std::FILE* f);
+// The same for a file already written and closed
+bool syncPath(const std::string& path);
+// Flushes the directory holding path, so a create or rename in it survives a
+// crash. Windows needs nothing here: replaceFileDurably renames write-through.
+bool syncParentDirectory(const std::string& path);
+// Renames a written and synced tempFile over path and waits until the rename
+// is on disk; false with the reason on cerr
+bool replaceFileDurably(const std::string& tempFile, const std::string& path);
+
+#endif // FILESYNC_H
@@ -1,16 +1,18 @@
 #include "Game.h"
 #include "CharacterManager.h"
 #include "Utils.h"
+#include "TerminalRenderer.h"
 #include "AISystem.h" 
+#include "BattleEngine.h"
+#include "Metrics.h"
 #include <iostream>
-#include <cstdlib>
 #include <algorithm>
 #include <chrono> 
 #include <thread> 
 
 using namespace std; 
 
-Game::Game() : player(nullptr), bot(nullptr), debugMode(false), currentAIDifficulty(AIDifficulty::HARD) {}
+Game::Game(Rng sessionRng) : player(nullptr), bot(nullptr), debugMode(false), currentAIDifficulty(AIDifficulty::HARD), rng(sessionRng) {}
 
 Game::~Game() {}
 
@@ -26,6 +28,10 @@ AIDifficulty Game::getAIDifficulty() const {
     return currentAIDifficulty;
 }
 
+void Game::setReplayRecorder(ReplayWriter* writer) {
+    recorder = writer;
+}
+
 
 void Game::displayHealth() const {
     cout << "\n===== STATUS =====\n";
@@ -57,16 +63,6 @@ void Game::displayHealth() const {
     cout << "=================\n\n";
 }
 
-int Game::getRPSWinner(int playerMove, int botMove) const {
-    if (playerMove == botMove) return 0;
-    if ((playerMove == 1 && botMove == 3) ||
-        (playerMove == 2 && botMove == 1) ||
-        (playerMove == 3 && botMove == 2)) {
-        return 1;
-    }
-    return 2;
-}
-
 string Game::getMoveString(int move) const {
     switch (move) {
     case 1: return "Rock";
@@ -92,7 +88,7 @@ Character* Game::selectCharacter(const string& prompt) {
 }
 
 bool Game::initialize() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== PIC BATTLE ===\n\n";
 
     player = selectCharacter("Select your Fighter!");
@@ -121,7 +117,7 @@ bool Game::initialize() {
             bot = player;
         }
         else {
-            bot = potentialBots[rand() % potentialBots.size()];
+            bot = potentialBots[rng.nextInt(0, static_cast<int>(potentialBots.size()) - 1)];
         }
     }
     if (!bot) { // Final fallback if bot selection logic failed
@@ -143,7 +139,7 @@ bool Game::initialize() {
 }
 
 bool Game::initializeDebug() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== DEBUG MODE: PIC BATTLE ===\n\n";
 
     player = selectCharacter("Select Player's Fighter!");
@@ -164,25 +160,20 @@ bool Game::initializeDebug() {
 }
 
 void Game::playRound() {
-    system("cls");
+    TerminalRenderer::clearScreen();
 
     if (!player || !bot) {
         cout << "Error: Player or Bot not initialized for the round." << endl;
         return;
     }
 
-    player->resetTurnState();
-    bot->resetTurnState();
-
-    player->checkAndApplyPassives(PassiveTrigger::ON_TURN_START, *player, *bot);
-    if (bot->isDefeated() || player->isDefeated()) return;
-    bot->checkAndApplyPassives(PassiveTrigger::ON_TURN_START, *bot, *player);
-    if (player->isDefeated() || bot->isDefeated()) return;
-
-    player->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *player, *bot);
-    if (bot->isDefeated() || player->isDefeated()) return;
-    bot->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *bot, *player);
-    if (player->isDefeated() || bot->isDefeated()) return;
+    ++roundsPlayed;
+    bool over;
+    {
+        MetricTimer timer(MetricHistogram::ROUND_BEGIN, MetricTimer::SAMPLED);
+        over = BattleEngine::beginRound(*player, *bot, console);
+    }
+    if (over) return;
 
     displayHealth();
 
@@ -198,10 +189,10 @@ void Game::playRound() {
         cout << "1. " << bot->getMoveDescription(1) << "\n";
         cout << "2. " << bot->getMoveDescription(2) << "\n";
         cout << "3. " << bot->getMoveDescription(3) << "\n";
-        cout << "4. Let AI (" << (currentAIDifficulty == AIDifficulty::HARD ? "Hard" : "Easy") << ") choose for Bot\n";
+        cout << "4. Let AI (" << difficultyName(currentAIDifficulty) << ") choose for Bot\n";
         int choice = getIntInput("Enter Bot's choice (1-4): ", 1, 4);
         if (choice == 4) {
-            botMove = AISystem::chooseMove(*bot, *player, currentAIDifficulty);
+            botMove = AISystem::chooseMove(*bot, *player, currentAIDifficulty, rng);
             cout << "AI for " << bot->getName() << " chose: " << getMoveString(botMove) << endl;
             cout << "Press Enter to see result...";
             cin.get();
@@ -212,67 +203,35 @@ void Game::playRound() {
     }
     else {
         cout << "Bot (" << bot->getName() << ") is thinking..." << endl;
-        botMove = AISystem::chooseMove(*bot, *player, currentAIDifficulty);
+        botMove = AISystem::chooseMove(*bot, *player, currentAIDifficulty, rng);
     }
 
-    system("cls");
+    if (recorder) replay.addRound(playerMove, botMove);
+
+    TerminalRenderer::clearScreen();
     displayHealth();
 
     cout << "\nYou (" << player->getName() << ") chose: " << getMoveString(playerMove) << "\n";
     cout << "Bot (" << bot->getName() << ") chose: " << getMoveString(botMove) << "\n\n";
 
-    int winner = getRPSWinner(playerMove, botMove);
+    MetricTimer timer(MetricHistogram::ROUND_RESOLVE, MetricTimer::SAMPLED);
+    int winner = BattleEngine::getRPSWinner(playerMove, botMove);
 
     if (winner == 0) {
         cout << "It's a tie!\n";
-        player->checkAndApplyPassives(PassiveTrigger::ON_TIE, *player, *bot, 0, false);
-        if (bot->isDefeated() || player->isDefeated()) return;
-        bot->checkAndApplyPassives(PassiveTrigger::ON_TIE, *bot, *player, 0, false);
-        if (player->isDefeated() || bot->isDefeated()) return;
-
+        BattleEngine::resolveTie(*player, *bot, console);
     }
     else if (winner == 1) {
-        int damage = player->calculateDamage(playerMove);
-        cout << "You win this round! Bot (" << bot->getName() << ") takes " << damage << " damage.\n";
         int oldBotHp = bot->getCurrentHp();
-        bot->takeDamage(damage);
-
-        player->checkAndApplyPassives(static_cast<PassiveTrigger>(playerMove), *player, *bot, playerMove, true);
-        if (bot->isDefeated() || player->isDefeated()) return;
-        player->checkAndApplyPassives(PassiveTrigger::AFTER_ANY_ATTACK, *player, *bot);
-        if (bot->isDefeated() || player->isDefeated()) return;
-
-        bot->checkAndApplyPassives(static_cast<PassiveTrigger>(botMove + 3), *bot, *player, botMove, false);
-        if (player->isDefeated() || bot->isDefeated()) return;
-        bot->checkAndApplyPassives(PassiveTrigger::AFTER_TAKING_HIT, *bot, *player);
-        if (player->isDefeated() || bot->isDefeated()) return;
-
-        if (bot->getCurrentHp() != oldBotHp) {
-            bot->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *bot, *player);
-            if (player->isDefeated() || bot->isDefeated()) return;
-        }
-
+        int damage = BattleEngine::strike(*player, *bot, playerMove, console);
+        cout << "You win this round! Bot (" << bot->getName() << ") takes " << damage << " damage.\n";
+        BattleEngine::afterStrike(*player, *bot, playerMove, botMove, oldBotHp, console);
     }
     else {
-        int damage = bot->calculateDamage(botMove);
-        cout << "Bot wins this round! You (" << player->getName() << ") take " << damage << " damage.\n";
         int oldPlayerHp = player->getCurrentHp();
-        player->takeDamage(damage);
-
-        bot->checkAndApplyPassives(static_cast<PassiveTrigger>(botMove), *bot, *player, botMove, true);
-        if (player->isDefeated() || bot->isDefeated()) return;
-        bot->checkAndApplyPassives(PassiveTrigger::AFTER_ANY_ATTACK, *bot, *player);
-        if (player->isDefeated() || bot->isDefeated()) return;
-
-        player->checkAndApplyPassives(static_cast<PassiveTrigger>(playerMove + 3), *player, *bot, playerMove, false);
-        if (bot->isDefeated() || player->isDefeated()) return;
-        player->checkAndApplyPassives(PassiveTrigger::AFTER_TAKING_HIT, *player, *bot);
-        if (bot->isDefeated() || player->isDefeated()) return;
-
-        if (player->getCurrentHp() != oldPlayerHp) {
-            player->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *player, *bot);
-            if (bot->isDefeated() || player->isDefeated()) return;
-        }
+        int damage = BattleEngine::strike(*bot, *player, botMove, console);
+        cout << "Bot wins this round! You (" << player->getName() << ") take " << damage << " damage.\n";
+        BattleEngine::afterStrike(*bot, *player, botMove, playerMove, oldPlayerHp, console);
     }
 }
 
@@ -315,6 +274,14 @@ void Game::play() {
         return;
     }
 
+    // The menu fights on the roster entries, which keep buffs between battles,
+    // so the starting states go into the log
+    roundsPlayed = 0;
+    if (recorder) {
+        replay.recordStart(*player, *bot, player == bot, true);
+        replay.stream = recorder->nextStream();
+    }
+
     while (!isGameOver()) {
         playRound();
         if (isGameOver()) break;
@@ -322,7 +289,13 @@ void Game::play() {
         cin.get();
     }
 
-    system("cls");
+    Metrics::record(MetricHistogram::BATTLE_ROUNDS, static_cast<uint64_t>(roundsPlayed));
+    if (recorder) {
+        replay.result = BattleEngine::resultOf(*player, *bot, roundsPlayed);
+        recorder->write(replay);
+    }
+
+    TerminalRenderer::clearScreen();
     displayHealth(); // Show final health
     announceWinner();
 
@@ -3,6 +3,8 @@
 
 #include "Character.h"
 #include "AISystem.h"
+#include "Rng.h"
+#include "ReplayLog.h"
 #include <string>
 #include <vector>
 #include <cstdlib> 
@@ -13,19 +15,24 @@ private:
     Character* bot;
     bool debugMode;
     AIDifficulty currentAIDifficulty;
+    Rng rng;
+    ConsoleEventSink console; // Narrates passives during interactive rounds
+    ReplayWriter* recorder = nullptr;
+    ReplayBattle replay;      // The battle being recorded
+    int roundsPlayed = 0;
 
     void displayHealth() const;
-    int getRPSWinner(int playerMove, int botMove) const;
     std::string getMoveString(int move) const;
     Character* selectCharacter(const std::string& prompt);
 
 public:
-    Game();
+    explicit Game(Rng sessionRng = Rng::fromEntropy());
     ~Game();
 
     void setDebugMode(bool debug);
     void setAIDifficulty(AIDifficulty difficulty);
     AIDifficulty getAIDifficulty() const; 
+    void setReplayRecorder(ReplayWriter* writer); // nullptr stops recording
     bool initialize();
     bool initializeDebug();
     void playRound();
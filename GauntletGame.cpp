@@ -1,21 +1,26 @@
 #include "GauntletGame.h"
 #include "CharacterManager.h"
 #include "Utils.h"
+#include "TerminalRenderer.h"
 #include "AISystem.h" // For AI
+#include "BattleEngine.h"
+#include "Metrics.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
-#include <random>
-#include <cstdlib> // For system, rand, srand
 #include <vector>
 #include <memory> // For make_unique
 
 using namespace std; // OK in .cpp file
 
-GauntletGame::GauntletGame() : winsInCurrentRun(0) {
+GauntletGame::GauntletGame(Rng sessionRng) : winsInCurrentRun(0), rng(sessionRng) {
     loadGauntletUnlocks();
 }
 
+void GauntletGame::setReplayRecorder(ReplayWriter* writer) {
+    recorder = writer;
+}
+
 // Simplified clone logic inside selectPlayerForGauntlet and runBattle
 // Character* GauntletGame::cloneCharacter(const Character& prototype) { ... }
 
@@ -60,7 +65,7 @@ void GauntletGame::saveGauntletUnlocks() {
 }
 
 bool GauntletGame::selectPlayerForGauntlet() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== Gauntlet Mode - Select Your Fighter ===\n";
     if (unlockedGauntletCharacters.empty()) { // Should always have OG
         cout << "No characters unlocked for Gauntlet Mode. (This shouldn't happen, OG is default).\n";
@@ -75,17 +80,13 @@ bool GauntletGame::selectPlayerForGauntlet() {
     vector<string> validUnlockedNames; // To map choice back to name
 
     for (const string& unlockedName : unlockedGauntletCharacters) {
-        bool found = false;
-        for (const auto& masterChar : availableCharacters) {
-            if (masterChar->getName() == unlockedName) {
-                cout << (selectablePlayerPrototypes.size() + 1) << ". " << masterChar->getShortDescription() << endl;
-                selectablePlayerPrototypes.push_back(masterChar.get());
-                validUnlockedNames.push_back(unlockedName);
-                found = true;
-                break;
-            }
+        Character* masterChar = availableCharacters.find(unlockedName);
+        if (masterChar) {
+            cout << (selectablePlayerPrototypes.size() + 1) << ". " << masterChar->getShortDescription() << endl;
+            selectablePlayerPrototypes.push_back(masterChar);
+            validUnlockedNames.push_back(unlockedName);
         }
-        if (!found) {
+        else {
             cout << (selectablePlayerPrototypes.size() + 1) << ". " << unlockedName << " (Error: Data not found, cannot select)" << endl;
             // Don't add to selectablePlayerPrototypes or validUnlockedNames
         }
@@ -101,22 +102,10 @@ bool GauntletGame::selectPlayerForGauntlet() {
     int choice = getIntInput("Choose your character: ", 1, static_cast<int>(selectablePlayerPrototypes.size()));
     Character* chosenProto = selectablePlayerPrototypes[choice - 1]; // This is a raw pointer to an object in availableCharacters
 
-    // Clone the selected character for the gauntlet run
-    // This logic should be robust. If new built-ins are added, they need to be here.
-    if (chosenProto->getName() == "OG") playerCharacter = make_unique<OG>();
-    else if (chosenProto->getName() == "Helios") playerCharacter = make_unique<Helios>();
-    else if (chosenProto->getName() == "Duran") playerCharacter = make_unique<Duran>();
-    else if (chosenProto->getName() == "Philip") playerCharacter = make_unique<Philip>();
-    else if (chosenProto->getName() == "Razor") playerCharacter = make_unique<Razor>();
-    else if (chosenProto->getName() == "Sunny") playerCharacter = make_unique<Sunny>();
-    else { // For custom characters or other non-hardcoded built-ins
-        // This relies on Character's copy constructor.
-        // If chosenProto is a derived type not handled above, it will be sliced to Character.
-        // This is acceptable if custom characters are only of base Character type functionality.
-        playerCharacter = make_unique<Character>(*chosenProto);
-    }
-
-    playerCharacter->resetStatsForNewBattle(); // Full HP and reset bonus damage
+    // Clone the selected character for the gauntlet run, keeping its dynamic type.
+    // Menu battles leave permanent buffs on the roster entry; the run starts without them.
+    playerCharacter = chosenProto->clone();
+    playerCharacter->resetToDefinition();
 
     cout << "You chose: " << playerCharacter->getName() << endl;
     cout << "Press Enter to start the Gauntlet...";
@@ -125,58 +114,62 @@ bool GauntletGame::selectPlayerForGauntlet() {
     return true;
 }
 
-void GauntletGame::generateOpponentOrder(vector<Character*>& currentOpponentList) {
-    currentOpponentList.clear();
+const vector<string>& GauntletGame::unlockOrder() {
+    static const vector<string> order = { "OG", "Helios", "Duran", "Philip", "Razor", "Sunny" }; // Canonical order
+    return order;
+}
+
+vector<Character*> GauntletGame::opponentCandidates(CharacterId playerId, size_t wanted) {
     vector<Character*> potentialOpponents;
 
-    for (const auto& charPtr : availableCharacters) {
-        if (playerCharacter && charPtr->getName() != playerCharacter->getName() && charPtr->getType() == "BUILTIN") {
-            potentialOpponents.push_back(charPtr.get());
+    for (CharacterId id : availableCharacters.idsOfType(CharacterType::BUILTIN)) {
+        if (id != playerId) {
+            potentialOpponents.push_back(availableCharacters[id].get());
         }
     }
     // If not enough BUILTIN, consider adding CUSTOM (or allow repeats of BUILTIN)
-    if (potentialOpponents.size() < OPPONENTS_TO_BEAT) {
-        for (const auto& charPtr : availableCharacters) {
-            if (playerCharacter && charPtr->getName() != playerCharacter->getName() && charPtr->getType() == "CUSTOM") {
-                // Check if already added to avoid duplicates if a char is somehow both built-in and custom (should not happen)
-                if (find(potentialOpponents.begin(), potentialOpponents.end(), charPtr.get()) == potentialOpponents.end()) {
-                    potentialOpponents.push_back(charPtr.get());
-                }
+    if (potentialOpponents.size() < wanted) {
+        for (CharacterId id : availableCharacters.idsOfType(CharacterType::CUSTOM)) {
+            if (id != playerId) {
+                potentialOpponents.push_back(availableCharacters[id].get());
             }
         }
     }
 
-
     if (potentialOpponents.empty()) {
         // Fallback: if player is the only character or only one other type, use OG or first available non-player
         for (const auto& charPtr : availableCharacters) {
-            if (playerCharacter && charPtr->getName() != playerCharacter->getName()) {
+            if (charPtr->getId() != playerId) {
                 potentialOpponents.push_back(charPtr.get());
-                if (!potentialOpponents.empty()) break; // Take the first different one
+                break; // Take the first different one
             }
         }
         if (potentialOpponents.empty() && !availableCharacters.empty()) { // If still empty, player is the only char
             potentialOpponents.push_back(availableCharacters[0].get()); // Fight self (last resort)
-            cout << "Warning: Not enough distinct opponents. You might fight yourself or clones." << endl;
         }
     }
+    return potentialOpponents;
+}
 
+void GauntletGame::generateOpponentOrder(vector<Character*>& currentOpponentList) {
+    currentOpponentList.clear();
+    if (!playerCharacter) return;
+
+    CharacterId playerId = availableCharacters.idOf(playerCharacter->getName());
+    vector<Character*> potentialOpponents = opponentCandidates(playerId, OPPONENTS_TO_BEAT);
+
+    if (potentialOpponents.size() == 1 && potentialOpponents[0]->getId() == playerId) {
+        cout << "Warning: Not enough distinct opponents. You might fight yourself or clones." << endl;
+    }
     if (potentialOpponents.empty()) {
         cerr << "Error: No potential opponents found for the gauntlet! This should not happen." << endl;
         return;
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(potentialOpponents.begin(), potentialOpponents.end(), g);
+    rng.shuffle(potentialOpponents.begin(), potentialOpponents.end());
 
     for (int i = 0; i < OPPONENTS_TO_BEAT; ++i) {
-        if (!potentialOpponents.empty()) { // Ensure we always have someone to pick
-            currentOpponentList.push_back(potentialOpponents[i % potentialOpponents.size()]);
-        }
-        else {
-            cerr << "Error: Ran out of potential opponents during selection." << endl; break;
-        }
+        currentOpponentList.push_back(potentialOpponents[i % potentialOpponents.size()]);
     }
 }
 
@@ -198,49 +191,32 @@ string GauntletGame::getMoveString(int move) const {
     }
 }
 
-int GauntletGame::getRPSWinner(int playerMove, int botMove) const {
-    if (playerMove == botMove) return 0;
-    if ((playerMove == 1 && botMove == 3) ||
-        (playerMove == 2 && botMove == 1) ||
-        (playerMove == 3 && botMove == 2)) {
-        return 1;
-    }
-    return 2;
-}
-
 bool GauntletGame::runBattle(Character& activePlayer, Character& opponentProto) {
-    unique_ptr<Character> currentOpponent;
-    // Clone opponentProto to currentOpponent
-    if (opponentProto.getName() == "OG") currentOpponent = make_unique<OG>();
-    else if (opponentProto.getName() == "Helios") currentOpponent = make_unique<Helios>();
-    else if (opponentProto.getName() == "Duran") currentOpponent = make_unique<Duran>();
-    else if (opponentProto.getName() == "Philip") currentOpponent = make_unique<Philip>();
-    else if (opponentProto.getName() == "Razor") currentOpponent = make_unique<Razor>();
-    else if (opponentProto.getName() == "Sunny") currentOpponent = make_unique<Sunny>();
-    else {
-        currentOpponent = make_unique<Character>(opponentProto); // Copy constructor for customs
-    }
-    currentOpponent->resetStatsForNewBattle(); // Full HP
+    CharacterPool::Scope scope(battlePool);
+    Character& currentOpponent = battlePool.acquire(opponentProto);
+    currentOpponent.resetToDefinition(); // Without buffs from menu battles
 
-    cout << "\n--- Battle Start! Player vs " << currentOpponent->getName() << " ---" << endl;
+    cout << "\n--- Battle Start! Player vs " << currentOpponent.getName() << " ---" << endl;
     AIDifficulty gauntletAIDifficulty = AIDifficulty::HARD;
 
-    while (!activePlayer.isDefeated() && !currentOpponent->isDefeated()) {
-        system("cls");
-        activePlayer.resetTurnState();
-        currentOpponent->resetTurnState();
-
-        activePlayer.checkAndApplyPassives(PassiveTrigger::ON_TURN_START, activePlayer, *currentOpponent);
-        if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-        currentOpponent->checkAndApplyPassives(PassiveTrigger::ON_TURN_START, *currentOpponent, activePlayer);
-        if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
+    // The player carries HP and buffs over from the last battle
+    int rounds = 0;
+    if (recorder) {
+        replay.recordStart(activePlayer, currentOpponent, false, true);
+        replay.stream = recorder->nextStream();
+    }
 
-        activePlayer.checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, activePlayer, *currentOpponent);
-        if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-        currentOpponent->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *currentOpponent, activePlayer);
-        if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
+    while (!activePlayer.isDefeated() && !currentOpponent.isDefeated()) {
+        ++rounds;
+        TerminalRenderer::clearScreen();
+        bool over;
+        {
+            MetricTimer timer(MetricHistogram::ROUND_BEGIN, MetricTimer::SAMPLED);
+            over = BattleEngine::beginRound(activePlayer, currentOpponent, console);
+        }
+        if (over) break;
 
-        displayBattleStatus(activePlayer, *currentOpponent);
+        displayBattleStatus(activePlayer, currentOpponent);
 
         cout << "Your move, " << activePlayer.getName() << ":\n";
         cout << "1. " << activePlayer.getMoveDescription(1) << "\n";
@@ -248,88 +224,64 @@ bool GauntletGame::runBattle(Character& activePlayer, Character& opponentProto)
         cout << "3. " << activePlayer.getMoveDescription(3) << "\n";
         int playerMove = getIntInput("Enter choice (1-3): ", 1, 3);
 
-        cout << currentOpponent->getName() << " is thinking..." << endl;
-        int opponentMove = AISystem::chooseMove(*currentOpponent, activePlayer, gauntletAIDifficulty);
+        cout << currentOpponent.getName() << " is thinking..." << endl;
+        int opponentMove = AISystem::chooseMove(currentOpponent, activePlayer, gauntletAIDifficulty, rng);
+        if (recorder) replay.addRound(playerMove, opponentMove);
         // std::this_thread::sleep_for(std::chrono::milliseconds(300)); // Optional delay
 
-        system("cls");
-        displayBattleStatus(activePlayer, *currentOpponent);
+        TerminalRenderer::clearScreen();
+        displayBattleStatus(activePlayer, currentOpponent);
 
         cout << activePlayer.getName() << " chose: " << getMoveString(playerMove) << "\n";
-        cout << currentOpponent->getName() << " chose: " << getMoveString(opponentMove) << "\n\n";
+        cout << currentOpponent.getName() << " chose: " << getMoveString(opponentMove) << "\n\n";
 
-        int rpsWinner = getRPSWinner(playerMove, opponentMove);
+        {
+            MetricTimer timer(MetricHistogram::ROUND_RESOLVE, MetricTimer::SAMPLED);
+            int rpsWinner = BattleEngine::getRPSWinner(playerMove, opponentMove);
 
-        if (rpsWinner == 0) {
-            cout << "It's a tie!\n";
-            activePlayer.checkAndApplyPassives(PassiveTrigger::ON_TIE, activePlayer, *currentOpponent, 0, false);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-            currentOpponent->checkAndApplyPassives(PassiveTrigger::ON_TIE, *currentOpponent, activePlayer, 0, false);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-        }
-        else if (rpsWinner == 1) {
-            int damage = activePlayer.calculateDamage(playerMove);
-            cout << "You win the round! " << currentOpponent->getName() << " takes " << damage << " damage.\n";
-            int oldOpponentHp = currentOpponent->getCurrentHp();
-            currentOpponent->takeDamage(damage);
-
-            activePlayer.checkAndApplyPassives(static_cast<PassiveTrigger>(playerMove), activePlayer, *currentOpponent, playerMove, true);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-            activePlayer.checkAndApplyPassives(PassiveTrigger::AFTER_ANY_ATTACK, activePlayer, *currentOpponent);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-
-            currentOpponent->checkAndApplyPassives(static_cast<PassiveTrigger>(opponentMove + 3), *currentOpponent, activePlayer, opponentMove, false);
-            if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
-            currentOpponent->checkAndApplyPassives(PassiveTrigger::AFTER_TAKING_HIT, *currentOpponent, activePlayer);
-            if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
-
-            if (currentOpponent->getCurrentHp() != oldOpponentHp) {
-                currentOpponent->checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, *currentOpponent, activePlayer);
-                if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
+            if (rpsWinner == 0) {
+                cout << "It's a tie!\n";
+                over = BattleEngine::resolveTie(activePlayer, currentOpponent, console);
             }
-        }
-        else {
-            int damage = currentOpponent->calculateDamage(opponentMove);
-            cout << currentOpponent->getName() << " wins the round! You take " << damage << " damage.\n";
-            int oldPlayerHp = activePlayer.getCurrentHp();
-            activePlayer.takeDamage(damage);
-
-            currentOpponent->checkAndApplyPassives(static_cast<PassiveTrigger>(opponentMove), *currentOpponent, activePlayer, opponentMove, true);
-            if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
-            currentOpponent->checkAndApplyPassives(PassiveTrigger::AFTER_ANY_ATTACK, *currentOpponent, activePlayer);
-            if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
-
-            activePlayer.checkAndApplyPassives(static_cast<PassiveTrigger>(playerMove + 3), activePlayer, *currentOpponent, playerMove, false);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-            activePlayer.checkAndApplyPassives(PassiveTrigger::AFTER_TAKING_HIT, activePlayer, *currentOpponent);
-            if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
-
-            if (activePlayer.getCurrentHp() != oldPlayerHp) {
-                activePlayer.checkAndApplyPassives(PassiveTrigger::ON_HP_BELOW_PERCENT, activePlayer, *currentOpponent);
-                if (currentOpponent->isDefeated() || activePlayer.isDefeated()) break;
+            else if (rpsWinner == 1) {
+                int oldOpponentHp = currentOpponent.getCurrentHp();
+                int damage = BattleEngine::strike(activePlayer, currentOpponent, playerMove, console);
+                cout << "You win the round! " << currentOpponent.getName() << " takes " << damage << " damage.\n";
+                over = BattleEngine::afterStrike(activePlayer, currentOpponent, playerMove, opponentMove, oldOpponentHp, console);
+            }
+            else {
+                int oldPlayerHp = activePlayer.getCurrentHp();
+                int damage = BattleEngine::strike(currentOpponent, activePlayer, opponentMove, console);
+                cout << currentOpponent.getName() << " wins the round! You take " << damage << " damage.\n";
+                over = BattleEngine::afterStrike(currentOpponent, activePlayer, opponentMove, playerMove, oldPlayerHp, console);
             }
         }
-        if (activePlayer.isDefeated() || currentOpponent->isDefeated()) break;
+        if (over || activePlayer.isDefeated() || currentOpponent.isDefeated()) break;
         cout << "\nPress Enter for next turn...";
         // cin.ignore();
         cin.get();
     }
-    system("cls");
-    displayBattleStatus(activePlayer, *currentOpponent);
+    Metrics::record(MetricHistogram::BATTLE_ROUNDS, static_cast<uint64_t>(rounds));
+    if (recorder) {
+        replay.result = BattleEngine::resultOf(activePlayer, currentOpponent, rounds);
+        recorder->write(replay);
+    }
+    TerminalRenderer::clearScreen();
+    displayBattleStatus(activePlayer, currentOpponent);
 
     if (activePlayer.isDefeated()) {
-        cout << activePlayer.getName() << " has been defeated by " << currentOpponent->getName() << "!\n";
+        cout << activePlayer.getName() << " has been defeated by " << currentOpponent.getName() << "!\n";
         return false;
     }
     else {
-        cout << currentOpponent->getName() << " has been defeated!\n";
+        cout << currentOpponent.getName() << " has been defeated!\n";
         return true;
     }
 }
 
 
 void GauntletGame::attemptUnlockNextCharacter() {
-    vector<string> unlockOrder = { "OG", "Helios", "Duran", "Philip", "Razor", "Sunny" }; // Canonical order
+    const vector<string>& unlockOrder = GauntletGame::unlockOrder();
 
     string lastUnlockedCanonical = "OG"; // Default: OG is always first
     for (int i = unlockOrder.size() - 1; i >= 0; --i) {
@@ -357,13 +309,8 @@ void GauntletGame::attemptUnlockNextCharacter() {
 
 
     if (!nextCharToUnlock.empty()) {
-        bool isValidBuiltIn = false;
-        for (const auto& masterChar : availableCharacters) {
-            if (masterChar->getName() == nextCharToUnlock && masterChar->getType() == "BUILTIN") {
-                isValidBuiltIn = true;
-                break;
-            }
-        }
+        const Character* masterChar = availableCharacters.find(nextCharToUnlock);
+        bool isValidBuiltIn = masterChar && masterChar->getType() == CharacterType::BUILTIN;
 
         if (isValidBuiltIn) {
             unlockedGauntletCharacters.push_back(nextCharToUnlock);
@@ -383,7 +330,7 @@ void GauntletGame::attemptUnlockNextCharacter() {
 
 
 void GauntletGame::play() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "=== Welcome to the Gauntlet! ===\n";
     cout << "Defeat " << OPPONENTS_TO_BEAT << " consecutive opponents to win.\n";
     cout << "Only OG is available initially. Win to unlock more fighters!\n";
@@ -431,7 +378,7 @@ void GauntletGame::play() {
         winsInCurrentRun++;
         cout << "\nVictory in round " << (i + 1) << "! Your HP: " << playerCharacter->getCurrentHp() << "/" << playerCharacter->getMaxHp() << "\n";
         if (i < OPPONENTS_TO_BEAT - 1) {
-            int interRoundHeal = playerCharacter->getMaxHp() / 2;
+            int interRoundHeal = playerCharacter->getMaxHp() * INTER_ROUND_HEAL_PERCENT / 100;
             playerCharacter->heal(interRoundHeal);
             cout << "You recovered " << interRoundHeal << " HP between rounds. Current HP: " << playerCharacter->getCurrentHp() << "/" << playerCharacter->getMaxHp() << "\n";
             cout << "Press Enter for the next opponent...";
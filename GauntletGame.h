@@ -2,6 +2,9 @@
 #define GAUNTLETGAME_H
 
 #include "Character.h" 
+#include "CharacterPool.h"
+#include "Rng.h"
+#include "ReplayLog.h"
 #include <vector>
 #include <string>
 #include <memory> 
@@ -11,9 +14,13 @@ private:
     std::unique_ptr<Character> playerCharacter;
     std::vector<std::string> unlockedGauntletCharacters;
     int winsInCurrentRun;
+    Rng rng;
+    ConsoleEventSink console; // Narrates passives during interactive rounds
+    CharacterPool battlePool; // Opponent instances, reused from battle to battle
+    ReplayWriter* recorder = nullptr;
+    ReplayBattle replay;
 
     const std::string GAUNTLET_UNLOCKS_FILE = "gauntlet_unlocks.txt";
-    const int OPPONENTS_TO_BEAT = 5;
 
     void loadGauntletUnlocks();
     void saveGauntletUnlocks();
@@ -21,12 +28,21 @@ private:
     void generateOpponentOrder(std::vector<Character*>& currentOpponentList); // Pass by ref
     bool runBattle(Character& player, Character& opponentProto); // Changed to opponentProto
     std::string getMoveString(int move) const;
-    int getRPSWinner(int playerMove, int botMove) const;
     void displayBattleStatus(const Character& p1, const Character& p2) const;
     void attemptUnlockNextCharacter();
 
 public:
-    GauntletGame();
+    static const int OPPONENTS_TO_BEAT = 5;
+    static const int INTER_ROUND_HEAL_PERCENT = 50; // Of max HP, after every round but the last
+
+    // Built-ins in the order Gauntlet clears unlock them; OG starts unlocked
+    static const std::vector<std::string>& unlockOrder();
+    // Everyone the player may face, before shuffling: the other built-ins, plus
+    // the customs when there are too few of those. Never empty unless the roster is.
+    static std::vector<Character*> opponentCandidates(CharacterId playerId, size_t wanted);
+
+    explicit GauntletGame(Rng sessionRng = Rng::fromEntropy());
+    void setReplayRecorder(ReplayWriter* writer); // nullptr stops recording
     void play();
 };
 
@@ -0,0 +1,149 @@
+#include "GauntletSim.h"
+#include "CharacterManager.h"
+#include "CharacterPool.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+namespace {
+    // Roughly how many runs one stolen chunk of work should contain
+    const uint64_t K_RUNS_PER_GRAIN = 256;
+
+    // Counters one worker keeps per fighter, merged once every run is done.
+    // Integer sums, so the merge order cannot change the result.
+    struct FighterTally {
+        uint64_t runs = 0;
+        uint64_t clears = 0;
+        uint64_t battles = 0;
+        uint64_t battleRounds = 0;
+        vector<uint64_t> reached, deaths, stalls, hpInto, maxHpInto;
+
+        explicit FighterTally(size_t rounds)
+            : reached(rounds), deaths(rounds), stalls(rounds), hpInto(rounds), maxHpInto(rounds) {}
+    };
+
+    // order is scratch space, reused from run to run
+    void playRun(const Character& fighter, const vector<const Character*>& candidates, vector<const Character*>& order,
+        const GauntletOptions& options, Rng rng, FighterTally& tally) {
+        // Same draw as GauntletGame::generateOpponentOrder
+        order.assign(candidates.begin(), candidates.end());
+        rng.shuffle(order.begin(), order.end());
+
+        CharacterPool& pool = CharacterPool::local();
+        CharacterPool::Scope runScope(pool);
+        Character& player = pool.acquire(fighter);
+
+        ++tally.runs;
+        for (int round = 0; round < options.opponents; ++round) {
+            ++tally.reached[round];
+            tally.hpInto[round] += static_cast<uint64_t>(max(0, player.getCurrentHp()));
+            tally.maxHpInto[round] += static_cast<uint64_t>(max(0, player.getMaxHp()));
+
+            BattleResult result;
+            {
+                CharacterPool::Scope battleScope(pool);
+                Character& opponent = pool.acquire(*order[round % order.size()]);
+                result = BattleEngine::playBattle(player, opponent, options.playerPolicy, options.opponentPolicy,
+                    rng, options.maxRounds);
+            }
+            ++tally.battles;
+            tally.battleRounds += result.rounds;
+
+            // GauntletGame checks the player first, so a double K.O. is a loss
+            if (result.outcome != BattleOutcome::PLAYER_WINS) {
+                ++tally.deaths[round];
+                if (result.outcome == BattleOutcome::ROUND_LIMIT) ++tally.stalls[round];
+                return;
+            }
+            if (round < options.opponents - 1) {
+                player.heal(player.getMaxHp() * options.healPercent / 100);
+            }
+        }
+        ++tally.clears;
+    }
+}
+
+int GauntletFighterStats::deadliestRound() const {
+    int worst = -1;
+    for (size_t round = 0; round < deaths.size(); ++round) {
+        if (deaths[round] > 0 && (worst < 0 || deaths[round] > deaths[worst])) worst = static_cast<int>(round);
+    }
+    return worst;
+}
+
+GauntletReport simulateGauntlet(const vector<const Character*>& fighters, const GauntletOptions& options) {
+    GauntletReport report;
+    size_t rounds = static_cast<size_t>(max(0, options.opponents));
+    size_t n = fighters.size();
+
+    vector<vector<const Character*>> candidates(n);
+    for (size_t f = 0; f < n; ++f) {
+        GauntletFighterStats stats;
+        stats.name = fighters[f]->getName();
+        stats.reached.assign(rounds, 0);
+        stats.deaths.assign(rounds, 0);
+        stats.stalls.assign(rounds, 0);
+        stats.hpIntoRound.assign(rounds, 0);
+        stats.maxHpIntoRound.assign(rounds, 0);
+        report.fighters.push_back(std::move(stats));
+
+        CharacterId id = availableCharacters.idOf(fighters[f]->getName());
+        for (Character* c : GauntletGame::opponentCandidates(id, rounds)) candidates[f].push_back(c);
+    }
+    if (n == 0 || rounds == 0 || options.runs <= 0) return report;
+    for (const auto& list : candidates) {
+        if (list.empty()) return report; // Empty roster: nobody to fight
+    }
+
+    ThreadPool pool(options.threads);
+
+    // Work unit = one chunk of runs for one fighter, split so every core gets work
+    uint64_t runs = static_cast<uint64_t>(options.runs);
+    uint64_t wantedUnits = static_cast<uint64_t>(pool.size()) * 64;
+    uint64_t chunksPerFighter = n >= wantedUnits ? 1 : min<uint64_t>(runs, (wantedUnits + n - 1) / n);
+    uint64_t runsPerChunk = (runs + chunksPerFighter - 1) / chunksPerFighter;
+    uint64_t units = n * chunksPerFighter;
+    size_t grain = static_cast<size_t>(max<uint64_t>(1, K_RUNS_PER_GRAIN / runsPerChunk));
+
+    vector<vector<FighterTally>> tallies(pool.size(), vector<FighterTally>(n, FighterTally(rounds)));
+    // Run seeds depend only on (seed, fighter, run), never on which worker ran them
+    const Rng root(options.seed);
+
+    auto start = chrono::steady_clock::now();
+    pool.parallelFor(0, static_cast<size_t>(units), grain, [&](size_t first, size_t last, unsigned worker) {
+        vector<const Character*> order;
+        for (size_t unit = first; unit < last; ++unit) {
+            size_t f = static_cast<size_t>(unit / chunksPerFighter);
+            Rng fighterStream = root.fork(f);
+            uint64_t runBegin = (unit % chunksPerFighter) * runsPerChunk;
+            uint64_t runEnd = min(runs, runBegin + runsPerChunk);
+            for (uint64_t r = runBegin; r < runEnd; ++r) {
+                playRun(*fighters[f], candidates[f], order, options, fighterStream.fork(r), tallies[worker][f]);
+            }
+        }
+    });
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (const auto& workerTallies : tallies) {
+        for (size_t f = 0; f < n; ++f) {
+            const FighterTally& t = workerTallies[f];
+            GauntletFighterStats& stats = report.fighters[f];
+            stats.runs += t.runs;
+            stats.clears += t.clears;
+            stats.battleRounds += t.battleRounds;
+            for (size_t round = 0; round < rounds; ++round) {
+                stats.reached[round] += t.reached[round];
+                stats.deaths[round] += t.deaths[round];
+                stats.stalls[round] += t.stalls[round];
+                stats.hpIntoRound[round] += t.hpInto[round];
+                stats.maxHpIntoRound[round] += t.maxHpInto[round];
+            }
+            report.totalRuns += t.runs;
+            report.totalBattles += t.battles;
+        }
+    }
+    return report;
+}
@@ -0,0 +1,57 @@
+#ifndef GAUNTLETSIM_H
+#define GAUNTLETSIM_H
+
+#include "BattleEngine.h"
+#include "GauntletGame.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct GauntletOptions {
+    int runs = 10000;            // Full runs per fighter
+    uint64_t seed = 1;
+    unsigned threads = 0;        // 0 = all hardware threads
+    int opponents = GauntletGame::OPPONENTS_TO_BEAT;
+    int healPercent = GauntletGame::INTER_ROUND_HEAL_PERCENT;
+    MovePolicy playerPolicy = MovePolicy::ai(AIDifficulty::OPTIMAL);
+    MovePolicy opponentPolicy = MovePolicy::ai(AIDifficulty::HARD); // What GauntletGame uses
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS; // Per battle; hitting it ends the run
+};
+
+// Totals for one fighter; the vectors are indexed by Gauntlet round (0-based)
+struct GauntletFighterStats {
+    std::string name;
+    uint64_t runs = 0;
+    uint64_t clears = 0;
+    uint64_t battleRounds = 0;
+    std::vector<uint64_t> reached;       // Runs that started the round
+    std::vector<uint64_t> deaths;        // Runs that ended there: loss, double K.O. or round limit
+    std::vector<uint64_t> stalls;        // Of those, round limits
+    std::vector<uint64_t> hpIntoRound;   // Player HP at the start of the round, summed over runs
+    std::vector<uint64_t> maxHpIntoRound;
+
+    double clearRate() const { return runs ? static_cast<double>(clears) / runs : 0.0; }
+    double deathRate(size_t round) const { return reached[round] ? static_cast<double>(deaths[round]) / reached[round] : 0.0; }
+    double averageHpInto(size_t round) const { return reached[round] ? static_cast<double>(hpIntoRound[round]) / reached[round] : 0.0; }
+    double hpFractionInto(size_t round) const { return maxHpIntoRound[round] ? static_cast<double>(hpIntoRound[round]) / maxHpIntoRound[round] : 0.0; }
+    // Round where most runs end; -1 if none ended
+    int deadliestRound() const;
+};
+
+struct GauntletReport {
+    std::vector<GauntletFighterStats> fighters;
+    uint64_t totalRuns = 0;
+    uint64_t totalBattles = 0;
+    double seconds = 0.0;
+};
+
+// Plays options.runs complete Gauntlet runs for every fighter with both sides
+// under AI control, following GauntletGame's rules: the opponents are drawn the
+// way GauntletGame::opponentCandidates lists them, HP and buffs carry from
+// battle to battle, and the run ends at the first battle the player does not
+// win. Nothing is printed and gauntlet_unlocks.txt is never touched. Results
+// depend only on the seed, not on the thread count.
+GauntletReport simulateGauntlet(const std::vector<const Character*>& fighters, const GauntletOptions& options);
+
+#endif // GAUNTLETSIM_H
@@ -1,26 +1,30 @@
 #include "MainMenu.h"
 #include "CharacterManager.h"
 #include "Utils.h"
+#include "TerminalRenderer.h"
 #include "GauntletGame.h" 
 #include "AISystem.h"    
 #include <iostream>
-#include <cstdlib>
-#include <ctime>
 
 using namespace std; 
 
-MainMenu::MainMenu() : exitGame(false) {
-    srand(static_cast<unsigned int>(time(nullptr)));
+MainMenu::MainMenu(const string& replayPath)
+    : sessionSeed(Rng::entropySeed()), sessionRng(sessionSeed), game(sessionRng.split()), gauntletGame(sessionRng.split()), exitGame(false) {
     loadCharacters();
+    if (!replayPath.empty() && replayWriter.open(replayPath, true)) {
+        replayWriter.beginSession(sessionSeed, availableCharacters);
+        game.setReplayRecorder(&replayWriter);
+        gauntletGame.setReplayRecorder(&replayWriter);
+    }
 }
 
 void MainMenu::displayMenu() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "==================================\n";
     cout << "=           PIC BATTLE           =\n";
     cout << "==================================\n\n";
     cout << "1. Start Battle (AI: "
-        << (game.getAIDifficulty() == AIDifficulty::HARD ? "Hard" : "Easy") << ")\n";
+        << difficultyName(game.getAIDifficulty()) << ")\n";
     cout << "2. Debug Mode Battle\n";
     cout << "3. Gauntlet Mode (AI: Hard)\n";
     cout << "4. Character Creator\n";
@@ -30,7 +34,7 @@ void MainMenu::displayMenu() {
 }
 
 void MainMenu::displayCreatorMenu() {
-    system("cls");
+    TerminalRenderer::clearScreen();
     cout << "==================================\n";
     cout << "=       CHARACTER CREATOR        =\n";
     cout << "==================================\n\n";
@@ -75,13 +79,16 @@ void MainMenu::run() {
             runCreator();
             break;
         case 5: {
-            system("cls");
+            TerminalRenderer::clearScreen();
             cout << "--- Set AI Difficulty ---\n";
             cout << "1. Easy AI\n";
             cout << "2. Hard AI\n";
-            int diffChoice = getIntInput("Choose difficulty for regular battles: ", 1, 2);
-            game.setAIDifficulty(diffChoice == 1 ? AIDifficulty::EASY : AIDifficulty::HARD);
-            cout << "AI difficulty set to " << (game.getAIDifficulty() == AIDifficulty::HARD ? "Hard" : "Easy") << ".\n";
+            cout << "3. Optimal AI (mixes its moves so it cannot be exploited)\n";
+            cout << "4. Lookahead AI (plans several rounds ahead)\n";
+            int diffChoice = getIntInput("Choose difficulty for regular battles: ", 1, 4);
+            const AIDifficulty choices[] = { AIDifficulty::EASY, AIDifficulty::HARD, AIDifficulty::OPTIMAL, AIDifficulty::LOOKAHEAD };
+            game.setAIDifficulty(choices[diffChoice - 1]);
+            cout << "AI difficulty set to " << difficultyName(game.getAIDifficulty()) << ".\n";
             cout << "Press Enter to continue...";
             cin.get();
             break;
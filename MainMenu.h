@@ -5,13 +5,19 @@
 #include "CharacterManager.h"
 #include "GauntletGame.h"
 #include "AISystem.h" 
+#include "Rng.h"
+#include "ReplayLog.h"
 #include <cstdlib> 
-#include <ctime>   
+#include <cstdint>
+#include <string>
 
 class MainMenu {
 private:
+    uint64_t sessionSeed;
+    Rng sessionRng; // Declared before game and gauntletGame: they take streams split from it
     Game game;
     GauntletGame gauntletGame;
+    ReplayWriter replayWriter;
     bool exitGame;
 
     void displayMenu();
@@ -19,7 +25,8 @@ private:
     void runCreator();
 
 public:
-    MainMenu();
+    // With replayPath set, every battle played is appended to that replay log
+    explicit MainMenu(const std::string& replayPath = "");
     void run();
 };
 
@@ -0,0 +1,116 @@
+#include "MatchupMatrix.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+    // Roughly how many battles one stolen chunk of work should contain
+    const uint64_t K_BATTLES_PER_GRAIN = 4096;
+
+    // Per-worker counters, padded so neighbouring workers never share a cache line
+    struct alignas(64) WorkerTally {
+        uint64_t battles = 0;
+        uint64_t rounds = 0;
+    };
+
+    void flushCell(MatchupCell& shared, const MatchupCell& local) {
+        atomic_ref<uint32_t>(shared.wins).fetch_add(local.wins, memory_order_relaxed);
+        atomic_ref<uint32_t>(shared.losses).fetch_add(local.losses, memory_order_relaxed);
+        atomic_ref<uint32_t>(shared.draws).fetch_add(local.draws, memory_order_relaxed);
+        atomic_ref<uint64_t>(shared.totalRounds).fetch_add(local.totalRounds, memory_order_relaxed);
+    }
+}
+
+double MatchupMatrix::winRate(size_t row, size_t col) const {
+    const MatchupCell& c = at(row, col);
+    return c.battles() ? static_cast<double>(c.wins) / c.battles() : 0.0;
+}
+
+pair<double, double> MatchupMatrix::confidenceInterval(size_t row, size_t col, double z) const {
+    const MatchupCell& c = at(row, col);
+    return wilsonInterval(c.wins, c.battles(), z);
+}
+
+pair<double, double> wilsonInterval(uint64_t successes, uint64_t trials, double z) {
+    double n = static_cast<double>(trials);
+    if (trials == 0) return { 0.0, 1.0 };
+    double p = successes / n;
+    double z2 = z * z;
+    double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double margin = (z / (1 + z2 / n)) * sqrt(p * (1 - p) / n + z2 / (4 * n * n));
+    return { max(0.0, center - margin), min(1.0, center + margin) };
+}
+
+MatchupMatrix computeMatchupMatrix(const vector<const Character*>& roster, const MatchupOptions& options) {
+    MatchupMatrix matrix;
+    for (const Character* c : roster) {
+        matrix.names.push_back(c->getName());
+    }
+    size_t n = roster.size();
+    matrix.cells.assign(n * n, MatchupCell());
+    if (n == 0 || options.samples <= 0) return matrix;
+
+    ThreadPool pool(options.threads);
+
+    // Work unit = one chunk of samples for one ordered pair. Large rosters use a
+    // whole pair per unit; small ones split samples so every core gets work.
+    uint64_t pairs = static_cast<uint64_t>(n) * n;
+    uint64_t samples = static_cast<uint64_t>(options.samples);
+    uint64_t wantedUnits = static_cast<uint64_t>(pool.size()) * 64;
+    uint64_t chunksPerPair = pairs >= wantedUnits ? 1 : min<uint64_t>(samples, (wantedUnits + pairs - 1) / pairs);
+    uint64_t samplesPerChunk = (samples + chunksPerPair - 1) / chunksPerPair;
+    uint64_t units = pairs * chunksPerPair;
+    size_t grain = static_cast<size_t>(max<uint64_t>(1, K_BATTLES_PER_GRAIN / samplesPerChunk));
+
+    vector<WorkerTally> tallies(pool.size());
+    // Battle seeds depend only on (seed, pair, sample), never on which worker ran them
+    const Rng root(options.seed);
+
+    auto start = chrono::steady_clock::now();
+    pool.parallelFor(0, static_cast<size_t>(units), grain, [&](size_t first, size_t last, unsigned worker) {
+        WorkerTally& tally = tallies[worker];
+        MatchupCell local;
+        uint64_t localPair = first / chunksPerPair;
+        Rng pairStream = root.fork(localPair);
+
+        for (size_t unit = first; unit < last; ++unit) {
+            uint64_t pair = unit / chunksPerPair;
+            if (pair != localPair) {
+                flushCell(matrix.cells[localPair], local);
+                local = MatchupCell();
+                localPair = pair;
+                pairStream = root.fork(pair);
+            }
+            const Character& player = *roster[pair / n];
+            const Character& bot = *roster[pair % n];
+            uint64_t sampleBegin = (unit % chunksPerPair) * samplesPerChunk;
+            uint64_t sampleEnd = min(samples, sampleBegin + samplesPerChunk);
+
+            for (uint64_t s = sampleBegin; s < sampleEnd; ++s) {
+                BattleResult r = BattleEngine::runBattle(player, bot, options.policy, options.policy,
+                    pairStream.fork(s).next(), options.maxRounds);
+                switch (r.outcome) {
+                case BattleOutcome::PLAYER_WINS: ++local.wins; break;
+                case BattleOutcome::BOT_WINS: ++local.losses; break;
+                default: ++local.draws; break;
+                }
+                local.totalRounds += r.rounds;
+                tally.rounds += r.rounds;
+                ++tally.battles;
+            }
+        }
+        flushCell(matrix.cells[localPair], local);
+    });
+    matrix.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (const WorkerTally& t : tallies) {
+        matrix.totalBattles += t.battles;
+        matrix.totalRounds += t.rounds;
+    }
+    return matrix;
+}
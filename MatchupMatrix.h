@@ -0,0 +1,48 @@
+#ifndef MATCHUPMATRIX_H
+#define MATCHUPMATRIX_H
+
+#include "BattleEngine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Tallies for one (row player, column bot) pairing
+struct MatchupCell {
+    uint32_t wins = 0;
+    uint32_t losses = 0;
+    uint32_t draws = 0; // Double K.O. or round limit
+    uint64_t totalRounds = 0;
+
+    uint32_t battles() const { return wins + losses + draws; }
+};
+
+struct MatchupOptions {
+    int samples = 1000;          // Battles per ordered pair
+    uint64_t seed = 1;
+    unsigned threads = 0;        // 0 = all hardware threads
+    MovePolicy policy = MovePolicy::ai(AIDifficulty::HARD);
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS;
+};
+
+struct MatchupMatrix {
+    std::vector<std::string> names;
+    std::vector<MatchupCell> cells; // Row-major, names.size() squared
+    uint64_t totalBattles = 0;
+    uint64_t totalRounds = 0;
+    double seconds = 0.0;
+
+    size_t size() const { return names.size(); }
+    const MatchupCell& at(size_t row, size_t col) const { return cells[row * names.size() + col]; }
+    double winRate(size_t row, size_t col) const;
+    // 95% Wilson score interval for the row's win rate
+    std::pair<double, double> confidenceInterval(size_t row, size_t col, double z = 1.96) const;
+};
+
+// Wilson score interval for a success rate; (0, 1) when there are no trials
+std::pair<double, double> wilsonInterval(uint64_t successes, uint64_t trials, double z = 1.96);
+
+// Plays every ordered pair of the roster against each other options.samples times
+MatchupMatrix computeMatchupMatrix(const std::vector<const Character*>& roster, const MatchupOptions& options);
+
+#endif // MATCHUPMATRIX_H
@@ -0,0 +1,222 @@
+#include "MatchupSolver.h"
+#include "Rng.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    // Sweeps stop early once no probability moves by more than this
+    const double K_CONVERGED = 1e-15;
+    // Leftover below this after summing the outcomes is rounding
+    const double K_ROUNDING_SLACK = 1e-12;
+    // Longest script cycle tracked as part of the state
+    const uint64_t K_MAX_SCRIPT_CYCLE = 1 << 20;
+
+    // Edge targets below zero are terminal outcomes
+    const int32_t K_PLAYER_WINS = -1;
+    const int32_t K_BOT_WINS = -2;
+    const int32_t K_DOUBLE_KO = -3;
+
+    // A fighter pair at the start of a round, before turn-start passives.
+    // triggeredThisTurn flags are always clear there, so they are left out.
+    struct SolverKey {
+        Character::BattleState player;
+        Character::BattleState bot;
+        uint32_t phase = 0; // Round modulo the script cycle
+
+        bool operator==(const SolverKey&) const = default;
+    };
+
+    struct SolverKeyHash {
+        size_t operator()(const SolverKey& k) const {
+            const int fields[] = {
+                k.player.hp, k.player.bonus, k.player.rock, k.player.paper, k.player.scissors,
+                k.bot.hp, k.bot.bonus, k.bot.rock, k.bot.paper, k.bot.scissors, static_cast<int>(k.phase)
+            };
+            uint64_t h = 0x9E3779B97F4A7C15ULL;
+            for (int f : fields) {
+                h ^= static_cast<uint32_t>(f);
+                h *= 0xFF51AFD7ED558CCDULL;
+                h ^= h >> 32;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Edge {
+        double probability;
+        int32_t target; // State index, or one of the K_ outcomes
+    };
+
+    int32_t terminalOutcome(const Character& player, const Character& bot) {
+        if (player.isDefeated() && bot.isDefeated()) return K_DOUBLE_KO;
+        return bot.isDefeated() ? K_PLAYER_WINS : K_BOT_WINS;
+    }
+
+    uint64_t scriptCycle(const MovePolicy& playerPolicy, const MovePolicy& botPolicy) {
+        uint64_t cycle = 1;
+        for (const MovePolicy* policy : { &playerPolicy, &botPolicy }) {
+            if (policy->kind == MovePolicy::Kind::SCRIPTED && !policy->script.empty()) {
+                cycle = lcm(cycle, static_cast<uint64_t>(policy->script.size()));
+            }
+        }
+        return cycle;
+    }
+
+    MatchupSolution sampleMatchup(const Character& player, const Character& bot,
+        const MovePolicy& playerPolicy, const MovePolicy& botPolicy, const SolverOptions& options) {
+        MatchupSolution solution;
+        const Rng root(options.seed);
+        long long totalRounds = 0;
+        for (int i = 0; i < options.samples; ++i) {
+            BattleResult r = BattleEngine::runBattle(player, bot, playerPolicy, botPolicy, root.fork(i).next(), options.maxRounds);
+            totalRounds += r.rounds;
+            switch (r.outcome) {
+            case BattleOutcome::PLAYER_WINS: solution.playerWin += 1; break;
+            case BattleOutcome::BOT_WINS: solution.botWin += 1; break;
+            case BattleOutcome::DOUBLE_KO: solution.doubleKo += 1; break;
+            case BattleOutcome::ROUND_LIMIT: solution.roundLimit += 1; break;
+            }
+        }
+        double n = max(options.samples, 1);
+        solution.playerWin /= n;
+        solution.botWin /= n;
+        solution.doubleKo /= n;
+        solution.roundLimit /= n;
+        solution.expectedRounds = totalRounds / n;
+        return solution;
+    }
+}
+
+MatchupSolution solveMatchup(const Character& playerProto, const Character& botProto,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy, const SolverOptions& options) {
+    uint64_t cycle = scriptCycle(playerPolicy, botPolicy);
+    // captureBattleState keeps 32 trigger flags per fighter
+    if (playerProto.getPassives().size() > 32 || botProto.getPassives().size() > 32 || cycle > K_MAX_SCRIPT_CYCLE) {
+        return sampleMatchup(playerProto, botProto, playerPolicy, botPolicy, options);
+    }
+
+    Character player(playerProto);
+    Character bot(botProto);
+    player.resetStatsForNewBattle();
+    bot.resetStatsForNewBattle();
+
+    // Breadth-first over reachable round-start states; the map is the memo
+    unordered_map<SolverKey, int32_t, SolverKeyHash> index;
+    vector<SolverKey> states;
+    vector<size_t> edgeFirst;
+    vector<Edge> edges;
+
+    auto stateIndex = [&](const SolverKey& key) {
+        auto [it, inserted] = index.try_emplace(key, static_cast<int32_t>(states.size()));
+        if (inserted) states.push_back(key);
+        return it->second;
+    };
+
+    SolverKey start{ player.captureBattleState(), bot.captureBattleState(), 0 };
+    stateIndex(start);
+
+    for (size_t s = 0; s < states.size(); ++s) {
+        if (states.size() > options.maxStates) {
+            return sampleMatchup(playerProto, botProto, playerPolicy, botPolicy, options);
+        }
+        const SolverKey key = states[s];
+        edgeFirst.push_back(edges.size());
+
+        player.restoreBattleState(key.player);
+        bot.restoreBattleState(key.bot);
+        if (BattleEngine::beginRound(player, bot)) {
+            edges.push_back({ 1.0, terminalOutcome(player, bot) });
+            continue;
+        }
+
+        const Character::BattleState playerBegun = player.captureBattleState();
+        const Character::BattleState botBegun = bot.captureBattleState();
+        array<double, 3> playerMoves = playerPolicy.moveDistribution(player, bot, BattleSide::PLAYER, key.phase);
+        array<double, 3> botMoves = botPolicy.moveDistribution(bot, player, BattleSide::BOT, key.phase);
+        uint32_t nextPhase = static_cast<uint32_t>((key.phase + 1) % cycle);
+
+        size_t first = edges.size();
+        for (int pm = 1; pm <= 3; ++pm) {
+            for (int bm = 1; bm <= 3; ++bm) {
+                double probability = playerMoves[pm - 1] * botMoves[bm - 1];
+                if (probability <= 0.0) continue;
+
+                player.restoreBattleState(playerBegun);
+                bot.restoreBattleState(botBegun);
+                int32_t target;
+                if (BattleEngine::resolveMoves(player, bot, pm, bm)) {
+                    target = terminalOutcome(player, bot);
+                }
+                else {
+                    SolverKey next{ player.captureBattleState(), bot.captureBattleState(), nextPhase };
+                    next.player.triggered = 0;
+                    next.bot.triggered = 0;
+                    target = stateIndex(next);
+                }
+
+                // Merge move pairs that land in the same place
+                auto same = find_if(edges.begin() + first, edges.end(), [&](const Edge& e) { return e.target == target; });
+                if (same != edges.end()) same->probability += probability;
+                else edges.push_back({ probability, target });
+            }
+        }
+    }
+    edgeFirst.push_back(edges.size());
+
+    // Finite-horizon value iteration: after k sweeps each array holds the
+    // chance of that outcome within k rounds, and the expected rounds played
+    // when the battle is cut off at k
+    size_t n = states.size();
+    vector<double> win(n, 0.0), loss(n, 0.0), ko(n, 0.0), length(n, 0.0);
+    vector<double> nextWin(n), nextLoss(n), nextKo(n), nextLength(n);
+
+    MatchupSolution solution;
+    solution.exact = true;
+    solution.states = n;
+    for (int sweep = 1; sweep <= options.maxRounds; ++sweep) {
+        double change = 0.0;
+        bool lengthSettled = true;
+        for (size_t s = 0; s < n; ++s) {
+            double w = 0.0, l = 0.0, k = 0.0, len = 1.0;
+            for (size_t e = edgeFirst[s]; e < edgeFirst[s + 1]; ++e) {
+                const Edge& edge = edges[e];
+                switch (edge.target) {
+                case K_PLAYER_WINS: w += edge.probability; break;
+                case K_BOT_WINS: l += edge.probability; break;
+                case K_DOUBLE_KO: k += edge.probability; break;
+                default:
+                    w += edge.probability * win[edge.target];
+                    l += edge.probability * loss[edge.target];
+                    k += edge.probability * ko[edge.target];
+                    len += edge.probability * length[edge.target];
+                    break;
+                }
+            }
+            change = max({ change, w - win[s], l - loss[s], k - ko[s] });
+            if (len - length[s] > K_CONVERGED * len) lengthSettled = false;
+            nextWin[s] = w;
+            nextLoss[s] = l;
+            nextKo[s] = k;
+            nextLength[s] = len;
+        }
+        win.swap(nextWin);
+        loss.swap(nextLoss);
+        ko.swap(nextKo);
+        length.swap(nextLength);
+        solution.sweeps = sweep;
+        // Later sweeps would add nothing, so this already equals the full horizon
+        if (change <= K_CONVERGED && lengthSettled) break;
+    }
+
+    solution.playerWin = win[0];
+    solution.botWin = loss[0];
+    solution.doubleKo = ko[0];
+    solution.roundLimit = 1.0 - win[0] - loss[0] - ko[0];
+    if (solution.roundLimit < K_ROUNDING_SLACK) solution.roundLimit = 0.0; // Summation error, not surviving battles
+    solution.expectedRounds = length[0];
+    return solution;
+}
@@ -0,0 +1,40 @@
+#ifndef MATCHUPSOLVER_H
+#define MATCHUPSOLVER_H
+
+#include "BattleEngine.h"
+#include <cstddef>
+#include <cstdint>
+
+struct SolverOptions {
+    size_t maxStates = 200000;   // Larger chains fall back to sampling
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS;
+    int samples = 100000;        // Battles played by the sampling fallback
+    uint64_t seed = 1;           // Fallback only; battle i uses stream i like "sim"
+};
+
+// Outcome probabilities for the player side of one matchup
+struct MatchupSolution {
+    double playerWin = 0.0;
+    double botWin = 0.0;
+    double doubleKo = 0.0;
+    double roundLimit = 0.0;
+    double expectedRounds = 0.0;
+    bool exact = false;          // False when the sampling fallback was used
+    size_t states = 0;           // Round-start states reached (exact only)
+    int sweeps = 0;              // Value-iteration passes until nothing changed
+
+    double draw() const { return doubleKo + roundLimit; }
+};
+
+// A battle with fixed move policies is a Markov chain over the fighters'
+// HP, bonus damage and base damage (passives can raise those) plus the
+// script position. This explores every state reachable from the start,
+// then runs value iteration over the round horizon, so round-limit draws
+// come out exactly as BattleEngine::runBattle would score them. AI sides
+// use AISystem::moveDistribution, so the answer is the limit of "sim" with
+// infinitely many battles.
+MatchupSolution solveMatchup(const Character& player, const Character& bot,
+    const MovePolicy& playerPolicy, const MovePolicy& botPolicy,
+    const SolverOptions& options = {});
+
+#endif // MATCHUPSOLVER_H
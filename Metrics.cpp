@@ -0,0 +1,267 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    // How a histogram is exported: picbattle_<name>{<label>="<value>"}
+    struct HistogramInfo {
+        const char* name;
+        const char* help;
+        const char* labelKey;   // nullptr = unlabelled
+        const char* labelValue;
+        bool isTime;            // Recorded in ticks, exported in seconds
+        bool sampled;           // Timed for one event in Metrics::SAMPLE_EVERY
+    };
+
+    const HistogramInfo K_HISTOGRAMS[METRIC_HISTOGRAM_COUNT] = {
+        { "ai_decision_seconds", "Time AISystem::chooseMove takes", "difficulty", "easy", true, true },
+        { "ai_decision_seconds", "Time AISystem::chooseMove takes", "difficulty", "hard", true, true },
+        { "ai_decision_seconds", "Time AISystem::chooseMove takes", "difficulty", "optimal", true, true },
+        { "ai_decision_seconds", "Time AISystem::chooseMove takes", "difficulty", "lookahead", true, true },
+        { "round_phase_seconds", "Time per phase of a battle round (choose: headless battles only)", "phase", "begin", true, true },
+        { "round_phase_seconds", "Time per phase of a battle round (choose: headless battles only)", "phase", "choose", true, true },
+        { "round_phase_seconds", "Time per phase of a battle round (choose: headless battles only)", "phase", "resolve", true, true },
+        { "battle_rounds", "Rounds per battle", nullptr, nullptr, false, false },
+        { "roster_io_seconds", "Time to load, save or journal the roster", "op", "load", true, false },
+        { "roster_io_seconds", "Time to load, save or journal the roster", "op", "save", true, false },
+        { "roster_io_seconds", "Time to load, save or journal the roster", "op", "journal_append", true, false }
+    };
+
+    const double K_QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+    const char* const K_QUANTILE_KEYS[] = { "p50", "p90", "p99", "p999" };
+
+    // Shortest stretch the tick rate is measured over
+    const chrono::milliseconds K_MIN_CALIBRATION(20);
+
+    // Plain copy of the metrics of every thread, summed
+    struct Snapshot {
+        struct Histogram {
+            vector<uint64_t> buckets = vector<uint64_t>(MetricHistogramData::BUCKET_COUNT);
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            uint64_t max = 0;
+        };
+        vector<Histogram> histograms = vector<Histogram>(METRIC_HISTOGRAM_COUNT);
+        vector<uint64_t> passiveTriggers = vector<uint64_t>(PASSIVE_TRIGGER_COUNT);
+        vector<uint64_t> passiveEffects = vector<uint64_t>(PASSIVE_EFFECT_COUNT);
+        double secondsPerTick = 1e-9;
+
+        void add(const ThreadMetrics& m) {
+            for (int h = 0; h < METRIC_HISTOGRAM_COUNT; ++h) {
+                const MetricHistogramData& from = m.histograms[h];
+                Histogram& to = histograms[h];
+                for (int b = 0; b < MetricHistogramData::BUCKET_COUNT; ++b) to.buckets[b] += from.buckets[b].load(memory_order_relaxed);
+                to.count += from.count.load(memory_order_relaxed);
+                to.sum += from.sum.load(memory_order_relaxed);
+                to.max = std::max(to.max, from.max.load(memory_order_relaxed));
+            }
+            for (int t = 0; t < PASSIVE_TRIGGER_COUNT; ++t) passiveTriggers[t] += m.passiveTriggers[t].load(memory_order_relaxed);
+            for (int e = 0; e < PASSIVE_EFFECT_COUNT; ++e) passiveEffects[e] += m.passiveEffects[e].load(memory_order_relaxed);
+        }
+    };
+
+    struct Registry {
+        mutex lock;
+        vector<ThreadMetrics*> live;
+        ThreadMetrics retired; // Exited threads, folded in
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    void fold(ThreadMetrics& into, const ThreadMetrics& from) {
+        for (int h = 0; h < METRIC_HISTOGRAM_COUNT; ++h) {
+            for (int b = 0; b < MetricHistogramData::BUCKET_COUNT; ++b) {
+                MetricHistogramData::bump(into.histograms[h].buckets[b], from.histograms[h].buckets[b].load(memory_order_relaxed));
+            }
+            MetricHistogramData::bump(into.histograms[h].count, from.histograms[h].count.load(memory_order_relaxed));
+            MetricHistogramData::bump(into.histograms[h].sum, from.histograms[h].sum.load(memory_order_relaxed));
+            uint64_t max = from.histograms[h].max.load(memory_order_relaxed);
+            if (max > into.histograms[h].max.load(memory_order_relaxed)) into.histograms[h].max.store(max, memory_order_relaxed);
+        }
+        for (int t = 0; t < PASSIVE_TRIGGER_COUNT; ++t) MetricHistogramData::bump(into.passiveTriggers[t], from.passiveTriggers[t].load(memory_order_relaxed));
+        for (int e = 0; e < PASSIVE_EFFECT_COUNT; ++e) MetricHistogramData::bump(into.passiveEffects[e], from.passiveEffects[e].load(memory_order_relaxed));
+    }
+
+    // Owns a thread's metrics and hands them to the registry when the thread exits
+    struct Registration {
+        unique_ptr<ThreadMetrics> metrics = make_unique<ThreadMetrics>();
+
+        Registration() {
+            Registry& r = registry();
+            lock_guard<mutex> guard(r.lock);
+            r.live.push_back(metrics.get());
+        }
+        ~Registration() {
+            Registry& r = registry();
+            lock_guard<mutex> guard(r.lock);
+            fold(r.retired, *metrics);
+            r.live.erase(find(r.live.begin(), r.live.end(), metrics.get()));
+        }
+    };
+
+    // Reference points for converting ticks to seconds, taken at start-up
+    const chrono::steady_clock::time_point K_START_TIME = chrono::steady_clock::now();
+    const uint64_t K_START_TICKS = Metrics::ticks();
+
+    double secondsPerTick() {
+#if defined(METRICS_HAS_TSC)
+        auto elapsed = chrono::steady_clock::now() - K_START_TIME;
+        if (elapsed < K_MIN_CALIBRATION) this_thread::sleep_for(K_MIN_CALIBRATION - elapsed);
+        uint64_t ticks = Metrics::ticks() - K_START_TICKS;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - K_START_TIME).count();
+        return ticks ? seconds / ticks : 0.0;
+#else
+        return 1e-9;
+#endif
+    }
+
+    Snapshot collect() {
+        Snapshot snapshot;
+        Registry& r = registry();
+        {
+            lock_guard<mutex> guard(r.lock);
+            snapshot.add(r.retired);
+            for (const ThreadMetrics* m : r.live) snapshot.add(*m);
+        }
+        snapshot.secondsPerTick = secondsPerTick();
+        return snapshot;
+    }
+
+    // Middle of the bucket holding the q-th value, never past the true maximum
+    uint64_t quantile(const Snapshot::Histogram& h, double q) {
+        if (h.count == 0) return 0;
+        uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(q * h.count + 0.5));
+        uint64_t seen = 0;
+        for (int b = 0; b < MetricHistogramData::BUCKET_COUNT; ++b) {
+            seen += h.buckets[b];
+            if (seen >= rank) {
+                uint64_t low = MetricHistogramData::bucketLow(b);
+                uint64_t mid = low + (MetricHistogramData::bucketHigh(b) - low) / 2;
+                return min(mid, h.max);
+            }
+        }
+        return h.max;
+    }
+
+    double scaled(uint64_t value, const HistogramInfo& info, const Snapshot& s) {
+        return info.isTime ? value * s.secondsPerTick : static_cast<double>(value);
+    }
+
+    string labels(const HistogramInfo& info, const string& extra = "") {
+        string text;
+        if (info.labelKey) text = string(info.labelKey) + "=\"" + info.labelValue + "\"";
+        if (!extra.empty()) text += (text.empty() ? "" : ",") + extra;
+        return text.empty() ? "" : "{" + text + "}";
+    }
+
+    void writeCounters(ostream& out, const char* name, const char* help, const char* labelKey,
+        const vector<uint64_t>& values, const char* (*key)(int)) {
+        out << "# HELP picbattle_" << name << " " << help << "\n";
+        out << "# TYPE picbattle_" << name << " counter\n";
+        for (size_t i = 0; i < values.size(); ++i) {
+            out << "picbattle_" << name << "{" << labelKey << "=\"" << key(static_cast<int>(i)) << "\"} " << values[i] << "\n";
+        }
+    }
+
+    const char* triggerKey(int i) { return passiveTriggerKey(static_cast<PassiveTrigger>(i)); }
+    const char* effectKey(int i) { return passiveEffectKey(static_cast<PassiveEffect>(i)); }
+}
+
+uint64_t MetricHistogramData::bucketLow(int bucket) {
+    if (bucket < SUB_COUNT) return static_cast<uint64_t>(bucket);
+    int exponent = bucket / SUB_COUNT + SUB_BITS - 1;
+    return static_cast<uint64_t>(SUB_COUNT + bucket % SUB_COUNT) << (exponent - SUB_BITS);
+}
+
+uint64_t MetricHistogramData::bucketHigh(int bucket) {
+    if (bucket < SUB_COUNT) return static_cast<uint64_t>(bucket);
+    int exponent = bucket / SUB_COUNT + SUB_BITS - 1;
+    return bucketLow(bucket) + ((uint64_t(1) << (exponent - SUB_BITS)) - 1);
+}
+
+ThreadMetrics& Metrics::registerThread() {
+    thread_local Registration registration;
+    return *registration.metrics;
+}
+
+void Metrics::writeJson(ostream& out) {
+    Snapshot s = collect();
+    out << "{\n";
+    out << "  \"enabled\": " << (ENABLED ? "true" : "false") << ",\n";
+    out << "  \"passive_triggers\": {";
+    for (int t = 0; t < PASSIVE_TRIGGER_COUNT; ++t) {
+        out << (t ? ", " : "") << "\"" << triggerKey(t) << "\": " << s.passiveTriggers[t];
+    }
+    out << "},\n";
+    out << "  \"passive_effects\": {";
+    for (int e = 0; e < PASSIVE_EFFECT_COUNT; ++e) {
+        out << (e ? ", " : "") << "\"" << effectKey(e) << "\": " << s.passiveEffects[e];
+    }
+    out << "},\n";
+    out << "  \"histograms\": [\n";
+    for (int h = 0; h < METRIC_HISTOGRAM_COUNT; ++h) {
+        const HistogramInfo& info = K_HISTOGRAMS[h];
+        const Snapshot::Histogram& data = s.histograms[h];
+        out << "    {\"name\": \"" << info.name << "\"";
+        if (info.labelKey) out << ", \"" << info.labelKey << "\": \"" << info.labelValue << "\"";
+        out << ", \"sampled_one_in\": " << (info.sampled ? Metrics::SAMPLE_EVERY : 1);
+        out << ", \"count\": " << data.count << ", \"sum\": " << scaled(data.sum, info, s)
+            << ", \"mean\": " << (data.count ? scaled(data.sum, info, s) / data.count : 0.0)
+            << ", \"max\": " << scaled(data.max, info, s);
+        for (size_t q = 0; q < size(K_QUANTILES); ++q) {
+            out << ", \"" << K_QUANTILE_KEYS[q] << "\": " << scaled(quantile(data, K_QUANTILES[q]), info, s);
+        }
+        out << "}" << (h + 1 < METRIC_HISTOGRAM_COUNT ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void Metrics::writePrometheus(ostream& out) {
+    Snapshot s = collect();
+    writeCounters(out, "passive_triggers_total", "Passives fired, by trigger", "trigger", s.passiveTriggers, triggerKey);
+    writeCounters(out, "passive_effects_total", "Passives fired, by effect", "effect", s.passiveEffects, effectKey);
+
+    for (int h = 0; h < METRIC_HISTOGRAM_COUNT; ++h) {
+        const HistogramInfo& info = K_HISTOGRAMS[h];
+        const Snapshot::Histogram& data = s.histograms[h];
+        string name = string("picbattle_") + info.name;
+        // Rows sharing a name are consecutive, so the header goes before the first
+        if (h == 0 || string(K_HISTOGRAMS[h - 1].name) != info.name) {
+            out << "# HELP " << name << " " << info.help;
+            if (info.sampled) out << " (1 event in " << Metrics::SAMPLE_EVERY << " sampled)";
+            out << "\n";
+            out << "# TYPE " << name << " summary\n";
+        }
+        for (double q : K_QUANTILES) {
+            ostringstream quantileLabel;
+            quantileLabel << "quantile=\"" << q << "\"";
+            out << name << labels(info, quantileLabel.str()) << " " << scaled(quantile(data, q), info, s) << "\n";
+        }
+        out << name << "_sum" << labels(info) << " " << scaled(data.sum, info, s) << "\n";
+        out << name << "_count" << labels(info) << " " << data.count << "\n";
+    }
+}
+
+bool Metrics::writeFile(const string& path) {
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error: Could not open " << path << " for writing!" << endl;
+        return false;
+    }
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (json) writeJson(out);
+    else writePrometheus(out);
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,176 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "PassiveSystem.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define METRICS_HAS_TSC 1
+#endif
+
+// Build with PICBATTLE_METRICS=1 to record hot-path metrics. Left at 0, every
+// hook below is an empty inline function and compiles to nothing. The Debug
+// and ReleaseMetrics configurations define it; measure with ReleaseMetrics,
+// since Debug timings say little about an optimized build.
+#ifndef PICBATTLE_METRICS
+#define PICBATTLE_METRICS 0
+#endif
+
+enum class MetricHistogram {
+    AI_DECISION_EASY,      // AISystem::chooseMove, by difficulty
+    AI_DECISION_HARD,
+    AI_DECISION_OPTIMAL,
+    AI_DECISION_LOOKAHEAD,
+    ROUND_BEGIN,           // Round phases, in every battle loop: headless, menu, Gauntlet and server
+    ROUND_CHOOSE,          // Headless only; elsewhere the round waits on the player here
+    ROUND_RESOLVE,
+    BATTLE_ROUNDS,         // Rounds per battle, from the same loops; a count, not a time
+    ROSTER_LOAD,           // CharacterManager
+    ROSTER_SAVE,
+    JOURNAL_APPEND,
+    COUNT
+};
+
+const int METRIC_HISTOGRAM_COUNT = static_cast<int>(MetricHistogram::COUNT);
+
+// Log-linear (HDR-style) histogram: 16 sub-buckets per power of two, so any
+// recorded value is known to within 1/16 of itself. Buckets are written only
+// by the owning thread, with relaxed loads and stores (plain moves on x86),
+// and read by the exporter.
+struct MetricHistogramData {
+    static const int SUB_BITS = 4;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint64_t> max{ 0 };
+
+    static int bucketOf(uint64_t value) {
+        if (value < SUB_COUNT) return static_cast<int>(value);
+        int exponent = static_cast<int>(std::bit_width(value)) - 1;
+        return (exponent - SUB_BITS + 1) * SUB_COUNT + static_cast<int>((value >> (exponent - SUB_BITS)) & (SUB_COUNT - 1));
+    }
+    static uint64_t bucketLow(int bucket);  // Smallest value in the bucket
+    static uint64_t bucketHigh(int bucket); // Largest value in the bucket
+
+    void record(uint64_t value) {
+        bump(buckets[bucketOf(value)], 1);
+        bump(count, 1);
+        bump(sum, value);
+        if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+    }
+
+    static void bump(std::atomic<uint64_t>& cell, uint64_t by) {
+        cell.store(cell.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+};
+
+// One thread's metrics. Threads register on first use and fold their numbers
+// into a shared total when they exit, so nothing is lost with the thread.
+struct ThreadMetrics {
+    std::array<MetricHistogramData, METRIC_HISTOGRAM_COUNT> histograms;
+    std::array<std::atomic<uint64_t>, PASSIVE_TRIGGER_COUNT> passiveTriggers{};
+    std::array<std::atomic<uint64_t>, PASSIVE_EFFECT_COUNT> passiveEffects{};
+};
+
+namespace Metrics {
+    constexpr bool ENABLED = PICBATTLE_METRICS != 0;
+
+    ThreadMetrics& registerThread(); // Slow path of local()
+
+    inline ThreadMetrics& local() {
+        thread_local ThreadMetrics* current = nullptr;
+        if (!current) current = &registerThread();
+        return *current;
+    }
+
+    // Timestamp in clock ticks: the TSC where there is one, else steady_clock nanoseconds
+    inline uint64_t ticks() {
+#if defined(METRICS_HAS_TSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Hot-path timers read the clock for one event in SAMPLE_EVERY: a clock
+    // read costs more than all the rest of the bookkeeping put together
+    const uint32_t SAMPLE_EVERY = 16;
+
+    inline bool sampleNext() {
+        thread_local uint32_t countdown = 0;
+        if (countdown) {
+            --countdown;
+            return false;
+        }
+        countdown = SAMPLE_EVERY - 1;
+        return true;
+    }
+
+    // Latency histograms take ticks; BATTLE_ROUNDS takes a plain count
+    inline void record(MetricHistogram histogram, uint64_t value) {
+        if constexpr (ENABLED) local().histograms[static_cast<int>(histogram)].record(value);
+    }
+
+    inline void countPassive(PassiveTrigger trigger, PassiveEffect effect) {
+        if constexpr (ENABLED) {
+            ThreadMetrics& m = local();
+            unsigned t = static_cast<unsigned>(trigger);
+            unsigned e = static_cast<unsigned>(effect);
+            if (t < PASSIVE_TRIGGER_COUNT) MetricHistogramData::bump(m.passiveTriggers[t], 1);
+            if (e < PASSIVE_EFFECT_COUNT) MetricHistogramData::bump(m.passiveEffects[e], 1);
+        }
+    }
+
+    // Sums every thread, live or exited, and writes the result. The JSON
+    // gives count, sum, mean, max and percentiles per histogram; the
+    // Prometheus text exposes the same as summaries. Times are in seconds.
+    void writeJson(std::ostream& out);
+    void writePrometheus(std::ostream& out);
+    // .json gets JSON, anything else Prometheus text; false if it could not be written
+    bool writeFile(const std::string& path);
+}
+
+// Records the ticks between construction and destruction into a histogram.
+// SAMPLED timers only time one event in Metrics::SAMPLE_EVERY.
+class MetricTimer {
+public:
+    enum Sampling { EVERY_EVENT, SAMPLED };
+
+    explicit MetricTimer(MetricHistogram histogram, Sampling sampling = EVERY_EVENT) : histogram(histogram) {
+        if constexpr (Metrics::ENABLED) {
+            active = sampling == EVERY_EVENT || Metrics::sampleNext();
+            if (active) start = Metrics::ticks();
+        }
+    }
+    ~MetricTimer() {
+        if constexpr (Metrics::ENABLED) {
+            if (active) Metrics::record(histogram, Metrics::ticks() - start);
+        }
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram histogram;
+    bool active = false;
+    uint64_t start = 0;
+};
+
+#endif // METRICS_H
@@ -39,6 +39,24 @@ std::string Passive::getDescription() const {
     return triggerDesc + ": " + effectDesc + ".";
 }
 
+const char* passiveTriggerKey(PassiveTrigger trigger) {
+    static const char* const keys[PASSIVE_TRIGGER_COUNT] = {
+        "none", "on_win_rock", "on_win_paper", "on_win_scissors", "on_lose_rock", "on_lose_paper",
+        "on_lose_scissors", "on_tie", "on_hp_below_percent", "on_turn_start", "after_any_attack", "after_taking_hit"
+    };
+    int index = static_cast<int>(trigger);
+    return (index >= 0 && index < PASSIVE_TRIGGER_COUNT) ? keys[index] : "unknown";
+}
+
+const char* passiveEffectKey(PassiveEffect effect) {
+    static const char* const keys[PASSIVE_EFFECT_COUNT] = {
+        "none", "heal_self_flat", "damage_opponent_flat", "increase_next_attack_flat", "increase_rock_dmg_perm",
+        "increase_paper_dmg_perm", "increase_scissors_dmg_perm", "heal_self_percent_current", "damage_opponent_percent_current"
+    };
+    int index = static_cast<int>(effect);
+    return (index >= 0 && index < PASSIVE_EFFECT_COUNT) ? keys[index] : "unknown";
+}
+
 std::string Passive::toString() const {
     std::stringstream ss;
     ss << static_cast<int>(trigger) << ","
@@ -21,6 +21,8 @@ enum class PassiveTrigger {
     AFTER_TAKING_HIT
 };
 
+const int PASSIVE_TRIGGER_COUNT = static_cast<int>(PassiveTrigger::AFTER_TAKING_HIT) + 1;
+
 // Define effects of passives
 enum class PassiveEffect {
     NONE,
@@ -34,6 +36,13 @@ enum class PassiveEffect {
     DAMAGE_OPPONENT_PERCENT_CURRENT
 };
 
+const int PASSIVE_EFFECT_COUNT = static_cast<int>(PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT) + 1;
+
+// Stable lowercase keys ("on_win_rock", "heal_self_flat") for metrics and
+// benchmark names; "unknown" for values outside the enum
+const char* passiveTriggerKey(PassiveTrigger trigger);
+const char* passiveEffectKey(PassiveEffect effect);
+
 // Structure to hold passive details
 struct Passive {
     PassiveTrigger trigger = PassiveTrigger::NONE;
@@ -41,6 +50,7 @@ struct Passive {
     int value = 0;
     int threshold = 0;
     bool triggeredThisTurn = false;
+    int hpCutoff = 0; // ON_HP_BELOW_PERCENT only: highest HP still below threshold, filled in by Character
 
     Passive() = default;
 
@@ -0,0 +1,237 @@
+#include "ReplayCommand.h"
+#include "ReplayLog.h"
+#include "CharacterManager.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    void printReplayUsage() {
+        cout << "Usage: replay info|verify|show FILE [options]\n"
+            << "  info               Sessions, battles, outcomes and bytes per battle\n"
+            << "  verify             Re-run every battle and compare it with the recorded outcome\n"
+            << "  show               Print one battle round by round\n"
+            << "  --battle N         Battle to show, counted from 0 (default 0)\n"
+            << "  --threads T        Worker threads for verify, 0 = all cores (default 0)\n"
+            << "Record logs with \"sim ... --record FILE\", or \"--record FILE\" for the interactive game.\n";
+    }
+
+    // Battles decoded and verified at a time; bounds memory on large logs
+    const size_t K_VERIFY_CHUNK = 1 << 16;
+    const size_t K_VERIFY_GRAIN = 256;
+    // Mismatches printed in full before the rest are only counted
+    const int K_MAX_REPORTED = 10;
+
+    const char* outcomeName(BattleOutcome outcome) {
+        switch (outcome) {
+        case BattleOutcome::PLAYER_WINS: return "player wins";
+        case BattleOutcome::BOT_WINS: return "bot wins";
+        case BattleOutcome::DOUBLE_KO: return "double K.O.";
+        default: return "round limit";
+        }
+    }
+
+    bool sameResult(const BattleResult& a, const BattleResult& b) {
+        return a.outcome == b.outcome && a.rounds == b.rounds && a.playerHp == b.playerHp && a.botHp == b.botHp;
+    }
+
+    void printResult(const char* label, const BattleResult& r) {
+        cout << label << outcomeName(r.outcome) << " after " << r.rounds << " rounds, "
+            << r.playerHp << "/" << r.botHp << " HP\n";
+    }
+
+    bool knownFighters(const ReplayBattle& b) {
+        return b.playerId < availableCharacters.size() && b.botId < availableCharacters.size();
+    }
+
+    int printReplayInfo(ReplayReader& reader) {
+        ReplayBattle battle;
+        long long battles = 0, rounds = 0, recordedStates = 0;
+        long long outcomes[4] = { 0, 0, 0, 0 };
+        vector<uint64_t> fingerprints;
+        while (reader.next(battle)) {
+            ++battles;
+            rounds += battle.result.rounds;
+            ++outcomes[static_cast<int>(battle.result.outcome) & 3];
+            if (battle.hasPlayerStart || battle.hasBotStart) ++recordedStates;
+            if (find(fingerprints.begin(), fingerprints.end(), battle.fingerprint) == fingerprints.end()) {
+                fingerprints.push_back(battle.fingerprint);
+            }
+        }
+        if (!reader.error().empty()) cerr << "Warning: " << reader.error() << endl;
+
+        cout << "Sessions:     " << reader.sessions() << "\n"
+            << "Rosters:      " << fingerprints.size() << "\n"
+            << "Battles:      " << battles << " (" << recordedStates << " with recorded starting states)\n"
+            << "Rounds:       " << rounds << "\n"
+            << "Player wins:  " << outcomes[0] << "\n"
+            << "Bot wins:     " << outcomes[1] << "\n"
+            << "Double K.O.:  " << outcomes[2] << "\n"
+            << "Round limit:  " << outcomes[3] << "\n"
+            << "File size:    " << reader.fileSize() << " bytes";
+        if (battles > 0) cout << " (" << static_cast<double>(reader.fileSize()) / battles << " per battle)";
+        cout << endl;
+        return reader.error().empty() ? 0 : 1;
+    }
+
+    int verifyReplays(ReplayReader& reader, unsigned threads) {
+        loadCharacters();
+        const uint64_t fingerprint = rosterFingerprint(availableCharacters);
+        ThreadPool pool(threads);
+
+        vector<ReplayBattle> chunk(K_VERIFY_CHUNK);
+        vector<const Character*> players(K_VERIFY_CHUNK), bots(K_VERIFY_CHUNK);
+        vector<BattleResult> replayed(K_VERIFY_CHUNK);
+        long long battles = 0, rounds = 0, mismatches = 0, skipped = 0;
+
+        auto start = chrono::steady_clock::now();
+        while (true) {
+            size_t count = 0;
+            while (count < chunk.size() && reader.next(chunk[count])) ++count;
+            if (count == 0) break;
+
+            // The registry loads lazily and is single-threaded: resolve fighters here
+            for (size_t i = 0; i < count; ++i) {
+                const ReplayBattle& b = chunk[i];
+                bool usable = b.fingerprint == fingerprint && knownFighters(b);
+                players[i] = usable ? availableCharacters[b.playerId].get() : nullptr;
+                bots[i] = usable ? availableCharacters[b.botId].get() : nullptr;
+            }
+            pool.parallelFor(0, count, K_VERIFY_GRAIN, [&](size_t first, size_t last, unsigned) {
+                for (size_t i = first; i < last; ++i) {
+                    if (players[i]) replayed[i] = replayBattle(chunk[i], *players[i], *bots[i]);
+                }
+            });
+
+            for (size_t i = 0; i < count; ++i) {
+                long long index = battles + static_cast<long long>(i);
+                if (!players[i]) {
+                    if (skipped++ == 0) {
+                        cerr << "Battle " << index << " skipped: "
+                            << (knownFighters(chunk[i]) ? "recorded against a different roster" : "fighter IDs not in the roster") << endl;
+                    }
+                    continue;
+                }
+                rounds += replayed[i].rounds;
+                if (sameResult(replayed[i], chunk[i].result)) continue;
+                if (mismatches++ < K_MAX_REPORTED) {
+                    cout << "Mismatch in battle " << index << " (seed " << chunk[i].seed << ", stream " << chunk[i].stream
+                        << "): " << players[i]->getName() << " vs " << bots[i]->getName() << "\n";
+                    printResult("  recorded: ", chunk[i].result);
+                    printResult("  replayed: ", replayed[i]);
+                }
+            }
+            battles += static_cast<long long>(count);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (!reader.error().empty()) cerr << "Error: " << reader.error() << endl;
+
+        cout << "\nBattles:      " << battles << "\n"
+            << "Verified:     " << (battles - mismatches - skipped) << "\n"
+            << "Mismatches:   " << mismatches << "\n"
+            << "Skipped:      " << skipped << "\n"
+            << "Elapsed:      " << seconds << " s\n";
+        if (seconds > 0) {
+            cout << "Throughput:   " << static_cast<long long>(rounds / seconds) << " rounds/s, "
+                << static_cast<long long>(battles / seconds) << " battles/s\n";
+        }
+        return (mismatches || skipped || !reader.error().empty()) ? 1 : 0;
+    }
+
+    void printState(const string& name, const Character::BattleState& s) {
+        cout << "  " << name << " starts at " << s.hp << " HP, bonus " << s.bonus
+            << ", damage R" << s.rock << "/P" << s.paper << "/S" << s.scissors << "\n";
+    }
+
+    int showReplay(ReplayReader& reader, long long wanted) {
+        ReplayBattle battle;
+        long long index = 0;
+        bool found = false;
+        while (reader.next(battle)) {
+            if (index++ == wanted) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            cerr << "Error: " << (reader.error().empty() ? "the log has only " + to_string(index) + " battles" : reader.error()) << endl;
+            return 1;
+        }
+
+        loadCharacters();
+        if (!knownFighters(battle)) {
+            cerr << "Error: battle " << wanted << " uses fighter IDs that are not in the roster." << endl;
+            return 1;
+        }
+        const Character& player = *availableCharacters[battle.playerId];
+        const Character& bot = *availableCharacters[battle.botId];
+        if (battle.fingerprint != rosterFingerprint(availableCharacters)) {
+            cerr << "Warning: the battle was recorded against a different roster." << endl;
+        }
+
+        cout << "\n=== Battle " << wanted << ": " << player.getName() << " vs " << bot.getName() << " ===\n"
+            << "Seed " << battle.seed << ", stream " << battle.stream << "\n";
+        if (battle.hasPlayerStart) printState(player.getName(), battle.playerStart);
+        if (battle.hasBotStart) printState(bot.getName(), battle.botStart);
+        cout << "\n";
+        BattleResult replayed = replayBattle(battle, player, bot, cout);
+        cout << "\n";
+        printResult("Recorded: ", battle.result);
+        printResult("Replayed: ", replayed);
+        return sameResult(replayed, battle.result) ? 0 : 1;
+    }
+}
+
+int runReplayCommand(int argc, char* argv[]) {
+    if (argc < 2) {
+        printReplayUsage();
+        return 1;
+    }
+
+    string action = argv[0];
+    if (action != "info" && action != "verify" && action != "show") {
+        printReplayUsage();
+        return 1;
+    }
+    string path = argv[1];
+    long long battleIndex = 0;
+    unsigned threads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printReplayUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--battle") battleIndex = stoll(value);
+            else if (opt == "--threads") threads = static_cast<unsigned>(stoul(value));
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || battleIndex < 0) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printReplayUsage();
+            return 1;
+        }
+    }
+
+    ReplayReader reader;
+    if (!reader.open(path)) {
+        cerr << "Error: " << reader.error() << endl;
+        return 1;
+    }
+    if (action == "info") return printReplayInfo(reader);
+    if (action == "verify") return verifyReplays(reader, threads);
+    return showReplay(reader, battleIndex);
+}
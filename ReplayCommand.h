@@ -0,0 +1,9 @@
+#ifndef REPLAYCOMMAND_H
+#define REPLAYCOMMAND_H
+
+// Entry point for "replay": inspects a replay log, re-runs every battle in it
+// against the current rules and roster (exit code 1 on any mismatch), or
+// prints one battle round by round
+int runReplayCommand(int argc, char* argv[]);
+
+#endif // REPLAYCOMMAND_H
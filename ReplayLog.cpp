@@ -0,0 +1,349 @@
+#include "ReplayLog.h"
+#include "CharacterPool.h"
+#include "CharacterRegistry.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+using namespace std;
+
+namespace {
+    const char K_MAGIC[4] = { 'P', 'B', 'R', 'P' };
+
+    // Battle entry flags; bits 0-1 hold the BattleOutcome
+    const uint8_t K_OUTCOME_MASK = 0x03;
+    const uint8_t K_SAME_FIGHTERS = 0x04;  // IDs omitted: same as the previous battle
+    const uint8_t K_ENDED_AT_BEGIN = 0x08; // One more round than moves: it ended in beginRound
+    const uint8_t K_PLAYER_START = 0x10;
+    const uint8_t K_BOT_START = 0x20;
+    const uint8_t K_SHARED_FIGHTER = 0x40;
+    const uint8_t K_SESSION = 0x80;        // Not a battle: a session marker
+
+    const char* moveName(int move) {
+        return move == 1 ? "Rock" : (move == 2 ? "Paper" : "Scissors");
+    }
+
+    uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    int64_t unzigzag(uint64_t v) {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    void putVarint(vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void putFixed64(vector<uint8_t>& out, uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void putState(vector<uint8_t>& out, const Character::BattleState& s) {
+        putVarint(out, zigzag(s.hp));
+        putVarint(out, zigzag(s.bonus));
+        putVarint(out, zigzag(s.rock));
+        putVarint(out, zigzag(s.paper));
+        putVarint(out, zigzag(s.scissors));
+        putVarint(out, s.triggered);
+    }
+
+    // Bounds-checked cursor over the log bytes
+    struct Cursor {
+        const vector<uint8_t>& bytes;
+        size_t& pos;
+
+        bool varint(uint64_t& v) {
+            v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (pos >= bytes.size()) return false;
+                uint8_t b = bytes[pos++];
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return true;
+            }
+            return false;
+        }
+        bool signedInt(int& v) {
+            uint64_t raw;
+            if (!varint(raw)) return false;
+            v = static_cast<int>(unzigzag(raw));
+            return true;
+        }
+        bool fixed64(uint64_t& v) {
+            if (bytes.size() - pos < 8) return false;
+            v = 0;
+            for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(bytes[pos++]) << (8 * i);
+            return true;
+        }
+        bool state(Character::BattleState& s) {
+            uint64_t triggered;
+            if (!signedInt(s.hp) || !signedInt(s.bonus) || !signedInt(s.rock) || !signedInt(s.paper)
+                || !signedInt(s.scissors) || !varint(triggered)) return false;
+            s.triggered = static_cast<uint32_t>(triggered);
+            return true;
+        }
+    };
+
+    // Interactive replays print around every round; verification prints nothing
+    struct SilentNarrator {
+        void roundStart(int, int, int) {}
+        void roundEnd(const Character&, const Character&) {}
+    };
+
+    struct StreamNarrator {
+        ostream& out;
+        void roundStart(int round, int playerMove, int botMove) {
+            out << "Round " << round << ": " << moveName(playerMove) << " vs " << moveName(botMove) << "\n";
+        }
+        void roundEnd(const Character& player, const Character& bot) {
+            out << "  " << player.getName() << " " << player.getCurrentHp() << " HP, "
+                << bot.getName() << " " << bot.getCurrentHp() << " HP\n";
+        }
+    };
+
+    template <class Sink, class Narrator>
+    BattleResult replayImpl(const ReplayBattle& battle, const Character& playerProto, const Character& botProto,
+        Sink& sink, Narrator& narrator) {
+        CharacterPool& pool = CharacterPool::local();
+        CharacterPool::Scope scope(pool);
+        Character& player = pool.acquire(playerProto);
+        Character& bot = battle.sharedFighter ? player : pool.acquire(botProto);
+        if (battle.hasPlayerStart) player.restoreBattleState(battle.playerStart);
+        if (battle.hasBotStart && !battle.sharedFighter) bot.restoreBattleState(battle.botStart);
+
+        // Same order as Game, GauntletGame and BattleEngine::playBattle. A
+        // battle that ends before its moves run out comes back short of rounds.
+        int rounds = 0;
+        bool over = false;
+        for (uint8_t pair : battle.movePairs) {
+            ++rounds;
+            int playerMove = pair >> 2;
+            int botMove = pair & 3;
+            narrator.roundStart(rounds, playerMove, botMove);
+            if (BattleEngine::beginRound(player, bot, sink)) {
+                over = true;
+                break;
+            }
+            over = BattleEngine::resolveMoves(player, bot, playerMove, botMove, sink);
+            narrator.roundEnd(player, bot);
+            if (over) break;
+        }
+        if (!over && battle.result.rounds > rounds) {
+            ++rounds;
+            BattleEngine::beginRound(player, bot, sink);
+        }
+        return BattleEngine::resultOf(player, bot, rounds);
+    }
+}
+
+void ReplayBattle::clear() {
+    playerId = botId = INVALID_CHARACTER_ID;
+    sharedFighter = hasPlayerStart = hasBotStart = false;
+    movePairs.clear();
+    result = BattleResult();
+}
+
+void ReplayBattle::recordStart(const Character& player, const Character& bot, bool shared, bool withStates) {
+    clear();
+    playerId = player.getId();
+    botId = bot.getId();
+    sharedFighter = shared;
+    if (withStates) {
+        hasPlayerStart = true;
+        playerStart = player.captureBattleState();
+        hasBotStart = !sharedFighter;
+        if (hasBotStart) botStart = bot.captureBattleState();
+    }
+}
+
+uint64_t rosterFingerprint(const CharacterRegistry& roster) {
+    // FNV-1a over the definition hashes in ID order
+    uint64_t h = 0xCBF29CE484222325ULL ^ roster.size();
+    for (const auto& c : roster) {
+        uint64_t d = c->getDefinitionHash();
+        for (int i = 0; i < 8; ++i) {
+            h ^= (d >> (8 * i)) & 0xFF;
+            h *= 0x100000001B3ULL;
+        }
+    }
+    return h;
+}
+
+bool ReplayWriter::open(const string& path, bool flushEach) {
+    out.open(path, ios::binary | ios::app);
+    if (!out) {
+        cerr << "Error: Could not open " << path << " for writing!" << endl;
+        return false;
+    }
+    flushEachBattle = flushEach;
+    out.seekp(0, ios::end);
+    if (out.tellp() == streampos(0)) {
+        out.write(K_MAGIC, sizeof(K_MAGIC));
+        out.put(static_cast<char>(VERSION));
+    }
+    return static_cast<bool>(out);
+}
+
+void ReplayWriter::beginSession(uint64_t sessionSeed, const CharacterRegistry& sessionRoster) {
+    seed = sessionSeed;
+    roster = &sessionRoster;
+    stream = 0;
+    writeSession();
+}
+
+void ReplayWriter::writeSession() {
+    rosterGeneration = roster->generation();
+    buffer.clear();
+    buffer.push_back(K_SESSION);
+    putFixed64(buffer, seed);
+    putFixed64(buffer, rosterFingerprint(*roster));
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<streamsize>(buffer.size()));
+    expectedStream = 0;
+    lastPlayer = lastBot = INVALID_CHARACTER_ID;
+}
+
+bool ReplayWriter::write(const ReplayBattle& battle) {
+    if (!roster) return false;
+    // Created or deleted characters shift IDs, so the fingerprint has to follow;
+    // a delete and a create between two battles leave the size as it was
+    if (roster->generation() != rosterGeneration) writeSession();
+
+    size_t pairs = battle.movePairs.size();
+    bool endedAtBegin = static_cast<size_t>(battle.result.rounds) == pairs + 1;
+    bool sameFighters = battle.playerId == lastPlayer && battle.botId == lastBot;
+
+    uint8_t flags = static_cast<uint8_t>(battle.result.outcome) & K_OUTCOME_MASK;
+    if (sameFighters) flags |= K_SAME_FIGHTERS;
+    if (endedAtBegin) flags |= K_ENDED_AT_BEGIN;
+    if (battle.hasPlayerStart) flags |= K_PLAYER_START;
+    if (battle.hasBotStart) flags |= K_BOT_START;
+    if (battle.sharedFighter) flags |= K_SHARED_FIGHTER;
+
+    buffer.clear();
+    buffer.push_back(flags);
+    putVarint(buffer, zigzag(static_cast<int64_t>(battle.stream - expectedStream)));
+    if (!sameFighters) {
+        putVarint(buffer, battle.playerId);
+        putVarint(buffer, battle.botId);
+    }
+    putVarint(buffer, pairs);
+    if (battle.hasPlayerStart) putState(buffer, battle.playerStart);
+    if (battle.hasBotStart) putState(buffer, battle.botStart);
+    for (size_t i = 0; i < pairs; i += 2) {
+        uint8_t packed = battle.movePairs[i] & 0x0F;
+        if (i + 1 < pairs) packed |= static_cast<uint8_t>((battle.movePairs[i + 1] & 0x0F) << 4);
+        buffer.push_back(packed);
+    }
+    putVarint(buffer, zigzag(battle.result.playerHp));
+    putVarint(buffer, zigzag(battle.result.botHp));
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<streamsize>(buffer.size()));
+    if (flushEachBattle) out.flush();
+
+    expectedStream = battle.stream + 1;
+    stream = max(stream, battle.stream + 1);
+    lastPlayer = battle.playerId;
+    lastBot = battle.botId;
+    return static_cast<bool>(out);
+}
+
+bool ReplayReader::open(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) return fail("could not open " + path);
+    bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    pos = 0;
+    sessionCount = 0;
+    errorText.clear();
+    if (bytes.size() < sizeof(K_MAGIC) + 1 || memcmp(bytes.data(), K_MAGIC, sizeof(K_MAGIC)) != 0) {
+        return fail(path + " is not a replay log");
+    }
+    if (bytes[sizeof(K_MAGIC)] != ReplayWriter::VERSION) {
+        return fail(path + " has unsupported replay version " + to_string(bytes[sizeof(K_MAGIC)]));
+    }
+    pos = sizeof(K_MAGIC) + 1;
+    return true;
+}
+
+bool ReplayReader::fail(const string& what) {
+    errorText = what;
+    pos = bytes.size();
+    return false;
+}
+
+bool ReplayReader::next(ReplayBattle& battle) {
+    Cursor in{ bytes, pos };
+    while (pos < bytes.size()) {
+        size_t entryStart = pos;
+        uint8_t flags = bytes[pos++];
+        if (flags & K_SESSION) {
+            if (!in.fixed64(seed) || !in.fixed64(fingerprint)) {
+                return fail("truncated session at byte " + to_string(entryStart));
+            }
+            ++sessionCount;
+            stream = 0;
+            lastPlayer = lastBot = INVALID_CHARACTER_ID;
+            continue;
+        }
+        if (sessionCount == 0) return fail("battle before any session at byte " + to_string(entryStart));
+
+        battle.clear();
+        battle.seed = seed;
+        battle.fingerprint = fingerprint;
+        uint64_t delta, pairs, id;
+        if (!in.varint(delta)) return fail("truncated battle at byte " + to_string(entryStart));
+        battle.stream = stream + static_cast<uint64_t>(unzigzag(delta));
+        if (flags & K_SAME_FIGHTERS) {
+            battle.playerId = lastPlayer;
+            battle.botId = lastBot;
+        }
+        else {
+            if (!in.varint(id)) return fail("truncated battle at byte " + to_string(entryStart));
+            battle.playerId = static_cast<CharacterId>(id);
+            if (!in.varint(id)) return fail("truncated battle at byte " + to_string(entryStart));
+            battle.botId = static_cast<CharacterId>(id);
+        }
+        if (!in.varint(pairs) || pairs > 2 * (bytes.size() - pos)) {
+            return fail("truncated battle at byte " + to_string(entryStart));
+        }
+        battle.sharedFighter = (flags & K_SHARED_FIGHTER) != 0;
+        battle.hasPlayerStart = (flags & K_PLAYER_START) != 0;
+        battle.hasBotStart = (flags & K_BOT_START) != 0;
+        if ((battle.hasPlayerStart && !in.state(battle.playerStart)) || (battle.hasBotStart && !in.state(battle.botStart))) {
+            return fail("truncated battle at byte " + to_string(entryStart));
+        }
+        if (bytes.size() - pos < (pairs + 1) / 2) return fail("truncated battle at byte " + to_string(entryStart));
+        battle.movePairs.resize(pairs);
+        for (size_t i = 0; i < pairs; ++i) {
+            uint8_t pair = (bytes[pos + i / 2] >> (i % 2 ? 4 : 0)) & 0x0F;
+            if ((pair >> 2) < 1 || (pair & 3) < 1) return fail("bad move in battle at byte " + to_string(entryStart));
+            battle.movePairs[i] = pair;
+        }
+        pos += (pairs + 1) / 2;
+        if (!in.signedInt(battle.result.playerHp) || !in.signedInt(battle.result.botHp)) {
+            return fail("truncated battle at byte " + to_string(entryStart));
+        }
+        battle.result.outcome = static_cast<BattleOutcome>(flags & K_OUTCOME_MASK);
+        battle.result.rounds = static_cast<int>(pairs) + ((flags & K_ENDED_AT_BEGIN) ? 1 : 0);
+
+        stream = battle.stream + 1;
+        lastPlayer = battle.playerId;
+        lastBot = battle.botId;
+        return true;
+    }
+    return false;
+}
+
+BattleResult replayBattle(const ReplayBattle& battle, const Character& playerProto, const Character& botProto) {
+    NullEventSink sink;
+    SilentNarrator narrator;
+    return replayImpl(battle, playerProto, botProto, sink, narrator);
+}
+
+BattleResult replayBattle(const ReplayBattle& battle, const Character& playerProto, const Character& botProto, ostream& out) {
+    ConsoleEventSink sink(out);
+    StreamNarrator narrator{ out };
+    return replayImpl(battle, playerProto, botProto, sink, narrator);
+}
@@ -0,0 +1,121 @@
+#ifndef REPLAYLOG_H
+#define REPLAYLOG_H
+
+#include "BattleEngine.h"
+#include "Character.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class CharacterRegistry;
+
+// One recorded battle. Moves and the fighters' starting states fully decide a
+// battle (passives draw no random numbers), so this is all a replay needs;
+// seed and stream only say where the moves came from.
+struct ReplayBattle {
+    uint64_t seed = 0;        // Session seed: the sim's --seed, or the menu's entropy seed
+    uint64_t fingerprint = 0; // rosterFingerprint() of the roster the battle was played on
+    uint64_t stream = 0;      // Battle number in the session; a sim's battle i uses stream i of seed
+    CharacterId playerId = INVALID_CHARACTER_ID;
+    CharacterId botId = INVALID_CHARACTER_ID;
+    bool sharedFighter = false; // The bot was the player's own instance (the menu allows it)
+    // Fighters not starting as a fresh copy of their roster entry (the Gauntlet
+    // carries HP and buffs over, and the menu fights on the roster entries themselves)
+    bool hasPlayerStart = false;
+    bool hasBotStart = false;
+    Character::BattleState playerStart;
+    Character::BattleState botStart;
+    std::vector<uint8_t> movePairs; // Per round: playerMove << 2 | botMove, moves 1-3
+    BattleResult result;            // rounds is movePairs.size(), or one more if the last round ended in beginRound
+
+    void clear();
+    // shared: player and bot are one instance in the battle itself. Only the
+    // caller knows; the sim passes prototypes that runBattle copies apart.
+    void recordStart(const Character& player, const Character& bot, bool shared, bool withStates);
+    void addRound(int playerMove, int botMove) { movePairs.push_back(static_cast<uint8_t>(playerMove << 2 | botMove)); }
+};
+
+// Hash of every character's ID and definition (name, max HP, passives), so a
+// replay can tell it is looking at the roster the log was recorded against.
+// Base damages are not in it: the menu buffs roster entries in place, so they
+// travel in each battle's starting state wherever they can differ.
+uint64_t rosterFingerprint(const CharacterRegistry& roster);
+
+// Appends battles to a replay log. The format, little-endian throughout:
+//   file     "PBRP", version byte, then entries
+//   session  0x80, seed (8 bytes), roster fingerprint (8 bytes)
+//   battle   flags byte (outcome in bits 0-1, then the K_ flags in ReplayLog.cpp),
+//            stream delta, player and bot IDs unless the same as the last
+//            battle's, round count, starting states, the moves two bits each
+//            (four bits a round), final player and bot HP
+// Numbers are LEB128 varints, signed ones zigzagged, so a typical AI battle
+// takes a dozen bytes.
+class ReplayWriter {
+public:
+    static const uint8_t VERSION = 1;
+
+    // Appends to path, writing the file header first if it is new; false if it cannot be opened.
+    // flushEachBattle keeps interactive logs complete if the game is closed mid-session.
+    bool open(const std::string& path, bool flushEachBattle = false);
+    bool isOpen() const { return out.is_open(); }
+
+    // Starts a session: later battles are tagged with seed and roster's
+    // fingerprint, which is taken again whenever the roster changes
+    void beginSession(uint64_t seed, const CharacterRegistry& roster);
+    uint64_t nextStream() const { return stream; }
+    // false if the stream could not be written
+    bool write(const ReplayBattle& battle);
+
+private:
+    std::ofstream out;
+    bool flushEachBattle = false;
+    const CharacterRegistry* roster = nullptr;
+    uint64_t rosterGeneration = 0; // CharacterRegistry::generation() the fingerprint was taken at
+    uint64_t seed = 0;
+    uint64_t stream = 0;         // Lowest stream no battle of the session has used yet
+    uint64_t expectedStream = 0; // Streams are stored as the difference from this
+    CharacterId lastPlayer = INVALID_CHARACTER_ID;
+    CharacterId lastBot = INVALID_CHARACTER_ID;
+    std::vector<uint8_t> buffer;
+
+    void writeSession();
+};
+
+// Reads a whole replay log into memory and decodes it battle by battle
+class ReplayReader {
+public:
+    // false (with error() set) if the file is missing or not a replay log
+    bool open(const std::string& path);
+    // Next battle, or false at the end of the log or at a damaged entry; error() tells which
+    bool next(ReplayBattle& battle);
+
+    const std::string& error() const { return errorText; }
+    size_t fileSize() const { return bytes.size(); }
+    size_t sessions() const { return sessionCount; }
+
+private:
+    std::vector<uint8_t> bytes;
+    size_t pos = 0;
+    size_t sessionCount = 0;
+    std::string errorText;
+    uint64_t seed = 0;
+    uint64_t fingerprint = 0;
+    uint64_t stream = 0;
+    CharacterId lastPlayer = INVALID_CHARACTER_ID;
+    CharacterId lastBot = INVALID_CHARACTER_ID;
+
+    bool fail(const std::string& what);
+};
+
+// Re-plays a battle through the round rules on pooled copies of the
+// prototypes, with no I/O. Matches battle.result exactly if the rules and
+// roster are unchanged.
+BattleResult replayBattle(const ReplayBattle& battle, const Character& playerProto, const Character& botProto);
+// Same, printing every round's moves, passives and HP to out
+BattleResult replayBattle(const ReplayBattle& battle, const Character& playerProto, const Character& botProto,
+    std::ostream& out);
+
+#endif // REPLAYLOG_H
@@ -0,0 +1,125 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <utility>
+
+// xoshiro256** generator used for every random decision in the game.
+// Streams derived with fork() depend only on the parent seed and the stream id,
+// so parallel runs reproduce exactly whatever the thread count or schedule.
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 0) {
+        uint64_t x = seed;
+        for (auto& word : s) {
+            word = splitMix64(x);
+        }
+    }
+
+    // One random_device read, for interactive sessions that want a fresh game each run
+    static Rng fromEntropy() {
+        return Rng(entropySeed());
+    }
+
+    // The seed fromEntropy() would use, for sessions that want to log it
+    static uint64_t entropySeed() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~static_cast<result_type>(0); }
+    result_type operator()() { return next(); }
+
+    uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in [lo, hi] (Lemire's multiply-shift with rejection, so no modulo bias)
+    int nextInt(int lo, int hi) {
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+        uint64_t x = next() >> 32;
+        uint64_t m = x * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < range) {
+            const uint32_t threshold = static_cast<uint32_t>((0x100000000ULL - range) % range);
+            while (low < threshold) {
+                x = next() >> 32;
+                m = x * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return lo + static_cast<int>(m >> 32);
+    }
+
+    // Uniform in [0, 1) with 53 random bits
+    double nextDouble() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // True with the given percent chance (0-100)
+    bool chance(int percent) {
+        return nextInt(1, 100) <= percent;
+    }
+
+    // Independent child stream; does not advance this generator
+    Rng fork(uint64_t streamId) const {
+        uint64_t x = s[0] ^ rotl(s[1], 13) ^ rotl(s[2], 29) ^ rotl(s[3], 47);
+        uint64_t mixed = splitMix64(x);
+        x = streamId ^ mixed;
+        return Rng(splitMix64(x) ^ mixed);
+    }
+
+    // Child stream that also advances this generator, for handing out sub-contexts
+    Rng split() {
+        return Rng(next());
+    }
+
+    // Raw generator words, for code that steps many streams side by side (BatchBattle)
+    void saveState(uint64_t out[4]) const {
+        for (int i = 0; i < 4; ++i) out[i] = s[i];
+    }
+
+    static Rng fromState(const uint64_t in[4]) {
+        Rng rng;
+        for (int i = 0; i < 4; ++i) rng.s[i] = in[i];
+        return rng;
+    }
+
+    template <class RandomIt>
+    void shuffle(RandomIt first, RandomIt last) {
+        auto n = std::distance(first, last);
+        for (auto i = n - 1; i > 0; --i) {
+            using std::swap;
+            swap(first[i], first[nextInt(0, static_cast<int>(i))]);
+        }
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // RNG_H
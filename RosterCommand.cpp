@@ -0,0 +1,78 @@
+#include "RosterCommand.h"
+#include "CharacterManager.h"
+#include "RosterFile.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+    void printRosterUsage() {
+        cout << "Usage: roster pack|unpack|info [options]\n"
+            << "  pack               Convert a text save file to a binary roster\n"
+            << "  unpack             Convert a binary roster to a text save file\n"
+            << "  info               Map a roster and print its header\n"
+            << "  --in FILE          Input (default " << SAVE_FILE << " for pack, " << ROSTER_FILE << " otherwise)\n"
+            << "  --out FILE         Output (default " << ROSTER_FILE << " for pack, " << SAVE_FILE << " for unpack)\n"
+            << "The game loads " << ROSTER_FILE << " instead of " << SAVE_FILE << " when it exists.\n";
+    }
+
+    int printRosterInfo(const string& path) {
+        auto start = chrono::steady_clock::now();
+        shared_ptr<const RosterFile> roster = RosterFile::open(path);
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        if (!roster) return 1;
+
+        const RosterHeader& header = roster->getHeader();
+        cout << "Roster:       " << path << "\n"
+            << "Version:      " << header.version << "\n"
+            << "Characters:   " << header.characterCount << "\n"
+            << "Passives:     " << header.passiveCount << "\n"
+            << "Index slots:  " << header.indexBuckets << "\n"
+            << "Name bytes:   " << header.stringsSize << "\n"
+            << "File size:    " << header.fileSize << " bytes\n"
+            << "Open time:    " << micros << " us" << endl;
+        return 0;
+    }
+}
+
+int runRosterCommand(int argc, char* argv[]) {
+    if (argc < 1) {
+        printRosterUsage();
+        return 1;
+    }
+
+    string action = argv[0];
+    if (action != "pack" && action != "unpack" && action != "info") {
+        printRosterUsage();
+        return 1;
+    }
+    string inPath = (action == "pack") ? SAVE_FILE : ROSTER_FILE;
+    string outPath = (action == "pack") ? ROSTER_FILE : SAVE_FILE;
+
+    for (int i = 1; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printRosterUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (opt == "--in") inPath = value;
+        else if (opt == "--out") outPath = value;
+        else {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printRosterUsage();
+            return 1;
+        }
+    }
+
+    if (action == "info") return printRosterInfo(inPath);
+    if (inPath == outPath) {
+        cerr << "Error: --in and --out must differ" << endl;
+        return 1;
+    }
+    bool ok = (action == "pack") ? convertTextToRoster(inPath, outPath) : convertRosterToText(inPath, outPath);
+    return ok ? 0 : 1;
+}
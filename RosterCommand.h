@@ -0,0 +1,9 @@
+#ifndef ROSTERCOMMAND_H
+#define ROSTERCOMMAND_H
+
+// Entry point for "roster": converts between the text save file and the
+// binary roster, and describes a roster file.
+// args excludes the program name and the "roster" keyword itself.
+int runRosterCommand(int argc, char* argv[]);
+
+#endif // ROSTERCOMMAND_H
@@ -0,0 +1,306 @@
+#include "RosterFile.h"
+#include "FileSync.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+    const char K_ROSTER_MAGIC[8] = { 'P', 'B', 'R', 'O', 'S', 'T', 'E', 'R' };
+    const uint32_t K_MIN_INDEX_BUCKETS = 16;
+
+    uint64_t alignUp(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    // Section [offset, offset + count * size) lies inside the file and is aligned
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize) {
+        if (offset % 8 != 0 || offset > fileSize) return false;
+        return count <= (fileSize - offset) / size;
+    }
+
+    bool isLittleEndian() {
+        const uint16_t probe = 1;
+        unsigned char first;
+        memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+}
+
+uint64_t rosterNameHash(string_view name) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+shared_ptr<const RosterFile> RosterFile::open(const string& path) {
+    if (!isLittleEndian()) {
+        cerr << "Error: roster files are little-endian and this machine is not\n";
+        return nullptr;
+    }
+
+    shared_ptr<RosterFile> file(new RosterFile());
+    file->path = path;
+
+#if defined(_WIN32)
+    // FILE_SHARE_DELETE lets a save rename a new roster over this one while it is mapped
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        cerr << "Error: could not open " << path << endl;
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(RosterHeader))) {
+        CloseHandle(handle);
+        cerr << "Error: " << path << " is too small to be a roster\n";
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (!mapping) {
+        cerr << "Error: could not map " << path << endl;
+        return nullptr;
+    }
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        cerr << "Error: could not map " << path << endl;
+        return nullptr;
+    }
+    file->mappingHandle = mapping;
+    file->base = static_cast<const unsigned char*>(view);
+    file->mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error: could not open " << path << endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RosterHeader))) {
+        ::close(fd);
+        cerr << "Error: " << path << " is too small to be a roster\n";
+        return nullptr;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        cerr << "Error: could not map " << path << endl;
+        return nullptr;
+    }
+    file->base = static_cast<const unsigned char*>(view);
+    file->mappedSize = static_cast<size_t>(st.st_size);
+#endif
+
+    if (!file->validate()) return nullptr;
+    return file;
+}
+
+RosterFile::~RosterFile() {
+    if (!base) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+#else
+    munmap(const_cast<unsigned char*>(base), mappedSize);
+#endif
+}
+
+bool RosterFile::validate() {
+    header = reinterpret_cast<const RosterHeader*>(base);
+    if (memcmp(header->magic, K_ROSTER_MAGIC, sizeof(K_ROSTER_MAGIC)) != 0) {
+        cerr << "Error: " << path << " is not a roster file\n";
+        return false;
+    }
+    if (header->version != ROSTER_FORMAT_VERSION || header->headerSize != sizeof(RosterHeader)) {
+        cerr << "Error: " << path << " is roster version " << header->version
+            << "; this build reads version " << ROSTER_FORMAT_VERSION << endl;
+        return false;
+    }
+
+    const uint64_t fileSize = mappedSize;
+    const uint32_t buckets = header->indexBuckets;
+    bool sane = header->fileSize == fileSize
+        && buckets >= K_MIN_INDEX_BUCKETS && (buckets & (buckets - 1)) == 0
+        && header->characterCount <= buckets / 2
+        && sectionFits(header->recordsOffset, header->characterCount, sizeof(RosterRecord), fileSize)
+        && sectionFits(header->passivesOffset, header->passiveCount, sizeof(RosterPassive), fileSize)
+        && sectionFits(header->indexOffset, buckets, sizeof(RosterIndexSlot), fileSize)
+        && header->stringsOffset <= fileSize && header->stringsSize <= fileSize - header->stringsOffset;
+    if (!sane) {
+        cerr << "Error: " << path << " is truncated or has a corrupt header\n";
+        return false;
+    }
+
+    records = reinterpret_cast<const RosterRecord*>(base + header->recordsOffset);
+    passives = reinterpret_cast<const RosterPassive*>(base + header->passivesOffset);
+    index = reinterpret_cast<const RosterIndexSlot*>(base + header->indexOffset);
+    strings = reinterpret_cast<const char*>(base + header->stringsOffset);
+
+    // One pass over the fixed-size records, so later accessors need no checks.
+    // It touches no heap and no strings, which keeps it a small slice of the load.
+    for (uint32_t i = 0; i < header->characterCount; ++i) {
+        const RosterRecord& r = records[i];
+        bool ok = uint64_t(r.nameOffset) + r.nameLength <= header->stringsSize
+            && uint64_t(r.firstPassive) + r.passiveCount <= header->passiveCount
+            && r.type <= static_cast<uint8_t>(CharacterType::CUSTOM)
+            && r.maxHp > 0;
+        if (!ok) {
+            cerr << "Error: " << path << " has a corrupt record at index " << i << endl;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->passiveCount; ++i) {
+        if (passives[i].trigger > static_cast<uint8_t>(PassiveTrigger::AFTER_TAKING_HIT)
+            || passives[i].effect > static_cast<uint8_t>(PassiveEffect::DAMAGE_OPPONENT_PERCENT_CURRENT)) {
+            cerr << "Error: " << path << " has a corrupt passive at index " << i << endl;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < buckets; ++i) {
+        if (index[i].record > header->characterCount) {
+            cerr << "Error: " << path << " has a corrupt name index\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+Passive RosterFile::passive(uint32_t index, uint32_t n) const {
+    const RosterPassive& p = passives[records[index].firstPassive + n];
+    return Passive(static_cast<PassiveTrigger>(p.trigger), static_cast<PassiveEffect>(p.effect), p.value, p.threshold);
+}
+
+uint32_t RosterFile::find(string_view name) const {
+    const uint32_t hash = static_cast<uint32_t>(rosterNameHash(name));
+    const uint32_t mask = header->indexBuckets - 1;
+    // At most half full, so the probe always reaches an empty slot
+    for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const RosterIndexSlot& s = index[slot];
+        if (s.record == 0) return NOT_FOUND;
+        if (s.hash == hash && this->name(s.record - 1) == name) return s.record - 1;
+    }
+}
+
+unique_ptr<Character> RosterFile::load(uint32_t index) const {
+    const RosterRecord& r = records[index];
+    vector<Passive> list;
+    list.reserve(r.passiveCount);
+    for (uint32_t n = 0; n < r.passiveCount; ++n) list.push_back(passive(index, n));
+    return make_unique<Character>(string(name(index)), r.maxHp, r.rock, r.paper, r.scissors,
+        std::move(list), static_cast<CharacterType>(r.type));
+}
+
+bool RosterWriter::addRecord(string_view name, CharacterType type, int hp, int rock, int paper, int scissors) {
+    if (name.size() > UINT16_MAX || strings.size() + name.size() > UINT32_MAX) return false;
+    if (!names.emplace(name).second) return false;
+
+    RosterRecord r{};
+    r.nameOffset = static_cast<uint32_t>(strings.size());
+    r.nameLength = static_cast<uint16_t>(name.size());
+    r.type = static_cast<uint8_t>(type);
+    r.maxHp = hp;
+    r.rock = rock;
+    r.paper = paper;
+    r.scissors = scissors;
+    r.firstPassive = static_cast<uint32_t>(passives.size());
+    records.push_back(r);
+    strings.append(name);
+    return true;
+}
+
+void RosterWriter::addPassive(const Passive& p) {
+    RosterPassive out{};
+    out.trigger = static_cast<uint8_t>(p.trigger);
+    out.effect = static_cast<uint8_t>(p.effect);
+    out.value = p.value;
+    out.threshold = p.threshold;
+    passives.push_back(out);
+    ++records.back().passiveCount;
+}
+
+bool RosterWriter::add(const Character& character) {
+    if (character.getPassives().size() > UINT8_MAX) return false;
+    if (!addRecord(character.getName(), character.getType(), character.getMaxHp(),
+        character.getRockDamage(), character.getPaperDamage(), character.getScissorsDamage())) {
+        return false;
+    }
+    for (const Passive& p : character.getPassives()) addPassive(p);
+    return true;
+}
+
+bool RosterWriter::add(const RosterFile& file, uint32_t index) {
+    const RosterRecord& r = file.record(index);
+    if (!addRecord(file.name(index), static_cast<CharacterType>(r.type), r.maxHp, r.rock, r.paper, r.scissors)) {
+        return false;
+    }
+    for (uint32_t n = 0; n < r.passiveCount; ++n) addPassive(file.passive(index, n));
+    return true;
+}
+
+bool RosterWriter::write(const string& path) const {
+    uint32_t buckets = K_MIN_INDEX_BUCKETS;
+    while (buckets / 2 < records.size()) buckets *= 2;
+
+    vector<RosterIndexSlot> index(buckets);
+    for (uint32_t i = 0; i < records.size(); ++i) {
+        string_view name(strings.data() + records[i].nameOffset, records[i].nameLength);
+        uint32_t hash = static_cast<uint32_t>(rosterNameHash(name));
+        uint32_t slot = hash & (buckets - 1);
+        while (index[slot].record != 0) slot = (slot + 1) & (buckets - 1);
+        index[slot] = { hash, i + 1 };
+    }
+
+    RosterHeader header{};
+    memcpy(header.magic, K_ROSTER_MAGIC, sizeof(K_ROSTER_MAGIC));
+    header.version = ROSTER_FORMAT_VERSION;
+    header.headerSize = sizeof(RosterHeader);
+    header.characterCount = static_cast<uint32_t>(records.size());
+    header.passiveCount = static_cast<uint32_t>(passives.size());
+    header.indexBuckets = buckets;
+    header.recordsOffset = alignUp(sizeof(RosterHeader));
+    header.passivesOffset = alignUp(header.recordsOffset + records.size() * sizeof(RosterRecord));
+    header.indexOffset = alignUp(header.passivesOffset + passives.size() * sizeof(RosterPassive));
+    header.stringsOffset = alignUp(header.indexOffset + index.size() * sizeof(RosterIndexSlot));
+    header.stringsSize = strings.size();
+    header.fileSize = header.stringsOffset + header.stringsSize;
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        cerr << "Error: Could not open " << path << " for writing!" << endl;
+        return false;
+    }
+    const char padding[8] = {};
+    auto section = [&](uint64_t offset, const void* data, size_t bytes) {
+        out.write(padding, static_cast<streamsize>(offset - static_cast<uint64_t>(out.tellp())));
+        out.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    section(header.recordsOffset, records.data(), records.size() * sizeof(RosterRecord));
+    section(header.passivesOffset, passives.data(), passives.size() * sizeof(RosterPassive));
+    section(header.indexOffset, index.data(), index.size() * sizeof(RosterIndexSlot));
+    section(header.stringsOffset, strings.data(), strings.size());
+    out.close();
+    if (!out || !syncPath(path)) {
+        cerr << "Error: failed while writing " << path << endl;
+        return false;
+    }
+    return true;
+}
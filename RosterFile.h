@@ -0,0 +1,145 @@
+#ifndef ROSTERFILE_H
+#define ROSTERFILE_H
+
+#include "Character.h"
+#include "PassiveSystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Binary roster, version 1. All integers are little-endian and every section
+// starts on an 8-byte boundary:
+//
+//   RosterHeader
+//   RosterRecord[characterCount]   fixed size, in roster order
+//   RosterPassive[passiveCount]    each record owns a contiguous run
+//   RosterIndexSlot[indexBuckets]  open-addressed name index, linear probing
+//   char[stringsSize]              names, not NUL-terminated
+//
+// The file is mapped read-only and used in place: opening it only checks the
+// header and the section bounds, and a character is built from its record the
+// first time someone asks for it.
+
+const uint32_t ROSTER_FORMAT_VERSION = 1;
+
+struct RosterHeader {
+    char magic[8];            // "PBROSTER"
+    uint32_t version;
+    uint32_t headerSize;      // sizeof(RosterHeader), so later versions can grow it
+    uint32_t characterCount;
+    uint32_t passiveCount;
+    uint32_t indexBuckets;    // Power of two, at least twice characterCount
+    uint32_t reserved;
+    uint64_t recordsOffset;
+    uint64_t passivesOffset;
+    uint64_t indexOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+};
+
+struct RosterRecord {
+    uint32_t nameOffset;      // Into the string pool
+    uint16_t nameLength;
+    uint8_t type;             // CharacterType
+    uint8_t passiveCount;
+    int32_t maxHp;
+    int32_t rock;
+    int32_t paper;
+    int32_t scissors;
+    uint32_t firstPassive;
+};
+
+struct RosterPassive {
+    uint8_t trigger;          // PassiveTrigger
+    uint8_t effect;           // PassiveEffect
+    uint16_t reserved;
+    int32_t value;
+    int32_t threshold;
+};
+
+struct RosterIndexSlot {
+    uint32_t hash;            // Low 32 bits of rosterNameHash, checked before the name
+    uint32_t record;          // Record index + 1; 0 = empty
+};
+
+static_assert(sizeof(RosterHeader) == 80, "RosterHeader layout is part of the file format");
+static_assert(sizeof(RosterRecord) == 28, "RosterRecord layout is part of the file format");
+static_assert(sizeof(RosterPassive) == 12, "RosterPassive layout is part of the file format");
+static_assert(sizeof(RosterIndexSlot) == 8, "RosterIndexSlot layout is part of the file format");
+
+// FNV-1a over the name bytes; the index stores the low 32 bits
+uint64_t rosterNameHash(std::string_view name);
+
+// A mapped roster file. Immutable once open, so it can be shared between threads.
+class RosterFile {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    // nullptr (with the reason on cerr) if the file is missing, truncated or
+    // not a roster this build understands
+    static std::shared_ptr<const RosterFile> open(const std::string& path);
+    ~RosterFile();
+
+    RosterFile(const RosterFile&) = delete;
+    RosterFile& operator=(const RosterFile&) = delete;
+
+    const std::string& getPath() const { return path; }
+    uint32_t size() const { return header->characterCount; }
+    const RosterHeader& getHeader() const { return *header; }
+
+    const RosterRecord& record(uint32_t index) const { return records[index]; }
+    std::string_view name(uint32_t index) const {
+        return std::string_view(strings + records[index].nameOffset, records[index].nameLength);
+    }
+    Passive passive(uint32_t index, uint32_t n) const;
+
+    uint32_t find(std::string_view name) const; // NOT_FOUND if absent
+    std::unique_ptr<Character> load(uint32_t index) const;
+
+private:
+    RosterFile() = default;
+
+    std::string path;
+    const unsigned char* base = nullptr;
+    size_t mappedSize = 0;
+    void* mappingHandle = nullptr; // Windows only
+
+    const RosterHeader* header = nullptr;
+    const RosterRecord* records = nullptr;
+    const RosterPassive* passives = nullptr;
+    const RosterIndexSlot* index = nullptr;
+    const char* strings = nullptr;
+
+    bool validate();
+};
+
+// Builds a roster file in memory and writes it in one go. Names must be unique;
+// add() refuses duplicates so converters can report them.
+class RosterWriter {
+public:
+    bool add(const Character& character);
+    bool add(const RosterFile& file, uint32_t index);
+
+    size_t size() const { return records.size(); }
+
+    // Replaces path, synced to disk before returning. Write to a temporary
+    // name and rename it into place (replaceFileDurably) when a reader may
+    // have the old file open.
+    bool write(const std::string& path) const;
+
+private:
+    std::vector<RosterRecord> records;
+    std::vector<RosterPassive> passives;
+    std::string strings;
+    std::unordered_set<std::string> names;
+
+    bool addRecord(std::string_view name, CharacterType type, int hp, int rock, int paper, int scissors);
+    void addPassive(const Passive& p);
+};
+
+#endif // ROSTERFILE_H
@@ -0,0 +1,435 @@
+#include "ServerCommand.h"
+#include "BattleServer.h"
+#include "CharacterManager.h"
+#include "Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+    void printServeUsage() {
+        cout << "Usage: serve [options]\n"
+            << "  --socket PATH      Unix domain socket to listen on (default picbattle.sock)\n"
+            << "  --ai LEVEL         easy, hard, optimal or lookahead, for NEW without one (default hard)\n"
+            << "  --threads T        AI worker threads, 0 = all cores (default 0)\n"
+            << "  --max-sessions N   Concurrent connections before new ones are refused (default 10000)\n"
+            << "  --max-rounds N     Rounds before a battle ends at the round limit (default 1000)\n"
+            << "  --seed N           Seed for the sessions' RNGs, 0 = random (default 0)\n"
+            << "Stops on Ctrl+C or SIGTERM. Try it with \"connect\".\n";
+    }
+
+    void printConnectUsage() {
+        cout << "Usage: connect [options]\n"
+            << "  --socket PATH      Server socket (default picbattle.sock)\n"
+            << "  --sessions N       Connections held open at once (default 100)\n"
+            << "  --battles N        Battles per session (default 1)\n"
+            << "  --player ID        Fighter to play, or random (default random)\n"
+            << "  --bot ID           Opponent, or random (default random)\n"
+            << "  --ai LEVEL         Opponent AI; the server's default if not given\n"
+            << "  --seed N           Seed for fighter picks and moves (default 1)\n"
+            << "  --timeout S        Give up after S seconds (default 60)\n"
+            << "Fighter IDs are the server's roster positions, counted from 0.\n";
+    }
+
+    bool validDifficulty(const string& s) {
+        return s == "easy" || s == "hard" || s == "optimal" || s == "lookahead";
+    }
+
+    // "random" or a roster position; -1 = random
+    bool parseFighter(const string& s, long long& out) {
+        if (s == "random") { out = -1; return true; }
+        size_t used = 0;
+        out = stoll(s, &used);
+        return used == s.size() && out >= 0;
+    }
+}
+
+int runServeCommand(int argc, char* argv[]) {
+    ServerOptions options;
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printServeUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--socket") options.socketPath = value;
+            else if (opt == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (opt == "--max-sessions") options.maxSessions = stoull(value);
+            else if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--ai") {
+                ok = validDifficulty(value);
+                if (value == "easy") options.difficulty = AIDifficulty::EASY;
+                else if (value == "optimal") options.difficulty = AIDifficulty::OPTIMAL;
+                else if (value == "lookahead") options.difficulty = AIDifficulty::LOOKAHEAD;
+                else options.difficulty = AIDifficulty::HARD;
+            }
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.maxRounds < 1 || options.maxSessions < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printServeUsage();
+            return 1;
+        }
+    }
+
+    loadCharacters();
+    if (availableCharacters.empty()) {
+        cerr << "Error: No characters available to fight with." << endl;
+        return 1;
+    }
+
+    BattleServer server(options);
+    if (!server.start()) return 1;
+    cout << "Serving " << availableCharacters.size() << " fighters on " << options.socketPath
+        << " (AI " << difficultyName(options.difficulty) << "). Ctrl+C stops." << endl;
+    int status = server.run();
+
+    const ServerStats& stats = server.stats();
+    cout << "Connections:  " << stats.connections << " (peak " << stats.peakSessions << " at once, "
+        << stats.refused << " refused)\n"
+        << "Battles:      " << stats.battles << "\n"
+        << "Rounds:       " << stats.rounds << endl;
+    return status;
+}
+
+#if defined(__linux__)
+
+namespace {
+    struct ClientSession {
+        int fd = -1;
+        string in;
+        string out;
+        bool watchingWrites = false;
+        int battlesLeft = 0;
+        Rng rng;
+        chrono::steady_clock::time_point moveSent;
+    };
+
+    struct ClientTally {
+        long long battles = 0;
+        long long outcomes[4] = { 0, 0, 0, 0 }; // WIN, LOSS, DRAW, LIMIT
+        long long rounds = 0;
+        long long finished = 0;                 // Sessions that got their BYE
+        long long errors = 0;
+        vector<double> roundTripsUs;            // MOVE sent to ROUND received
+    };
+
+    const int K_MAX_REPORTED_ERRORS = 5;
+
+    int connectTo(const string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) return -1;
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Reads up to and including the next '\n' on a blocking socket
+    bool readLine(int fd, string& line) {
+        line.clear();
+        char c;
+        while (::read(fd, &c, 1) == 1) {
+            if (c == '\n') return true;
+            line += c;
+        }
+        return false;
+    }
+
+    // Roster size, from a LIST that asks for no entries
+    long long fetchRosterSize(const string& path) {
+        int fd = connectTo(path);
+        if (fd < 0) return -1;
+        string hello, reply;
+        const char K_LIST[] = "LIST 0 0\nQUIT\n";
+        long long size = -1;
+        if (readLine(fd, hello) && ::write(fd, K_LIST, sizeof(K_LIST) - 1) == static_cast<ssize_t>(sizeof(K_LIST) - 1)
+            && readLine(fd, reply) && reply.compare(0, 11, "FIGHTERS 0 ") == 0) {
+            size = stoll(reply.substr(11));
+        }
+        ::close(fd);
+        return size;
+    }
+
+    class LoadClient {
+    public:
+        LoadClient(string path, long long player, long long bot, string ai, long long rosterSize)
+            : path(std::move(path)), player(player), bot(bot), ai(std::move(ai)), rosterSize(rosterSize) {}
+
+        ~LoadClient() {
+            for (auto& s : sessions) {
+                if (s.fd >= 0) ::close(s.fd);
+            }
+            if (epollFd >= 0) ::close(epollFd);
+        }
+
+        bool open(long long count, int battles, uint64_t seed) {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd < 0) return false;
+            const Rng root(seed);
+            sessions.resize(static_cast<size_t>(count));
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                ClientSession& s = sessions[i];
+                s.fd = connectTo(path);
+                if (s.fd < 0) {
+                    cerr << "Error: session " << i << " could not connect to " << path << ": " << strerror(errno) << endl;
+                    return false;
+                }
+                fcntl(s.fd, F_SETFL, fcntl(s.fd, F_GETFL) | O_NONBLOCK);
+                s.battlesLeft = battles;
+                s.rng = root.fork(i);
+                epoll_event ev{};
+                ev.events = EPOLLIN | EPOLLRDHUP;
+                ev.data.u64 = i;
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, s.fd, &ev) != 0) return false;
+                ++open_;
+            }
+            return true;
+        }
+
+        // Until every session has said goodbye or the deadline passes; true if all did
+        bool run(double timeoutSeconds) {
+            auto deadline = chrono::steady_clock::now() + chrono::duration<double>(timeoutSeconds);
+            vector<epoll_event> events(512);
+            while (open_ > 0) {
+                auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    cerr << "Error: " << open_ << " sessions still open after " << timeoutSeconds << " s." << endl;
+                    return false;
+                }
+                int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), static_cast<int>(min<long long>(left, 1000)));
+                if (n < 0 && errno != EINTR) return false;
+                for (int i = 0; i < n; ++i) {
+                    ClientSession& s = sessions[events[i].data.u64];
+                    if (s.fd < 0) continue;
+                    if (events[i].events & EPOLLOUT) flush(s);
+                    else readServer(s);
+                }
+            }
+            return tally.finished == static_cast<long long>(sessions.size());
+        }
+
+        const ClientTally& result() const { return tally; }
+
+    private:
+        string path;
+        long long player;
+        long long bot;
+        string ai;
+        long long rosterSize;
+        int epollFd = -1;
+        vector<ClientSession> sessions;
+        long long open_ = 0;
+        ClientTally tally;
+
+        void hangUp(ClientSession& s) {
+            ::close(s.fd);
+            s.fd = -1;
+            --open_;
+        }
+
+        void send(ClientSession& s, const string& line) {
+            s.out += line;
+            s.out += '\n';
+            flush(s);
+        }
+
+        void flush(ClientSession& s) {
+            while (!s.out.empty()) {
+                ssize_t n = ::send(s.fd, s.out.data(), s.out.size(), MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0 && errno == EAGAIN) break;
+                if (n <= 0) {
+                    hangUp(s);
+                    return;
+                }
+                s.out.erase(0, static_cast<size_t>(n));
+            }
+            bool wantWrites = !s.out.empty();
+            if (wantWrites != s.watchingWrites) {
+                s.watchingWrites = wantWrites;
+                epoll_event ev{};
+                ev.events = (wantWrites ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP;
+                ev.data.u64 = static_cast<uint64_t>(&s - sessions.data());
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, s.fd, &ev);
+            }
+        }
+
+        void reportError(ClientSession& s, const string& what) {
+            if (++tally.errors <= K_MAX_REPORTED_ERRORS) {
+                cerr << "Error: session " << (&s - sessions.data()) << ": " << what << endl;
+            }
+            hangUp(s);
+        }
+
+        long long pick(long long fixed, ClientSession& s) {
+            return fixed >= 0 ? fixed : s.rng.nextInt(0, static_cast<int>(rosterSize) - 1);
+        }
+
+        void startBattle(ClientSession& s) {
+            string line = "NEW " + to_string(pick(player, s)) + " " + (bot >= 0 ? to_string(bot) : "-");
+            if (!ai.empty()) line += " " + ai;
+            send(s, line);
+        }
+
+        void readServer(ClientSession& s) {
+            char buffer[4096];
+            ssize_t n = ::read(s.fd, buffer, sizeof(buffer));
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+            if (n <= 0) {
+                reportError(s, "server hung up");
+                return;
+            }
+            s.in.append(buffer, static_cast<size_t>(n));
+            size_t start = 0, end;
+            while (s.fd >= 0 && (end = s.in.find('\n', start)) != string::npos) {
+                handleLine(s, s.in.substr(start, end - start));
+                start = end + 1;
+            }
+            if (s.fd >= 0) s.in.erase(0, start);
+        }
+
+        void handleLine(ClientSession& s, const string& line) {
+            if (line.compare(0, 5, "TURN ") == 0) {
+                s.moveSent = chrono::steady_clock::now();
+                send(s, string("MOVE ") + "RPS"[s.rng.nextInt(0, 2)]);
+            }
+            else if (line.compare(0, 6, "ROUND ") == 0) {
+                ++tally.rounds;
+                tally.roundTripsUs.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - s.moveSent).count());
+            }
+            else if (line.compare(0, 4, "END ") == 0) {
+                string outcome = line.substr(4, line.find(' ', 4) - 4);
+                int index = outcome == "WIN" ? 0 : outcome == "LOSS" ? 1 : outcome == "DRAW" ? 2 : 3;
+                ++tally.outcomes[index];
+                ++tally.battles;
+                if (--s.battlesLeft > 0) startBattle(s);
+                else send(s, "QUIT");
+            }
+            else if (line.compare(0, 6, "HELLO ") == 0) startBattle(s);
+            else if (line == "BYE") {
+                ++tally.finished;
+                hangUp(s);
+            }
+            else if (line.compare(0, 7, "BATTLE ") != 0) reportError(s, line);
+        }
+    };
+
+    double percentile(const vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[min(index, sorted.size() - 1)];
+    }
+}
+
+int runConnectCommand(int argc, char* argv[]) {
+    string socketPath = "picbattle.sock";
+    long long sessionCount = 100;
+    int battles = 1;
+    long long player = -1, bot = -1;
+    string ai;
+    uint64_t seed = 1;
+    double timeoutSeconds = 60.0;
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printConnectUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--socket") socketPath = value;
+            else if (opt == "--sessions") sessionCount = stoll(value);
+            else if (opt == "--battles") battles = stoi(value);
+            else if (opt == "--player") ok = parseFighter(value, player);
+            else if (opt == "--bot") ok = parseFighter(value, bot);
+            else if (opt == "--ai") { ai = value; ok = validDifficulty(value); }
+            else if (opt == "--seed") seed = stoull(value);
+            else if (opt == "--timeout") timeoutSeconds = stod(value);
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || sessionCount < 1 || battles < 1 || timeoutSeconds <= 0) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printConnectUsage();
+            return 1;
+        }
+    }
+
+    size_t limit = raiseOpenFileLimit();
+    if (limit < static_cast<size_t>(sessionCount) + 16) {
+        cerr << "Error: " << sessionCount << " sessions need more than the " << limit << " file descriptors allowed." << endl;
+        return 1;
+    }
+    long long rosterSize = fetchRosterSize(socketPath);
+    if (rosterSize < 1) {
+        cerr << "Error: no battle server answering on " << socketPath << "." << endl;
+        return 1;
+    }
+    if (player >= rosterSize || bot >= rosterSize) {
+        cerr << "Error: the server has fighters 0-" << rosterSize - 1 << "." << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    LoadClient client(socketPath, player, bot, ai, rosterSize);
+    bool opened = client.open(sessionCount, battles, seed);
+    auto connected = chrono::steady_clock::now();
+    bool finished = opened && client.run(timeoutSeconds);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const ClientTally& tally = client.result();
+    vector<double> trips = tally.roundTripsUs;
+    sort(trips.begin(), trips.end());
+    cout << "Sessions:     " << tally.finished << " of " << sessionCount << " finished (connected in "
+        << chrono::duration<double, milli>(connected - start).count() << " ms)\n"
+        << "Battles:      " << tally.battles << " (" << tally.outcomes[0] << " won, " << tally.outcomes[1] << " lost, "
+        << tally.outcomes[2] << " double K.O., " << tally.outcomes[3] << " at the round limit)\n"
+        << "Rounds:       " << tally.rounds << " (" << (seconds > 0 ? tally.rounds / seconds : 0.0) << " per second)\n"
+        << "Round trip:   p50 " << percentile(trips, 0.5) << " us, p99 " << percentile(trips, 0.99)
+        << " us, max " << percentile(trips, 1.0) << " us\n"
+        << "Time:         " << seconds << " s" << endl;
+    if (tally.errors > 0) cerr << tally.errors << " sessions failed." << endl;
+    return finished && tally.errors == 0 ? 0 : 1;
+}
+
+#else
+
+int runConnectCommand(int, char*[]) {
+    cerr << "Error: connect needs Linux (epoll and Unix domain sockets)." << endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef SERVERCOMMAND_H
+#define SERVERCOMMAND_H
+
+// Entry point for "serve": hosts battles for many clients over a Unix domain
+// socket (see BattleServer.h for the protocol) until interrupted
+int runServeCommand(int argc, char* argv[]);
+
+// Entry point for "connect": a stand-in for many clients at once. Opens the
+// given number of sessions, plays every battle with random moves, and reports
+// outcomes, throughput and move round-trip times (exit code 1 on any
+// protocol error or dropped session)
+int runConnectCommand(int argc, char* argv[]);
+
+#endif // SERVERCOMMAND_H
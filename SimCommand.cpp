@@ -0,0 +1,806 @@
+#include "SimCommand.h"
+#include "BattleEngine.h"
+#include "BatchBattle.h"
+#include "MatchupMatrix.h"
+#include "MatchupSolver.h"
+#include "GauntletSim.h"
+#include "ReplayLog.h"
+#include "Tournament.h"
+#include "BuildOptimizer.h"
+#include "Rng.h"
+#include "CharacterManager.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+    void printSimUsage() {
+        cout << "Usage: sim <player> <bot> [options]\n"
+            << "  --battles N        Number of battles to run (default 10000)\n"
+            << "  --seed S           Base seed; battle i uses stream i of it (default 1)\n"
+            << "  --max-rounds N     Rounds before a battle is called a draw (default " << BattleEngine::DEFAULT_MAX_ROUNDS << ")\n"
+            << "  --player-ai easy|hard|optimal|lookahead|random\n"
+            << "  --bot-ai easy|hard|optimal|lookahead|random\n"
+            << "  --player-script MOVES   e.g. RPSS; replaces the player's AI\n"
+            << "  --bot-script MOVES      e.g. PPR; replaces the bot's AI\n"
+            << "  --engine scalar|batch|verify\n"
+            << "                     batch runs lanes through the SIMD kernel (random/script\n"
+            << "                     policies only); verify runs both and compares (default scalar)\n"
+            << "  --record FILE      Append every battle to a replay log (scalar engine only)\n";
+    }
+
+    void printMatrixUsage() {
+        cout << "Usage: matrix [options]\n"
+            << "  --samples N        Battles per ordered pair (default 1000)\n"
+            << "  --seed S           Base seed (default 1)\n"
+            << "  --threads T        Worker threads, 0 = all cores (default 0)\n"
+            << "  --ai easy|hard|optimal|lookahead|random  Policy used by both sides (default hard)\n"
+            << "  --max-rounds N     Rounds before a battle is called a draw (default " << BattleEngine::DEFAULT_MAX_ROUNDS << ")\n"
+            << "  --out FILE         Write every cell as CSV\n";
+    }
+
+    void printSolveUsage() {
+        cout << "Usage: solve <player> <bot> [options]\n"
+            << "  --player-ai easy|hard|optimal|lookahead|random\n"
+            << "  --bot-ai easy|hard|optimal|lookahead|random\n"
+            << "  --player-script MOVES   e.g. RPSS; replaces the player's AI\n"
+            << "  --bot-script MOVES      e.g. PPR; replaces the bot's AI\n"
+            << "  --max-rounds N     Rounds before a battle is called a draw (default " << BattleEngine::DEFAULT_MAX_ROUNDS << ")\n"
+            << "  --max-states N     Reachable states before falling back to sampling (default " << SolverOptions().maxStates << ")\n"
+            << "  --samples N        Battles played by the fallback (default " << SolverOptions().samples << ")\n"
+            << "  --seed S           Fallback seed (default 1)\n";
+    }
+
+    void printGauntletUsage() {
+        GauntletOptions defaults;
+        cout << "Usage: gauntlet [options]\n"
+            << "  --runs N           Full runs per fighter (default " << defaults.runs << ")\n"
+            << "  --seed S           Base seed (default 1)\n"
+            << "  --threads T        Worker threads, 0 = all cores (default 0)\n"
+            << "  --opponents N      Battles in a run (default " << defaults.opponents << ")\n"
+            << "  --heal P           Percent of max HP restored between battles (default " << defaults.healPercent << ")\n"
+            << "  --player-ai easy|hard|optimal|lookahead|random  (default optimal)\n"
+            << "  --opponent-ai easy|hard|optimal|lookahead|random  (default hard, as in the game)\n"
+            << "  --max-rounds N     Rounds before a battle counts as a loss (default " << BattleEngine::DEFAULT_MAX_ROUNDS << ")\n"
+            << "  --fighters A,B,... Fighters to run (default: every unlockable one)\n"
+            << "  --out FILE         Write every (fighter, round) as CSV\n";
+    }
+
+    void printTournamentUsage() {
+        TournamentOptions defaults;
+        cout << "Usage: tournament [options]\n"
+            << "  --format swiss|round-robin|elimination  (default swiss)\n"
+            << "  --best-of N        Battles per series; stops at a majority (default " << defaults.bestOf << ")\n"
+            << "  --rounds N         Swiss rounds, 0 = ceil(log2 entrants) (default 0)\n"
+            << "  --entrants N       Only the first N roster characters, 0 = all (default 0)\n"
+            << "  --ai easy|hard|optimal|lookahead|random  Policy used by every entrant (default hard)\n"
+            << "  --seed S           Base seed (default 1)\n"
+            << "  --threads T        Worker threads, 0 = all cores (default 0)\n"
+            << "  --max-rounds N     Rounds before a battle is called a draw (default " << BattleEngine::DEFAULT_MAX_ROUNDS << ")\n"
+            << "  --ratings FILE     Ratings to start from, if it exists; updated ratings are written back\n"
+            << "  --top N            Standings printed (default 20)\n"
+            << "  --out FILE         Write the full standings as CSV\n";
+    }
+
+    void printEvolveUsage() {
+        OptimizerOptions defaults;
+        cout << "Usage: evolve [options]\n"
+            << "  --population N     Builds per generation (default " << defaults.population << ")\n"
+            << "  --generations N    (default " << defaults.generations << ")\n"
+            << "  --opponents N      Score against the first N roster characters, 0 = all (default 0)\n"
+            << "  --ai easy|hard|optimal|lookahead|random  Policy on both sides (default hard)\n"
+            << "  --max-rounds N     Rounds before a battle is called a draw (default " << defaults.maxRounds << ")\n"
+            << "  --mutation P       Chance each gene of a child mutates (default " << defaults.mutationRate << ")\n"
+            << "  --seed S           (default 1)\n"
+            << "  --threads T        Worker threads, 0 = all cores (default 0)\n"
+            << "  --top N            Pareto-best builds printed (default 10)\n"
+            << "  --out FILE         Append the Pareto-best builds to FILE in the character save format\n";
+    }
+
+    // Rosters larger than this only get the CSV, not the console table
+    const size_t K_MAX_PRINTED_MATRIX = 12;
+
+    // Battles per BatchBattle; keeps the columns in cache
+    const size_t K_BATCH_LANES = 4096;
+
+    const Character* findCharacter(const string& name) {
+        return availableCharacters.find(name);
+    }
+
+    bool parseDifficulty(const string& s, AIDifficulty& out) {
+        if (s == "easy") { out = AIDifficulty::EASY; return true; }
+        if (s == "hard") { out = AIDifficulty::HARD; return true; }
+        if (s == "optimal") { out = AIDifficulty::OPTIMAL; return true; }
+        if (s == "lookahead") { out = AIDifficulty::LOOKAHEAD; return true; }
+        return false;
+    }
+
+    // "easy", "hard", "optimal", "lookahead" or "random" (uniform moves)
+    bool parsePolicy(const string& s, MovePolicy& out) {
+        if (s == "random") { out = MovePolicy::random(); return true; }
+        AIDifficulty difficulty;
+        if (!parseDifficulty(s, difficulty)) return false;
+        out = MovePolicy::ai(difficulty);
+        return true;
+    }
+
+    bool parseScript(const string& s, vector<int>& out) {
+        out.clear();
+        for (char c : s) {
+            switch (c) {
+            case 'R': case 'r': out.push_back(1); break;
+            case 'P': case 'p': out.push_back(2); break;
+            case 'S': case 's': out.push_back(3); break;
+            default: return false;
+            }
+        }
+        return !out.empty();
+    }
+}
+
+int runSimCommand(int argc, char* argv[]) {
+    if (argc < 2) {
+        printSimUsage();
+        return 1;
+    }
+
+    string playerName = argv[0];
+    string botName = argv[1];
+    long long battles = 10000;
+    uint64_t seed = 1;
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS;
+    MovePolicy playerPolicy = MovePolicy::ai(AIDifficulty::HARD);
+    MovePolicy botPolicy = MovePolicy::ai(AIDifficulty::HARD);
+    string engine = "scalar";
+    string recordPath;
+
+    for (int i = 2; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printSimUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--battles") battles = stoll(value);
+            else if (opt == "--seed") seed = stoull(value);
+            else if (opt == "--max-rounds") maxRounds = stoi(value);
+            else if (opt == "--player-ai") ok = parsePolicy(value, playerPolicy);
+            else if (opt == "--bot-ai") ok = parsePolicy(value, botPolicy);
+            else if (opt == "--player-script") {
+                vector<int> moves;
+                ok = parseScript(value, moves);
+                if (ok) playerPolicy = MovePolicy::scripted(moves);
+            }
+            else if (opt == "--bot-script") {
+                vector<int> moves;
+                ok = parseScript(value, moves);
+                if (ok) botPolicy = MovePolicy::scripted(moves);
+            }
+            else if (opt == "--engine") {
+                engine = value;
+                ok = (value == "scalar" || value == "batch" || value == "verify");
+            }
+            else if (opt == "--record") recordPath = value;
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || battles < 1 || maxRounds < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printSimUsage();
+            return 1;
+        }
+    }
+
+    loadCharacters();
+    const Character* player = findCharacter(playerName);
+    const Character* bot = findCharacter(botName);
+    if (!player || !bot) {
+        cerr << "Error: Unknown character '" << (player ? botName : playerName) << "'." << endl;
+        return 1;
+    }
+
+    bool useBatch = engine != "scalar";
+    if (useBatch && (playerPolicy.kind == MovePolicy::Kind::AI || botPolicy.kind == MovePolicy::Kind::AI)) {
+        cerr << "Error: --engine " << engine << " needs random or scripted policies on both sides." << endl;
+        return 1;
+    }
+    if (useBatch && !recordPath.empty()) {
+        cerr << "Error: --record needs --engine scalar." << endl;
+        return 1;
+    }
+
+    ReplayWriter recorder;
+    bool recordFailed = false;
+    if (!recordPath.empty()) {
+        if (!recorder.open(recordPath)) return 1;
+        recorder.beginSession(seed, availableCharacters);
+    }
+
+    const Rng root(seed);
+    vector<BattleResult> results(static_cast<size_t>(battles));
+
+    auto start = chrono::steady_clock::now();
+    if (useBatch) {
+        BatchBattle batch(min(K_BATCH_LANES, results.size()));
+        for (size_t first = 0; first < results.size(); first += K_BATCH_LANES) {
+            size_t count = min(K_BATCH_LANES, results.size() - first);
+            batch.clear();
+            for (size_t i = 0; i < count; ++i) {
+                batch.addBattle(*player, *bot, playerPolicy, botPolicy, root.fork(first + i).next(), maxRounds);
+            }
+            batch.runToCompletion();
+            for (size_t i = 0; i < count; ++i) results[first + i] = batch.result(i);
+        }
+    }
+    else if (recorder.isOpen()) {
+        ReplayBattle replay;
+        for (size_t i = 0; i < results.size(); ++i) {
+            replay.recordStart(*player, *bot, false, false);
+            replay.stream = i;
+            results[i] = BattleEngine::runBattle(*player, *bot, playerPolicy, botPolicy, root.fork(i).next(), maxRounds, &replay.movePairs);
+            replay.result = results[i];
+            recordFailed |= !recorder.write(replay);
+        }
+    }
+    else {
+        for (size_t i = 0; i < results.size(); ++i) {
+            results[i] = BattleEngine::runBattle(*player, *bot, playerPolicy, botPolicy, root.fork(i).next(), maxRounds);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long playerWins = 0, botWins = 0, doubleKos = 0, roundLimits = 0, totalRounds = 0;
+    for (const BattleResult& r : results) {
+        totalRounds += r.rounds;
+        switch (r.outcome) {
+        case BattleOutcome::PLAYER_WINS: ++playerWins; break;
+        case BattleOutcome::BOT_WINS: ++botWins; break;
+        case BattleOutcome::DOUBLE_KO: ++doubleKos; break;
+        case BattleOutcome::ROUND_LIMIT: ++roundLimits; break;
+        }
+    }
+
+    cout << "\n=== Simulation: " << player->getName() << " vs " << bot->getName() << " ===\n";
+    cout << "Battles:      " << battles << "\n";
+    cout << player->getName() << " wins: " << playerWins << " (" << (100.0 * playerWins / battles) << "%)\n";
+    cout << bot->getName() << " wins: " << botWins << " (" << (100.0 * botWins / battles) << "%)\n";
+    cout << "Double K.O.:  " << doubleKos << "\n";
+    cout << "Round limit:  " << roundLimits << "\n";
+    cout << "Avg rounds:   " << (static_cast<double>(totalRounds) / battles) << "\n";
+    cout << "Elapsed:      " << seconds << " s\n";
+    if (seconds > 0) {
+        cout << "Throughput:   " << static_cast<long long>(totalRounds / seconds) << " rounds/s, "
+            << static_cast<long long>(battles / seconds) << " battles/s\n";
+    }
+    if (useBatch) {
+        cout << "Engine:       batch (" << (BatchBattle::simdAvailable() ? "AVX2" : "scalar kernel") << ")\n";
+    }
+    if (recordFailed) {
+        cerr << "Error: Could not write every battle to " << recordPath << endl;
+        return 1;
+    }
+    if (recorder.isOpen()) cout << "Recorded to:  " << recordPath << "\n";
+
+    if (engine == "verify") {
+        // Replay every seed through the reference engine and compare field by field
+        long long mismatches = 0;
+        auto scalarStart = chrono::steady_clock::now();
+        for (size_t i = 0; i < results.size(); ++i) {
+            BattleResult r = BattleEngine::runBattle(*player, *bot, playerPolicy, botPolicy, root.fork(i).next(), maxRounds);
+            const BattleResult& b = results[i];
+            if (r.outcome != b.outcome || r.rounds != b.rounds || r.playerHp != b.playerHp || r.botHp != b.botHp) {
+                if (mismatches == 0) {
+                    cerr << "First mismatch at battle " << i << ": scalar " << r.rounds << " rounds "
+                        << r.playerHp << "/" << r.botHp << ", batch " << b.rounds << " rounds "
+                        << b.playerHp << "/" << b.botHp << endl;
+                }
+                ++mismatches;
+            }
+        }
+        double scalarSeconds = chrono::duration<double>(chrono::steady_clock::now() - scalarStart).count();
+        cout << "Scalar time:  " << scalarSeconds << " s\n";
+        if (seconds > 0) cout << "Speedup:      " << (scalarSeconds / seconds) << "x\n";
+        cout << "Mismatches:   " << mismatches << "\n";
+        if (mismatches > 0) return 1;
+    }
+    return 0;
+}
+
+int runMatrixCommand(int argc, char* argv[]) {
+    MatchupOptions options;
+    string outPath;
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printMatrixUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--samples") options.samples = stoi(value);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (opt == "--ai") ok = parsePolicy(value, options.policy);
+            else if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--out") outPath = value;
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.samples < 1 || options.maxRounds < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printMatrixUsage();
+            return 1;
+        }
+    }
+
+    loadCharacters();
+    vector<const Character*> roster;
+    for (const auto& ch : availableCharacters) {
+        roster.push_back(ch.get());
+    }
+
+    MatchupMatrix matrix = computeMatchupMatrix(roster, options);
+    size_t n = matrix.size();
+
+    if (n <= K_MAX_PRINTED_MATRIX) {
+        cout << "\n=== Win rate of row (player) vs column (bot), 95% CI ===\n";
+        cout << setw(10) << "";
+        for (size_t col = 0; col < n; ++col) cout << setw(20) << matrix.names[col];
+        cout << "\n";
+        cout << fixed << setprecision(1);
+        for (size_t row = 0; row < n; ++row) {
+            cout << setw(10) << matrix.names[row];
+            for (size_t col = 0; col < n; ++col) {
+                auto ci = matrix.confidenceInterval(row, col);
+                ostringstream cell;
+                cell << fixed << setprecision(1) << 100 * matrix.winRate(row, col)
+                    << " [" << 100 * ci.first << "-" << 100 * ci.second << "]";
+                cout << setw(20) << cell.str();
+            }
+            cout << "\n";
+        }
+        cout << defaultfloat << setprecision(6);
+    }
+
+    if (!outPath.empty()) {
+        ofstream out(outPath);
+        if (!out) {
+            cerr << "Error: Could not open " << outPath << " for writing!" << endl;
+            return 1;
+        }
+        out << "player,bot,wins,losses,draws,win_rate,ci_low,ci_high,avg_rounds\n";
+        for (size_t row = 0; row < n; ++row) {
+            for (size_t col = 0; col < n; ++col) {
+                const MatchupCell& c = matrix.at(row, col);
+                auto ci = matrix.confidenceInterval(row, col);
+                out << matrix.names[row] << "," << matrix.names[col] << ","
+                    << c.wins << "," << c.losses << "," << c.draws << ","
+                    << matrix.winRate(row, col) << "," << ci.first << "," << ci.second << ","
+                    << (c.battles() ? static_cast<double>(c.totalRounds) / c.battles() : 0.0) << "\n";
+            }
+        }
+        cout << "Matrix written to " << outPath << endl;
+    }
+
+    cout << "\nBattles: " << matrix.totalBattles << ", rounds: " << matrix.totalRounds
+        << ", elapsed: " << matrix.seconds << " s";
+    if (matrix.seconds > 0) {
+        cout << ", " << static_cast<long long>(matrix.totalBattles / matrix.seconds) << " battles/s";
+    }
+    cout << "\n";
+    return 0;
+}
+
+int runSolveCommand(int argc, char* argv[]) {
+    if (argc < 2) {
+        printSolveUsage();
+        return 1;
+    }
+
+    string playerName = argv[0];
+    string botName = argv[1];
+    SolverOptions options;
+    MovePolicy playerPolicy = MovePolicy::ai(AIDifficulty::HARD);
+    MovePolicy botPolicy = MovePolicy::ai(AIDifficulty::HARD);
+
+    for (int i = 2; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printSolveUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--max-states") options.maxStates = stoull(value);
+            else if (opt == "--samples") options.samples = stoi(value);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--player-ai") ok = parsePolicy(value, playerPolicy);
+            else if (opt == "--bot-ai") ok = parsePolicy(value, botPolicy);
+            else if (opt == "--player-script") {
+                vector<int> moves;
+                ok = parseScript(value, moves);
+                if (ok) playerPolicy = MovePolicy::scripted(moves);
+            }
+            else if (opt == "--bot-script") {
+                vector<int> moves;
+                ok = parseScript(value, moves);
+                if (ok) botPolicy = MovePolicy::scripted(moves);
+            }
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.maxRounds < 1 || options.samples < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printSolveUsage();
+            return 1;
+        }
+    }
+
+    loadCharacters();
+    const Character* player = findCharacter(playerName);
+    const Character* bot = findCharacter(botName);
+    if (!player || !bot) {
+        cerr << "Error: Unknown character '" << (player ? botName : playerName) << "'." << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    MatchupSolution solution = solveMatchup(*player, *bot, playerPolicy, botPolicy, options);
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+    cout << "\n=== Solution: " << player->getName() << " vs " << bot->getName() << " ===\n";
+    cout << setprecision(10);
+    cout << player->getName() << " wins: " << (100.0 * solution.playerWin) << "%\n";
+    cout << bot->getName() << " wins: " << (100.0 * solution.botWin) << "%\n";
+    cout << "Double K.O.:  " << (100.0 * solution.doubleKo) << "%\n";
+    cout << "Round limit:  " << (100.0 * solution.roundLimit) << "%\n";
+    cout << "Avg rounds:   " << solution.expectedRounds << "\n";
+    cout << setprecision(6);
+    if (solution.exact) {
+        cout << "Method:       exact (" << solution.states << " states, " << solution.sweeps << " sweeps)\n";
+    }
+    else {
+        cout << "Method:       sampled (" << options.samples << " battles; state space too large)\n";
+    }
+    cout << "Elapsed:      " << micros << " us\n";
+    return 0;
+}
+
+int runGauntletCommand(int argc, char* argv[]) {
+    GauntletOptions options;
+    string outPath;
+    vector<string> fighterNames = GauntletGame::unlockOrder();
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printGauntletUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--runs") options.runs = stoi(value);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (opt == "--opponents") options.opponents = stoi(value);
+            else if (opt == "--heal") options.healPercent = stoi(value);
+            else if (opt == "--player-ai") ok = parsePolicy(value, options.playerPolicy);
+            else if (opt == "--opponent-ai") ok = parsePolicy(value, options.opponentPolicy);
+            else if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--fighters") {
+                fighterNames.clear();
+                stringstream list(value);
+                string name;
+                while (getline(list, name, ',')) {
+                    if (!name.empty()) fighterNames.push_back(name);
+                }
+                ok = !fighterNames.empty();
+            }
+            else if (opt == "--out") outPath = value;
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.runs < 1 || options.opponents < 1 || options.healPercent < 0 || options.maxRounds < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printGauntletUsage();
+            return 1;
+        }
+    }
+
+    // Only reads the roster; unlock progress is GauntletGame's business
+    loadCharacters();
+    vector<const Character*> fighters;
+    for (const string& name : fighterNames) {
+        const Character* c = findCharacter(name);
+        if (!c) {
+            cerr << "Error: Unknown character '" << name << "'." << endl;
+            return 1;
+        }
+        fighters.push_back(c);
+    }
+
+    GauntletReport report = simulateGauntlet(fighters, options);
+
+    cout << "\n=== Gauntlet: " << options.opponents << " opponents, " << options.healPercent
+        << "% heal between battles, " << options.runs << " runs per fighter ===\n";
+    cout << fixed << setprecision(1);
+    for (const GauntletFighterStats& f : report.fighters) {
+        auto ci = wilsonInterval(f.clears, f.runs);
+        cout << "\n" << f.name << ": clears " << 100 * f.clearRate() << "% [" << 100 * ci.first << "-" << 100 * ci.second << "]";
+        int deadliest = f.deadliestRound();
+        if (deadliest >= 0) cout << ", most runs end in round " << (deadliest + 1);
+        cout << "\n";
+        cout << setw(8) << "Round" << setw(10) << "Reached" << setw(10) << "Died" << setw(8) << "Die %"
+            << setw(8) << "Stalls" << setw(10) << "HP in" << setw(8) << "HP %" << "\n";
+        for (size_t round = 0; round < f.reached.size(); ++round) {
+            cout << setw(8) << (round + 1) << setw(10) << f.reached[round] << setw(10) << f.deaths[round]
+                << setw(8) << 100 * f.deathRate(round) << setw(8) << f.stalls[round]
+                << setw(10) << f.averageHpInto(round) << setw(8) << 100 * f.hpFractionInto(round) << "\n";
+        }
+    }
+    cout << defaultfloat << setprecision(6);
+
+    if (!outPath.empty()) {
+        ofstream out(outPath);
+        if (!out) {
+            cerr << "Error: Could not open " << outPath << " for writing!" << endl;
+            return 1;
+        }
+        out << "fighter,runs,clears,clear_rate,round,reached,deaths,stalls,death_rate,avg_hp_in,hp_fraction_in\n";
+        for (const GauntletFighterStats& f : report.fighters) {
+            for (size_t round = 0; round < f.reached.size(); ++round) {
+                out << f.name << "," << f.runs << "," << f.clears << "," << f.clearRate() << ","
+                    << (round + 1) << "," << f.reached[round] << "," << f.deaths[round] << "," << f.stalls[round] << ","
+                    << f.deathRate(round) << "," << f.averageHpInto(round) << "," << f.hpFractionInto(round) << "\n";
+            }
+        }
+        cout << "Gauntlet results written to " << outPath << endl;
+    }
+
+    cout << "\nRuns: " << report.totalRuns << ", battles: " << report.totalBattles
+        << ", elapsed: " << report.seconds << " s";
+    if (report.seconds > 0) {
+        cout << ", " << static_cast<long long>(report.totalRuns / report.seconds) << " runs/s";
+    }
+    cout << "\n";
+    return 0;
+}
+
+int runTournamentCommand(int argc, char* argv[]) {
+    TournamentOptions options;
+    options.verbose = true;
+    size_t entrantLimit = 0;
+    size_t top = 20;
+    string ratingsPath;
+    string outPath;
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printTournamentUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--format") ok = parseTournamentFormat(value, options.format);
+            else if (opt == "--best-of") options.bestOf = stoi(value);
+            else if (opt == "--rounds") options.swissRounds = stoi(value);
+            else if (opt == "--entrants") entrantLimit = stoull(value);
+            else if (opt == "--ai") ok = parsePolicy(value, options.policy);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--ratings") ratingsPath = value;
+            else if (opt == "--top") top = stoull(value);
+            else if (opt == "--out") outPath = value;
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.bestOf < 1 || options.swissRounds < 0 || options.maxRounds < 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printTournamentUsage();
+            return 1;
+        }
+    }
+
+    // The registry loads lazily and is single-threaded: resolve everyone before the workers start
+    loadCharacters();
+    vector<const Character*> fighters;
+    size_t count = entrantLimit ? min(entrantLimit, availableCharacters.size()) : availableCharacters.size();
+    for (CharacterId id = 0; id < count; ++id) {
+        fighters.push_back(availableCharacters[id].get());
+    }
+    if (fighters.size() < 2) {
+        cerr << "Error: A tournament needs at least two characters." << endl;
+        return 1;
+    }
+
+    vector<NamedRating> saved;
+    if (!ratingsPath.empty() && readRatingsFile(ratingsPath, saved)) {
+        cout << "Loaded " << saved.size() << " ratings from " << ratingsPath << endl;
+    }
+    unordered_map<string, size_t> savedIndex;
+    for (size_t i = 0; i < saved.size(); ++i) savedIndex[saved[i].name] = i;
+    vector<Rating> ratings(fighters.size());
+    for (size_t i = 0; i < fighters.size(); ++i) {
+        auto found = savedIndex.find(fighters[i]->getName());
+        if (found != savedIndex.end()) ratings[i] = saved[found->second].rating;
+    }
+
+    cout << "\n=== " << tournamentFormatName(options.format) << " tournament: " << fighters.size()
+        << " entrants, best of " << options.bestOf << " ===\n";
+    TournamentReport report = runTournament(fighters, ratings, options);
+
+    bool elimination = options.format == TournamentFormat::SINGLE_ELIMINATION;
+    cout << "\n" << setw(6) << "Rank" << setw(20) << "Name" << setw(8) << (elimination ? "Round" : "Points")
+        << setw(12) << "W-D-L" << setw(10) << "Buchholz" << setw(8) << "Elo" << setw(8) << "Glicko" << setw(6) << "RD" << "\n";
+    cout << fixed;
+    for (size_t rank = 0; rank < report.standings.size() && rank < top; ++rank) {
+        const TournamentStanding& s = report.standings[rank];
+        string record = to_string(s.seriesWon) + "-" + to_string(s.seriesDrawn) + "-" + to_string(s.seriesLost);
+        cout << setw(6) << (rank + 1) << setw(20) << s.name << setprecision(1)
+            << setw(8) << (elimination ? static_cast<double>(s.roundReached) : s.points) << setw(12) << record
+            << setw(10) << s.buchholz << setprecision(0) << setw(8) << s.rating.elo << setw(8) << s.rating.glicko
+            << setw(6) << s.rating.deviation << "\n";
+    }
+    cout << defaultfloat << setprecision(6);
+
+    if (!outPath.empty()) {
+        ofstream out(outPath);
+        if (!out) {
+            cerr << "Error: Could not open " << outPath << " for writing!" << endl;
+            return 1;
+        }
+        out << "rank,name,points,won,drawn,lost,byes,buchholz,round_reached,elo,glicko,deviation,volatility\n";
+        for (size_t rank = 0; rank < report.standings.size(); ++rank) {
+            const TournamentStanding& s = report.standings[rank];
+            out << (rank + 1) << "," << s.name << "," << s.points << "," << s.seriesWon << "," << s.seriesDrawn << ","
+                << s.seriesLost << "," << s.byes << "," << s.buchholz << "," << s.roundReached << ","
+                << s.rating.elo << "," << s.rating.glicko << "," << s.rating.deviation << "," << s.rating.volatility << "\n";
+        }
+        cout << "Standings written to " << outPath << endl;
+    }
+
+    if (!ratingsPath.empty()) {
+        // Entrants not in this tournament keep their saved ratings
+        for (size_t i = 0; i < fighters.size(); ++i) {
+            auto found = savedIndex.find(fighters[i]->getName());
+            if (found != savedIndex.end()) saved[found->second].rating = ratings[i];
+            else saved.push_back(NamedRating{ fighters[i]->getName(), ratings[i] });
+        }
+        if (!writeRatingsFile(ratingsPath, saved)) return 1;
+        cout << "Ratings written to " << ratingsPath << endl;
+    }
+
+    cout << "\nRounds: " << report.rounds << ", series: " << report.series << ", battles: " << report.battles
+        << ", elapsed: " << report.seconds << " s";
+    if (report.seconds > 0) {
+        cout << ", " << static_cast<long long>(report.battles / report.seconds) << " battles/s";
+    }
+    cout << "\n";
+    return 0;
+}
+
+int runEvolveCommand(int argc, char* argv[]) {
+    OptimizerOptions options;
+    options.verbose = true;
+    size_t opponentLimit = 0;
+    size_t top = 10;
+    string outPath;
+
+    for (int i = 0; i < argc; ++i) {
+        string opt = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << opt << endl;
+            printEvolveUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        try {
+            if (opt == "--population") options.population = stoi(value);
+            else if (opt == "--generations") options.generations = stoi(value);
+            else if (opt == "--opponents") opponentLimit = stoull(value);
+            else if (opt == "--ai") ok = parsePolicy(value, options.policy);
+            else if (opt == "--max-rounds") options.maxRounds = stoi(value);
+            else if (opt == "--mutation") options.mutationRate = stod(value);
+            else if (opt == "--seed") options.seed = stoull(value);
+            else if (opt == "--threads") options.threads = static_cast<unsigned>(stoul(value));
+            else if (opt == "--top") top = stoull(value);
+            else if (opt == "--out") outPath = value;
+            else ok = false;
+        }
+        catch (...) {
+            ok = false;
+        }
+        if (!ok || options.population < 2 || options.generations < 0 || options.maxRounds < 1
+            || options.mutationRate < 0 || options.mutationRate > 1) {
+            cerr << "Invalid option: " << opt << " " << value << endl;
+            printEvolveUsage();
+            return 1;
+        }
+    }
+
+    // The registry loads lazily and is single-threaded: resolve everyone before the workers start
+    loadCharacters();
+    vector<const Character*> opponents;
+    size_t count = opponentLimit ? min(opponentLimit, availableCharacters.size()) : availableCharacters.size();
+    for (CharacterId id = 0; id < count; ++id) {
+        opponents.push_back(availableCharacters[id].get());
+    }
+    if (opponents.empty()) {
+        cerr << "Error: No characters to score builds against." << endl;
+        return 1;
+    }
+
+    cout << "\n=== Evolving " << options.population << " builds over " << options.generations
+        << " generations against " << opponents.size() << " opponents ===\n";
+    OptimizerReport report = evolveBuilds(opponents, options);
+
+    cout << "\nPareto-best builds (" << report.front.size() << "):\n"
+        << setw(6) << "Rank" << setw(8) << "Mean" << setw(8) << "Worst" << setw(8) << "Budget"
+        << setw(6) << "HP" << setw(10) << "R/P/S" << "  Passives\n";
+    cout << fixed << setprecision(3);
+    for (size_t rank = 0; rank < report.front.size() && rank < top; ++rank) {
+        const EvolvedBuild& e = report.front[rank];
+        string damages = to_string(e.build.rock) + "/" + to_string(e.build.paper) + "/" + to_string(e.build.scissors);
+        cout << setw(6) << (rank + 1) << setw(8) << e.fitness.meanWinRate << setw(8) << e.fitness.worstWinRate
+            << setw(8) << e.fitness.statBudget << setw(6) << e.build.hp << setw(10) << damages << "  ";
+        if (e.build.passives.empty()) cout << "none";
+        for (size_t p = 0; p < e.build.passives.size(); ++p) {
+            cout << (p ? " " : "") << e.build.passives[p].getDescription();
+        }
+        if (!e.fitness.exact) cout << " (sampled)";
+        cout << "\n";
+    }
+    cout << defaultfloat << setprecision(6);
+
+    if (!outPath.empty()) {
+        ofstream out(outPath, ios::app);
+        if (!out) {
+            cerr << "Error: Could not open " << outPath << " for writing!" << endl;
+            return 1;
+        }
+        for (size_t rank = 0; rank < report.front.size() && rank < top; ++rank) {
+            writeCharacterLine(out, *report.front[rank].build.toCharacter("Evolved" + to_string(rank + 1)));
+            out << '\n';
+        }
+        cout << "Builds written to " << outPath << endl;
+    }
+
+    cout << "\nGenerations: " << report.generations << ", builds scored: " << report.evaluations
+        << ", matchups solved: " << report.matchups << ", elapsed: " << report.seconds << " s\n";
+    return 0;
+}
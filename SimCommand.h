@@ -0,0 +1,23 @@
+#ifndef SIMCOMMAND_H
+#define SIMCOMMAND_H
+
+// Entry point for "sim": runs headless battles between two roster characters.
+// args excludes the program name and the "sim" keyword itself.
+int runSimCommand(int argc, char* argv[]);
+
+// Entry point for "matrix": all-pairs win-rate matrix over the whole roster
+int runMatrixCommand(int argc, char* argv[]);
+
+// Entry point for "solve": exact outcome probabilities for one matchup
+int runSolveCommand(int argc, char* argv[]);
+
+// Entry point for "gauntlet": AI-vs-AI Gauntlet runs for every unlockable fighter
+int runGauntletCommand(int argc, char* argv[]);
+
+// Entry point for "tournament": round-robin, Swiss or elimination over the roster, with Elo and Glicko ratings
+int runTournamentCommand(int argc, char* argv[]);
+
+// Entry point for "evolve": evolves custom character builds and prints the Pareto-best
+int runEvolveCommand(int argc, char* argv[]);
+
+#endif // SIMCOMMAND_H
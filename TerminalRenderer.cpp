@@ -0,0 +1,348 @@
+#include "TerminalRenderer.h"
+#include <algorithm>
+#include <iostream>
+#include <streambuf>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+    const size_t K_TAB_WIDTH = 8;
+
+    bool isTerminal(int fd) {
+#if defined(_WIN32)
+        return _isatty(fd) != 0;
+#else
+        return isatty(fd) != 0;
+#endif
+    }
+
+    void appendUtf8(string& out, char32_t c) {
+        if (c < 0x80) out += static_cast<char>(c);
+        else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (c >> 18));
+            out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    // Where the terminal's cursor is while an update is being built
+    struct Cursor {
+        size_t row = 0;
+        size_t col = 0;
+        bool known = false;
+    };
+
+    // Cheapest way there: nothing, a line feed, or CSI row;col H (1-based)
+    void moveCursor(string& out, Cursor& cursor, size_t row, size_t col) {
+        if (cursor.known && cursor.row == row && cursor.col == col) return;
+        if (cursor.known && col == 0 && row == cursor.row + 1) out += "\r\n";
+        else {
+            out += "\x1b[";
+            out += to_string(row + 1);
+            out += ';';
+            out += to_string(col + 1);
+            out += 'H';
+        }
+        cursor = Cursor{ row, col, true };
+    }
+}
+
+// cout and cerr land here; nothing reaches the terminal until present()
+class TerminalRenderer::FrameBuffer : public streambuf {
+public:
+    explicit FrameBuffer(TerminalRenderer& owner) : owner(owner) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            char ch = traits_type::to_char_type(c);
+            owner.append(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        owner.append(s, static_cast<size_t>(n));
+        return n;
+    }
+
+private:
+    TerminalRenderer& owner;
+};
+
+// Wraps cin's buffer: the frame is presented before every read that could
+// block, and what the terminal echoes is folded into the frame
+class TerminalRenderer::EchoBuffer : public streambuf {
+public:
+    EchoBuffer(TerminalRenderer& owner, streambuf* source) : owner(owner), source(source) {}
+
+protected:
+    int_type underflow() override {
+        owner.present();
+        int_type c = source->sbumpc();
+        if (traits_type::eq_int_type(c, traits_type::eof())) return c;
+        held = traits_type::to_char_type(c);
+        setg(&held, &held, &held + 1);
+        if (owner.echoes) owner.echo(held);
+        return c;
+    }
+
+private:
+    TerminalRenderer& owner;
+    streambuf* source;
+    char held = 0;
+};
+
+TerminalRenderer* TerminalRenderer::current = nullptr;
+
+TerminalRenderer::TerminalRenderer() {
+    if (current || !isTerminal(1)) return;
+#if defined(_WIN32)
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!GetConsoleMode(console, &mode) || !SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING)) return;
+#endif
+    cout.flush();
+    measure();
+    echoes = isTerminal(0);
+
+    outBuffer = make_unique<FrameBuffer>(*this);
+    savedOut = cout.rdbuf(outBuffer.get());
+    if (isTerminal(2)) {
+        errBuffer = make_unique<FrameBuffer>(*this);
+        savedErr = cerr.rdbuf(errBuffer.get());
+    }
+    inBuffer = make_unique<EchoBuffer>(*this, cin.rdbuf());
+    savedIn = cin.rdbuf(inBuffer.get());
+    installed = true;
+    current = this;
+}
+
+TerminalRenderer::~TerminalRenderer() {
+    if (!installed) return;
+    present();
+    cout.rdbuf(savedOut);
+    if (savedErr) cerr.rdbuf(savedErr);
+    cin.rdbuf(savedIn);
+    current = nullptr;
+}
+
+void TerminalRenderer::clearScreen() {
+    if (current) current->startFrame();
+}
+
+bool TerminalRenderer::Utf8Decoder::feed(unsigned char byte, char32_t& out) {
+    if (remaining > 0 && (byte & 0xC0) == 0x80) {
+        code = (code << 6) | (byte & 0x3F);
+        if (--remaining > 0) return false;
+        out = code;
+        return true;
+    }
+    // A lead byte; a broken sequence before it is dropped
+    remaining = 0;
+    if (byte < 0x80) { out = byte; return true; }
+    if ((byte & 0xE0) == 0xC0) { code = byte & 0x1F; remaining = 1; }
+    else if ((byte & 0xF0) == 0xE0) { code = byte & 0x0F; remaining = 2; }
+    else if ((byte & 0xF8) == 0xF0) { code = byte & 0x07; remaining = 3; }
+    return false;
+}
+
+// Lays one character out the way a terminal would, wrapping at the width
+void TerminalRenderer::Grid::put(char32_t c, size_t width) {
+    switch (c) {
+    case U'\n': ++row; col = 0; return;
+    case U'\r': col = 0; return;
+    case U'\b': if (col > 0) --col; return;
+    case U'\t': col = min(width - 1, (col / K_TAB_WIDTH + 1) * K_TAB_WIDTH); return;
+    default: break;
+    }
+    if (c < 0x20 || c == 0x7F) return;
+    if (col >= width) {
+        ++row;
+        col = 0;
+    }
+    if (rows.size() <= row) rows.resize(row + 1);
+    u32string& line = rows[row];
+    if (line.size() < col) line.resize(col, U' ');
+    if (line.size() == col) line += c;
+    else line[col] = c;
+    ++col;
+}
+
+void TerminalRenderer::measure() {
+#if defined(_WIN32)
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        width = static_cast<size_t>(info.srWindow.Right - info.srWindow.Left + 1);
+        height = static_cast<size_t>(info.srWindow.Bottom - info.srWindow.Top + 1);
+    }
+#else
+    winsize size{};
+    if (ioctl(1, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+        width = size.ws_col;
+        height = size.ws_row;
+    }
+#endif
+}
+
+void TerminalRenderer::startFrame() {
+    frame = Grid();
+    frameText.clear();
+    outDecoder = Utf8Decoder();
+    textSent = 0;
+    streaming = false;
+    needsClear = false;
+    dirty = true; // Even an empty frame clears the screen
+}
+
+void TerminalRenderer::append(const char* data, size_t size) {
+    frameText.append(data, size);
+    dirty = true;
+    if (streaming) return;
+
+    char32_t c;
+    for (size_t i = 0; i < size; ++i) {
+        if (outDecoder.feed(static_cast<unsigned char>(data[i]), c)) frame.put(c, width);
+    }
+    // Taller than the screen: rows would scroll away, so cells cannot be addressed
+    if (frame.row >= height) {
+        streaming = true;
+        screenKnown = false;
+        needsClear = true;
+        textSent = 0;
+    }
+}
+
+void TerminalRenderer::echo(char c) {
+    // Already on the screen: the terminal put it there
+    frameText += c;
+    if (streaming) {
+        textSent = frameText.size();
+        return;
+    }
+    char32_t code;
+    if (echoDecoder.feed(static_cast<unsigned char>(c), code)) {
+        frame.put(code, width);
+        screen.put(code, width);
+    }
+    if (frame.row >= height) {
+        streaming = true;
+        screenKnown = false;
+        textSent = frameText.size();
+    }
+}
+
+// After a resize, the frame is laid out again from its text
+void TerminalRenderer::rebuildFrame() {
+    frame = Grid();
+    Utf8Decoder decoder;
+    char32_t c;
+    for (char byte : frameText) {
+        if (decoder.feed(static_cast<unsigned char>(byte), c)) frame.put(c, width);
+    }
+    if (frame.row >= height) {
+        streaming = true;
+        needsClear = true;
+        textSent = 0;
+    }
+}
+
+void TerminalRenderer::renderDiff(string& out, bool fromClear) {
+    // After a clear the cursor is home; otherwise wherever the last frame left it
+    Cursor cursor{ fromClear ? 0 : screen.row, fromClear ? 0 : screen.col, fromClear || screen.col < width };
+    size_t rows = max(screen.rows.size(), frame.rows.size());
+    for (size_t r = 0; r < rows; ++r) {
+        static const u32string empty;
+        const u32string& before = r < screen.rows.size() ? screen.rows[r] : empty;
+        const u32string& after = r < frame.rows.size() ? frame.rows[r] : empty;
+        if (before == after) continue;
+
+        size_t first = 0;
+        while (first < before.size() && first < after.size() && before[first] == after[first]) ++first;
+        size_t last = after.size();
+        if (before.size() == after.size()) {
+            while (last > first && before[last - 1] == after[last - 1]) --last;
+        }
+        moveCursor(out, cursor, r, first);
+        for (size_t i = first; i < last; ++i) appendUtf8(out, after[i]);
+        // At the right edge the terminal holds a pending wrap; treat the cursor as lost
+        cursor.col = last;
+        cursor.known = last < width;
+        if (after.size() < before.size()) out += "\x1b[K"; // Erase to the end of the line
+    }
+    moveCursor(out, cursor, frame.row, min(frame.col, width - 1));
+}
+
+void TerminalRenderer::present() {
+    if (!installed || !dirty) return;
+    size_t oldWidth = width, oldHeight = height;
+    measure();
+    if (width != oldWidth || height != oldHeight) {
+        screenKnown = false;
+        if (!streaming) rebuildFrame();
+    }
+
+    string out;
+    if (streaming) {
+        if (needsClear) out += "\x1b[H\x1b[2J";
+        out.append(frameText, textSent, string::npos);
+        textSent = frameText.size();
+        needsClear = false;
+    }
+    else {
+        // A frame that shares little with the screen is cheaper redrawn whole
+        string redraw = "\x1b[H\x1b[2J";
+        Grid shown = move(screen);
+        screen = Grid();
+        renderDiff(redraw, true);
+        if (screenKnown) {
+            screen = move(shown);
+            renderDiff(out, false);
+        }
+        if (!screenKnown || redraw.size() < out.size()) out = move(redraw);
+        screen = frame;
+        screenKnown = true;
+    }
+    writeOut(out);
+    dirty = false;
+}
+
+// The whole update in one write(), so the terminal never shows half a frame
+void TerminalRenderer::writeOut(const string& bytes) {
+    const char* data = bytes.data();
+    size_t left = bytes.size();
+    while (left > 0) {
+#if defined(_WIN32)
+        int written = _write(1, data, static_cast<unsigned>(min<size_t>(left, 1u << 30)));
+        if (written <= 0) return;
+#else
+        ssize_t written = ::write(1, data, left);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+#endif
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef TERMINALRENDERER_H
+#define TERMINALRENDERER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Double-buffered renderer for the interactive screens. While one is alive
+// and stdout is a terminal, cout (and cerr, if it is the same terminal) write
+// into an off-screen frame instead of the console. Just before the program
+// waits for input, the frame is diffed against what the terminal shows and
+// only the changed cells go out, as ANSI escape codes in one write(). Input
+// echoed by the terminal is folded into the frame, so the two stay in step.
+//
+// When stdout is not a terminal (pipes, files, tests), nothing is installed
+// and output streams through untouched.
+class TerminalRenderer {
+public:
+    TerminalRenderer();
+    ~TerminalRenderer(); // Presents the last frame and gives the streams back
+
+    TerminalRenderer(const TerminalRenderer&) = delete;
+    TerminalRenderer& operator=(const TerminalRenderer&) = delete;
+
+    bool active() const { return installed; }
+
+    // Starts a new frame: what is written next replaces the screen rather
+    // than scrolling it. Does nothing without a renderer.
+    static void clearScreen();
+
+    // Sends the pending frame to the terminal now
+    void present();
+
+private:
+    // One screen's worth of cells, as the terminal would lay out the text
+    struct Grid {
+        std::vector<std::u32string> rows;
+        size_t row = 0;
+        size_t col = 0;
+
+        void put(char32_t c, size_t width);
+    };
+
+    class FrameBuffer;
+    class EchoBuffer;
+
+    static TerminalRenderer* current;
+
+    bool installed = false;
+    bool echoes = false;           // stdin is the terminal too, so typed lines show on screen
+    std::unique_ptr<FrameBuffer> outBuffer;
+    std::unique_ptr<FrameBuffer> errBuffer;
+    std::unique_ptr<EchoBuffer> inBuffer;
+    std::streambuf* savedOut = nullptr;
+    std::streambuf* savedErr = nullptr;
+    std::streambuf* savedIn = nullptr;
+
+    size_t width = 80;
+    size_t height = 24;
+    Grid frame;                    // Being built
+    Grid screen;                   // What the terminal shows; valid when screenKnown
+    bool screenKnown = false;      // False before the first frame and after scrolled ones
+    bool streaming = true;         // This frame no longer fits the screen: it is written as plain text
+    std::string frameText;         // Raw text of this frame, echo included
+    size_t textSent = 0;           // Bytes of frameText already on screen while streaming
+    bool needsClear = false;       // The next streamed write starts by clearing the screen
+    bool dirty = false;
+
+    // UTF-8 to code points, across writes
+    struct Utf8Decoder {
+        uint32_t code = 0;
+        int remaining = 0;
+
+        bool feed(unsigned char byte, char32_t& out);
+    };
+    Utf8Decoder outDecoder;
+    Utf8Decoder echoDecoder;
+
+    void append(const char* data, size_t size);
+    void echo(char c);
+    void rebuildFrame();
+    void startFrame();
+    void measure();
+    void renderDiff(std::string& out, bool fromClear);
+    void writeOut(const std::string& bytes);
+};
+
+#endif // TERMINALRENDERER_H
@@ -0,0 +1,133 @@
+#include "ThreadPool.h"
+#include <utility>
+
+using namespace std;
+
+namespace {
+    // Index of the pool worker running on this thread, or -1 for outside threads
+    thread_local int currentWorkerIndex = -1;
+    thread_local const ThreadPool* currentPool = nullptr;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : pendingTasks(0), queuedTasks(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+bool ThreadPool::onWorkerThread() {
+    return currentWorkerIndex >= 0;
+}
+
+void ThreadPool::submit(Task task) {
+    unsigned target;
+    if (currentPool == this && currentWorkerIndex >= 0) {
+        target = static_cast<unsigned>(currentWorkerIndex);
+    }
+    else {
+        target = nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+    }
+
+    pendingTasks.fetch_add(1, memory_order_relaxed);
+    {
+        lock_guard<mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Publishing under stateMutex keeps a sleeping worker from missing the wakeup
+        lock_guard<mutex> lock(stateMutex);
+        queuedTasks.fetch_add(1, memory_order_relaxed);
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return pendingTasks.load(memory_order_acquire) == 0; });
+}
+
+bool ThreadPool::tryPop(unsigned index, Task& out) {
+    {
+        WorkerQueue& own = *queues[index];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(index + offset) % queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentWorkerIndex = static_cast<int>(index);
+    currentPool = this;
+
+    while (true) {
+        Task task;
+        if (tryPop(index, task)) {
+            queuedTasks.fetch_sub(1, memory_order_relaxed);
+            task(index);
+            if (pendingTasks.fetch_sub(1, memory_order_acq_rel) == 1) {
+                lock_guard<mutex> lock(stateMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this] { return stopping || queuedTasks.load(memory_order_relaxed) > 0; });
+        if (stopping && queuedTasks.load(memory_order_relaxed) == 0) return;
+    }
+}
+
+void ThreadPool::splitRange(size_t begin, size_t end, size_t grain,
+    const function<void(size_t, size_t, unsigned)>& fn, unsigned workerIndex) {
+    // Hand the upper half to the deque (where thieves find it) and keep the lower half
+    while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        submit([this, mid, end, grain, &fn](unsigned worker) { splitRange(mid, end, grain, fn, worker); });
+        end = mid;
+    }
+    fn(begin, end, workerIndex);
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+    const function<void(size_t, size_t, unsigned)>& fn) {
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+    submit([this, begin, end, grain, &fn](unsigned worker) { splitRange(begin, end, grain, fn, worker); });
+    wait();
+}
@@ -0,0 +1,61 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: every worker owns a deque, pops its newest task and
+// steals the oldest task from a sibling when it runs dry.
+class ThreadPool {
+public:
+    using Task = std::function<void(unsigned workerIndex)>;
+
+    explicit ThreadPool(unsigned threadCount = 0); // 0 = one worker per hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const;
+    // True on a worker of any pool; nested parallel work should then run inline
+    static bool onWorkerThread();
+
+    // Called from a worker, the task goes to that worker's own deque
+    void submit(Task task);
+    void wait(); // Blocks until every submitted task (and anything they submitted) is done
+
+    // Runs fn(begin, end, workerIndex) over [begin, end) in chunks of at most grain,
+    // splitting ranges recursively so idle workers can steal the larger halves.
+    void parallelFor(size_t begin, size_t end, size_t grain,
+        const std::function<void(size_t, size_t, unsigned)>& fn);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pendingTasks;
+    std::atomic<size_t> queuedTasks;
+    std::atomic<unsigned> nextQueue;
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    bool stopping;
+
+    void workerLoop(unsigned index);
+    bool tryPop(unsigned index, Task& out);
+    void splitRange(size_t begin, size_t end, size_t grain,
+        const std::function<void(size_t, size_t, unsigned)>& fn, unsigned workerIndex);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,469 @@
+#include "Tournament.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+    const double K_ELO_K = 32.0;
+    const double K_GLICKO_SCALE = 173.7178; // Glicko-2 internal units per rating point
+    const double K_GLICKO_TAU = 0.5;        // Constrains volatility changes
+    const double K_GLICKO_EPSILON = 1e-6;
+    const double K_MAX_DEVIATION = 350.0;
+    const double K_PI = 3.14159265358979323846;
+
+    // Series are several AI battles each, so small chunks keep workers balanced
+    const size_t K_SERIES_PER_GRAIN = 4;
+    // How far down the standings Swiss pairing looks for an opponent not met yet
+    const size_t K_SWISS_WINDOW = 64;
+
+    const uint32_t K_NO_ENTRANT = UINT32_MAX;
+
+    struct Pairing {
+        uint32_t a; // Plays the first battle of the series as the player
+        uint32_t b;
+    };
+
+    SeriesResult playSeries(const Pairing& pairing, const vector<const Character*>& fighters,
+        const TournamentOptions& options, const Rng& stream) {
+        SeriesResult s;
+        s.a = pairing.a;
+        s.b = pairing.b;
+        int needed = options.bestOf / 2 + 1;
+        for (int game = 0; game < options.bestOf && s.winsA < needed && s.winsB < needed; ++game) {
+            // Sides alternate, so neither entrant keeps the player's first move
+            bool aIsPlayer = game % 2 == 0;
+            const Character& player = *fighters[aIsPlayer ? s.a : s.b];
+            const Character& bot = *fighters[aIsPlayer ? s.b : s.a];
+            BattleResult r = BattleEngine::runBattle(player, bot, options.policy, options.policy,
+                stream.fork(static_cast<uint64_t>(game)).next(), options.maxRounds);
+            s.battleRounds += r.rounds;
+            if (r.outcome == BattleOutcome::PLAYER_WINS) ++(aIsPlayer ? s.winsA : s.winsB);
+            else if (r.outcome == BattleOutcome::BOT_WINS) ++(aIsPlayer ? s.winsB : s.winsA);
+            else ++s.draws;
+        }
+        return s;
+    }
+
+    double glickoG(double phi) {
+        return 1.0 / sqrt(1.0 + 3.0 * phi * phi / (K_PI * K_PI));
+    }
+
+    // Step 5 of Glickman's Glicko-2 paper: the new volatility, by the Illinois method
+    double nextVolatility(double sigma, double phi, double v, double delta) {
+        const double a = log(sigma * sigma);
+        auto f = [&](double x) {
+            double ex = exp(x);
+            double d = phi * phi + v + ex;
+            return ex * (delta * delta - phi * phi - v - ex) / (2.0 * d * d) - (x - a) / (K_GLICKO_TAU * K_GLICKO_TAU);
+        };
+        double lo = a;
+        double hi;
+        if (delta * delta > phi * phi + v) {
+            hi = log(delta * delta - phi * phi - v);
+        }
+        else {
+            int k = 1;
+            while (f(a - k * K_GLICKO_TAU) < 0) ++k;
+            hi = a - k * K_GLICKO_TAU;
+        }
+        double fLo = f(lo), fHi = f(hi);
+        while (fabs(hi - lo) > K_GLICKO_EPSILON) {
+            double mid = lo + (lo - hi) * fLo / (fHi - fLo);
+            double fMid = f(mid);
+            if (fMid * fHi <= 0) {
+                lo = hi;
+                fLo = fHi;
+            }
+            else {
+                fLo /= 2;
+            }
+            hi = mid;
+            fHi = fMid;
+        }
+        return exp(lo / 2);
+    }
+
+    // Tournament state shared by the three formats
+    class Bracket {
+    public:
+        Bracket(const vector<const Character*>& fighters, vector<Rating>& ratings, const TournamentOptions& options)
+            : fighters(fighters), ratings(ratings), options(options), pool(options.threads), root(options.seed),
+            standings(fighters.size()), opponents(fighters.size()), seedRank(fighters.size()) {
+            for (uint32_t i = 0; i < standings.size(); ++i) {
+                standings[i].entrant = i;
+                standings[i].name = fighters[i]->getName();
+            }
+            // Seeds follow the ratings brought into the tournament, roster order breaking ties
+            vector<uint32_t> bySeed(fighters.size());
+            iota(bySeed.begin(), bySeed.end(), 0u);
+            stable_sort(bySeed.begin(), bySeed.end(), [&](uint32_t x, uint32_t y) { return ratings[x].elo > ratings[y].elo; });
+            for (uint32_t rank = 0; rank < bySeed.size(); ++rank) seedRank[bySeed[rank]] = rank;
+            start = chrono::steady_clock::now();
+        }
+
+        size_t size() const { return fighters.size(); }
+        uint32_t seedOf(uint32_t entrant) const { return seedRank[entrant]; }
+        double pointsOf(uint32_t entrant) const { return standings[entrant].points; }
+        uint32_t byesOf(uint32_t entrant) const { return standings[entrant].byes; }
+        bool haveMet(uint32_t x, uint32_t y) const {
+            return find(opponents[x].begin(), opponents[x].end(), y) != opponents[x].end();
+        }
+
+        void giveBye(uint32_t entrant) {
+            ++standings[entrant].byes;
+            standings[entrant].points += 1.0;
+        }
+
+        void setRoundReached(uint32_t entrant, int round) { standings[entrant].roundReached = round; }
+
+        // Plays one round's series in parallel, then books them and rates them as one batch
+        vector<SeriesResult> playRound(const vector<Pairing>& pairings) {
+            vector<SeriesResult> results(pairings.size());
+            const Rng roundStream = root.fork(static_cast<uint64_t>(report.rounds));
+            pool.parallelFor(0, pairings.size(), K_SERIES_PER_GRAIN, [&](size_t first, size_t last, unsigned) {
+                for (size_t i = first; i < last; ++i) {
+                    results[i] = playSeries(pairings[i], fighters, options, roundStream.fork(i));
+                }
+            });
+
+            for (const SeriesResult& s : results) {
+                double score = s.scoreA();
+                book(s.a, s.b, score);
+                book(s.b, s.a, 1.0 - score);
+                report.battles += static_cast<uint64_t>(s.battles());
+                report.battleRounds += s.battleRounds;
+            }
+            report.series += results.size();
+            updateRatings(ratings, results);
+            ++report.rounds;
+
+            if (options.verbose) {
+                double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                cout << "Round " << report.rounds << ": " << results.size() << " series, "
+                    << report.battles << " battles so far, " << seconds << " s" << endl;
+            }
+            return results;
+        }
+
+        // Orders the standings, best first, and hands the report over
+        TournamentReport finish() {
+            for (TournamentStanding& s : standings) {
+                s.rating = ratings[s.entrant];
+                for (uint32_t o : opponents[s.entrant]) s.buchholz += standings[o].points;
+            }
+            vector<TournamentStanding> ordered = standings;
+            if (options.format == TournamentFormat::SINGLE_ELIMINATION) {
+                sort(ordered.begin(), ordered.end(), [&](const TournamentStanding& x, const TournamentStanding& y) {
+                    if (x.roundReached != y.roundReached) return x.roundReached > y.roundReached;
+                    return seedRank[x.entrant] < seedRank[y.entrant];
+                });
+            }
+            else {
+                sort(ordered.begin(), ordered.end(), [&](const TournamentStanding& x, const TournamentStanding& y) {
+                    if (x.points != y.points) return x.points > y.points;
+                    if (x.buchholz != y.buchholz) return x.buchholz > y.buchholz;
+                    return seedRank[x.entrant] < seedRank[y.entrant];
+                });
+            }
+            report.standings = std::move(ordered);
+            report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            return std::move(report);
+        }
+
+    private:
+        const vector<const Character*>& fighters;
+        vector<Rating>& ratings;
+        const TournamentOptions& options;
+        ThreadPool pool;
+        const Rng root;
+        vector<TournamentStanding> standings; // By entrant
+        vector<vector<uint32_t>> opponents;   // By entrant, in the order they were met
+        vector<uint32_t> seedRank;            // 0 = top seed
+        TournamentReport report;
+        chrono::steady_clock::time_point start;
+
+        void book(uint32_t self, uint32_t other, double score) {
+            TournamentStanding& s = standings[self];
+            s.points += score;
+            if (score == 1.0) ++s.seriesWon;
+            else if (score == 0.0) ++s.seriesLost;
+            else ++s.seriesDrawn;
+            opponents[self].push_back(other);
+        }
+    };
+
+    void runRoundRobin(Bracket& bracket) {
+        // Circle method: slot 0 stays put and the rest rotate, so every round
+        // is a set of disjoint pairs and every pair meets exactly once
+        uint32_t n = static_cast<uint32_t>(bracket.size());
+        uint32_t slots = n + (n % 2);
+        vector<uint32_t> circle(slots);
+        iota(circle.begin(), circle.end(), 0u);
+        if (n % 2) circle.back() = K_NO_ENTRANT;
+
+        vector<Pairing> pairings;
+        for (uint32_t round = 0; round + 1 < slots; ++round) {
+            pairings.clear();
+            for (uint32_t i = 0; i < slots / 2; ++i) {
+                uint32_t x = circle[i], y = circle[slots - 1 - i];
+                if (x == K_NO_ENTRANT || y == K_NO_ENTRANT) continue;
+                // Alternate who opens, so slot 0 does not always play first
+                pairings.push_back(round % 2 ? Pairing{ y, x } : Pairing{ x, y });
+            }
+            bracket.playRound(pairings);
+            rotate(circle.begin() + 1, circle.end() - 1, circle.end());
+        }
+    }
+
+    void runSwiss(Bracket& bracket, int rounds) {
+        uint32_t n = static_cast<uint32_t>(bracket.size());
+        vector<uint32_t> order(n);
+        iota(order.begin(), order.end(), 0u);
+        vector<char> paired(n);
+        vector<Pairing> pairings;
+
+        for (int round = 0; round < rounds; ++round) {
+            // Monrad-style: sort by score, then pair each entrant with the next
+            // one down it has not met yet
+            stable_sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+                if (bracket.pointsOf(x) != bracket.pointsOf(y)) return bracket.pointsOf(x) > bracket.pointsOf(y);
+                return bracket.seedOf(x) < bracket.seedOf(y);
+            });
+            fill(paired.begin(), paired.end(), 0);
+            pairings.clear();
+
+            if (n % 2) {
+                // The lowest-ranked entrant without a bye sits out
+                auto byeTaker = find_if(order.rbegin(), order.rend(), [&](uint32_t e) { return bracket.byesOf(e) == 0; });
+                uint32_t bye = byeTaker != order.rend() ? *byeTaker : order.back();
+                paired[bye] = 1;
+                bracket.giveBye(bye);
+            }
+
+            size_t next = 0; // First position that may still be unpaired
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t x = order[i];
+                if (paired[x]) continue;
+                paired[x] = 1;
+                while (next < n && paired[order[next]]) ++next;
+
+                uint32_t partner = K_NO_ENTRANT;
+                size_t looked = 0;
+                for (size_t j = next; j < n && looked < K_SWISS_WINDOW; ++j) {
+                    uint32_t y = order[j];
+                    if (paired[y]) continue;
+                    if (partner == K_NO_ENTRANT) partner = y; // Rematch fallback
+                    if (!bracket.haveMet(x, y)) {
+                        partner = y;
+                        break;
+                    }
+                    ++looked;
+                }
+                if (partner == K_NO_ENTRANT) break; // Cannot happen: after the bye an even number are left
+                paired[partner] = 1;
+                pairings.push_back(round % 2 ? Pairing{ partner, x } : Pairing{ x, partner });
+            }
+            bracket.playRound(pairings);
+        }
+    }
+
+    void runSingleElimination(Bracket& bracket) {
+        uint32_t n = static_cast<uint32_t>(bracket.size());
+        uint32_t size = 1;
+        while (size < n) size *= 2;
+
+        // Standard seeding: 1 and 2 can only meet in the final, 1 meets the
+        // lowest seed first, and so on down; seeds past n are byes
+        vector<uint32_t> slotSeeds{ 0 };
+        while (slotSeeds.size() < size) {
+            uint32_t span = static_cast<uint32_t>(slotSeeds.size()) * 2;
+            vector<uint32_t> expanded;
+            for (uint32_t seed : slotSeeds) {
+                expanded.push_back(seed);
+                expanded.push_back(span - 1 - seed);
+            }
+            slotSeeds.swap(expanded);
+        }
+        vector<uint32_t> bySeed(n);
+        for (uint32_t e = 0; e < n; ++e) bySeed[bracket.seedOf(e)] = e;
+        vector<uint32_t> alive(size);
+        for (uint32_t slot = 0; slot < size; ++slot) {
+            alive[slot] = slotSeeds[slot] < n ? bySeed[slotSeeds[slot]] : K_NO_ENTRANT;
+        }
+
+        int round = 0;
+        vector<Pairing> pairings;
+        vector<size_t> pairingSlot;
+        while (alive.size() > 1) {
+            ++round;
+            pairings.clear();
+            pairingSlot.clear();
+            vector<uint32_t> winners(alive.size() / 2, K_NO_ENTRANT);
+            for (size_t slot = 0; slot + 1 < alive.size(); slot += 2) {
+                uint32_t x = alive[slot], y = alive[slot + 1];
+                if (x != K_NO_ENTRANT) bracket.setRoundReached(x, round);
+                if (y != K_NO_ENTRANT) bracket.setRoundReached(y, round);
+                if (x == K_NO_ENTRANT || y == K_NO_ENTRANT) {
+                    winners[slot / 2] = x != K_NO_ENTRANT ? x : y;
+                    if (winners[slot / 2] != K_NO_ENTRANT) bracket.giveBye(winners[slot / 2]);
+                    continue;
+                }
+                pairings.push_back(Pairing{ x, y });
+                pairingSlot.push_back(slot / 2);
+            }
+            vector<SeriesResult> results = bracket.playRound(pairings);
+            for (size_t i = 0; i < results.size(); ++i) {
+                const SeriesResult& s = results[i];
+                double score = s.scoreA();
+                bool aAdvances = score > 0.5 || (score == 0.5 && bracket.seedOf(s.a) < bracket.seedOf(s.b));
+                winners[pairingSlot[i]] = aAdvances ? s.a : s.b;
+            }
+            alive.swap(winners);
+        }
+        // The champion counts one round past the final
+        if (!alive.empty() && alive[0] != K_NO_ENTRANT) bracket.setRoundReached(alive[0], round + 1);
+    }
+}
+
+const char* tournamentFormatName(TournamentFormat format) {
+    switch (format) {
+    case TournamentFormat::ROUND_ROBIN: return "round-robin";
+    case TournamentFormat::SWISS: return "swiss";
+    default: return "elimination";
+    }
+}
+
+bool parseTournamentFormat(const string& s, TournamentFormat& out) {
+    if (s == "round-robin") { out = TournamentFormat::ROUND_ROBIN; return true; }
+    if (s == "swiss") { out = TournamentFormat::SWISS; return true; }
+    if (s == "elimination") { out = TournamentFormat::SINGLE_ELIMINATION; return true; }
+    return false;
+}
+
+bool readRatingsFile(const string& path, vector<NamedRating>& out) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    getline(in, line); // Header
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        // Fields are split from the right, so a name may contain commas
+        NamedRating entry;
+        double* fields[4] = { &entry.rating.volatility, &entry.rating.deviation, &entry.rating.glicko, &entry.rating.elo };
+        size_t end = line.size();
+        bool ok = true;
+        for (double* field : fields) {
+            size_t comma = line.rfind(',', end - 1);
+            if (end == 0 || comma == string::npos) {
+                ok = false;
+                break;
+            }
+            try {
+                *field = stod(line.substr(comma + 1, end - comma - 1));
+            }
+            catch (...) {
+                ok = false;
+                break;
+            }
+            end = comma;
+        }
+        if (!ok || end == 0) continue;
+        entry.name = line.substr(0, end);
+        out.push_back(entry);
+    }
+    return true;
+}
+
+bool writeRatingsFile(const string& path, const vector<NamedRating>& ratings) {
+    ofstream out(path);
+    if (!out) {
+        cerr << "Error: Could not open " << path << " for writing!" << endl;
+        return false;
+    }
+    out << "name,elo,glicko,deviation,volatility\n";
+    out << setprecision(10);
+    for (const NamedRating& r : ratings) {
+        out << r.name << "," << r.rating.elo << "," << r.rating.glicko << "," << r.rating.deviation << "," << r.rating.volatility << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+void updateRatings(vector<Rating>& ratings, const vector<SeriesResult>& results) {
+    // Everything below reads the ratings from before the period
+    vector<double> eloDelta(ratings.size(), 0.0);
+    vector<double> variance(ratings.size(), 0.0);    // Sum of g^2 E (1 - E)
+    vector<double> improvement(ratings.size(), 0.0); // Sum of g (s - E)
+    vector<char> played(ratings.size(), 0);
+
+    for (const SeriesResult& s : results) {
+        const Rating& a = ratings[s.a];
+        const Rating& b = ratings[s.b];
+        double score = s.scoreA();
+
+        double expected = 1.0 / (1.0 + pow(10.0, (b.elo - a.elo) / 400.0));
+        eloDelta[s.a] += K_ELO_K * (score - expected);
+        eloDelta[s.b] -= K_ELO_K * (score - expected);
+
+        double muA = (a.glicko - 1500.0) / K_GLICKO_SCALE, phiA = a.deviation / K_GLICKO_SCALE;
+        double muB = (b.glicko - 1500.0) / K_GLICKO_SCALE, phiB = b.deviation / K_GLICKO_SCALE;
+        double gA = glickoG(phiA), gB = glickoG(phiB);
+        double eA = 1.0 / (1.0 + exp(-gB * (muA - muB)));
+        double eB = 1.0 / (1.0 + exp(-gA * (muB - muA)));
+        variance[s.a] += gB * gB * eA * (1.0 - eA);
+        improvement[s.a] += gB * (score - eA);
+        variance[s.b] += gA * gA * eB * (1.0 - eB);
+        improvement[s.b] += gA * ((1.0 - score) - eB);
+        played[s.a] = played[s.b] = 1;
+    }
+
+    for (size_t i = 0; i < ratings.size(); ++i) {
+        Rating& r = ratings[i];
+        r.elo += eloDelta[i];
+        double phi = r.deviation / K_GLICKO_SCALE;
+        if (!played[i]) {
+            r.deviation = min(K_MAX_DEVIATION, sqrt(phi * phi + r.volatility * r.volatility) * K_GLICKO_SCALE);
+            continue;
+        }
+        double v = 1.0 / variance[i];
+        double delta = v * improvement[i];
+        r.volatility = nextVolatility(r.volatility, phi, v, delta);
+        double phiStar = sqrt(phi * phi + r.volatility * r.volatility);
+        double phiNew = 1.0 / sqrt(1.0 / (phiStar * phiStar) + 1.0 / v);
+        r.glicko += K_GLICKO_SCALE * phiNew * phiNew * improvement[i];
+        r.deviation = min(K_MAX_DEVIATION, phiNew * K_GLICKO_SCALE);
+    }
+}
+
+TournamentReport runTournament(const vector<const Character*>& fighters, vector<Rating>& ratings,
+    const TournamentOptions& options) {
+    ratings.resize(fighters.size());
+    Bracket bracket(fighters, ratings, options);
+    if (fighters.size() < 2) return bracket.finish();
+
+    switch (options.format) {
+    case TournamentFormat::ROUND_ROBIN:
+        runRoundRobin(bracket);
+        break;
+    case TournamentFormat::SWISS: {
+        int rounds = options.swissRounds;
+        if (rounds <= 0) {
+            rounds = 0;
+            while ((size_t(1) << rounds) < fighters.size()) ++rounds;
+        }
+        runSwiss(bracket, rounds);
+        break;
+    }
+    case TournamentFormat::SINGLE_ELIMINATION:
+        runSingleElimination(bracket);
+        break;
+    }
+    return bracket.finish();
+}
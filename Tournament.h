@@ -0,0 +1,104 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "BattleEngine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class TournamentFormat {
+    ROUND_ROBIN,
+    SWISS,
+    SINGLE_ELIMINATION
+};
+
+// "round-robin", "swiss" or "elimination"
+const char* tournamentFormatName(TournamentFormat format);
+bool parseTournamentFormat(const std::string& s, TournamentFormat& out);
+
+// Both rating systems, carried from ladder to ladder. Glicko is Glicko-2,
+// reported on the familiar 1500-centred scale.
+struct Rating {
+    double elo = 1500.0;
+    double glicko = 1500.0;
+    double deviation = 350.0; // Glicko RD
+    double volatility = 0.06;
+};
+
+// A rating kept between ladders under the entrant's name
+struct NamedRating {
+    std::string name;
+    Rating rating;
+};
+
+// CSV with a header line, then "name,elo,glicko,deviation,volatility" per entrant.
+// read returns false if the file could not be opened; malformed lines are skipped.
+bool readRatingsFile(const std::string& path, std::vector<NamedRating>& out);
+bool writeRatingsFile(const std::string& path, const std::vector<NamedRating>& ratings);
+
+// One finished best-of series between entrants a and b (indices into the entrant list)
+struct SeriesResult {
+    uint32_t a = 0;
+    uint32_t b = 0;
+    int winsA = 0;
+    int winsB = 0;
+    int draws = 0;             // Double K.O.s and round limits
+    uint64_t battleRounds = 0;
+
+    int battles() const { return winsA + winsB + draws; }
+    // 1, 0.5 or 0 for a; a series with as many wins each way is drawn
+    double scoreA() const { return winsA > winsB ? 1.0 : (winsA < winsB ? 0.0 : 0.5); }
+};
+
+// Applies one rating period in which every series counts as a game played at
+// the same time: expectations come from the ratings before the period, so the
+// order of results cannot matter. Entrants with no series only gain Glicko RD.
+void updateRatings(std::vector<Rating>& ratings, const std::vector<SeriesResult>& results);
+
+struct TournamentOptions {
+    TournamentFormat format = TournamentFormat::SWISS;
+    int bestOf = 3;               // Battles per series; it stops once one side has a majority
+    int swissRounds = 0;          // 0 = enough to leave one unbeaten entrant (ceil(log2 n))
+    uint64_t seed = 1;
+    unsigned threads = 0;         // 0 = all hardware threads
+    MovePolicy policy = MovePolicy::ai(AIDifficulty::HARD);
+    int maxRounds = BattleEngine::DEFAULT_MAX_ROUNDS;
+    bool verbose = false;         // One progress line per tournament round on stdout
+};
+
+struct TournamentStanding {
+    uint32_t entrant = 0;         // Index into the fighter list
+    std::string name;
+    double points = 0.0;          // 1 per series won (and per bye), 0.5 per drawn series
+    uint32_t seriesWon = 0;
+    uint32_t seriesDrawn = 0;
+    uint32_t seriesLost = 0;
+    uint32_t byes = 0;
+    double buchholz = 0.0;        // Sum of the opponents' points (Swiss tie-break)
+    int roundReached = 0;         // Single elimination: last round played (1-based)
+    Rating rating;                // After the tournament
+};
+
+struct TournamentReport {
+    std::vector<TournamentStanding> standings; // Best first
+    int rounds = 0;
+    uint64_t series = 0;
+    uint64_t battles = 0;
+    uint64_t battleRounds = 0;
+    double seconds = 0.0;
+};
+
+// Plays a whole tournament between the fighters under options.policy, with
+// ratings (one per fighter, updated in place) seeding brackets and pairings.
+// The series of each round run in parallel, each writing only its own result
+// slot; ratings are updated in one batch per round. Results depend only on
+// the seed, not on the thread count.
+//  - Round robin: everyone meets everyone once, scheduled by the circle method.
+//  - Swiss: pairs neighbours in the standings, avoiding rematches where it
+//    can; an odd entrant out gets a bye worth a win.
+//  - Single elimination: a seeded bracket (1 meets the lowest seed); drawn
+//    series go to the higher seed.
+TournamentReport runTournament(const std::vector<const Character*>& fighters, std::vector<Rating>& ratings,
+    const TournamentOptions& options);
+
+#endif // TOURNAMENT_H
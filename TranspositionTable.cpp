@@ -0,0 +1,103 @@
+#include "TranspositionTable.h"
+#include "Zobrist.h"
+#include <bit>
+
+using namespace std;
+
+TranspositionTable::TranspositionTable(size_t bucketCount) {
+    size_t count = 1;
+    while (count < bucketCount) count <<= 1;
+    buckets = make_unique<Bucket[]>(count);
+    bucketMask = count - 1;
+}
+
+TranspositionTable& TranspositionTable::shared() {
+    static TranspositionTable table;
+    return table;
+}
+
+uint64_t TranspositionTable::slotKey(uint64_t key, TableKind kind, int depth) {
+    uint64_t fullKey = key ^ zobristKey(static_cast<ZobristField>(0x100 + static_cast<int>(kind)), depth);
+    return fullKey ? fullKey : 1; // An empty slot checks out as key 0
+}
+
+bool TranspositionTable::readSlot(const Slot& slot, uint64_t fullKey, uint64_t (&words)[4]) const {
+    uint64_t check = slot.check.load(memory_order_acquire);
+    for (int i = 0; i < 4; ++i) {
+        words[i] = slot.words[i].load(memory_order_relaxed);
+        check ^= words[i];
+    }
+    return check == fullKey;
+}
+
+bool TranspositionTable::probe(uint64_t key, TableKind kind, int depth, TableEntry& out) {
+    uint64_t fullKey = slotKey(key, kind, depth);
+    Bucket& bucket = buckets[fullKey & bucketMask];
+    for (int i = 0; i < K_SLOTS_PER_BUCKET; ++i) {
+        uint64_t words[4];
+        if (!readSlot(bucket.slots[i], fullKey, words)) continue;
+
+        for (int s = 0; s < 3; ++s) out.scores[s] = bit_cast<double>(words[s]);
+        out.bestMove = static_cast<int>(words[3] & 0xFF);
+        out.bestReply = static_cast<int>((words[3] >> 8) & 0xFF);
+        if (!(bucket.clock.load(memory_order_relaxed) & (1u << i))) {
+            bucket.clock.fetch_or(static_cast<uint8_t>(1u << i), memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+int TranspositionTable::chooseVictim(Bucket& bucket) {
+    uint8_t clock = bucket.clock.load(memory_order_relaxed);
+    for (;;) {
+        int hand = (clock >> 4) & 3;
+        uint8_t referenced = static_cast<uint8_t>(1u << hand);
+        // Advance the hand; a referenced slot only loses its bit and gets another lap
+        uint8_t next = static_cast<uint8_t>(((clock & 0x0F) & ~referenced) | (((hand + 1) & 3) << 4));
+        if (clock & referenced) {
+            bucket.clock.compare_exchange_weak(clock, next, memory_order_relaxed);
+            continue;
+        }
+        // New entries start referenced so they survive one pass of the hand
+        if (bucket.clock.compare_exchange_weak(clock, static_cast<uint8_t>(next | referenced), memory_order_relaxed)) {
+            return hand;
+        }
+    }
+}
+
+void TranspositionTable::store(uint64_t key, TableKind kind, int depth, const TableEntry& entry) {
+    uint64_t fullKey = slotKey(key, kind, depth);
+    Bucket& bucket = buckets[fullKey & bucketMask];
+
+    int target = -1;
+    for (int i = 0; i < K_SLOTS_PER_BUCKET && target < 0; ++i) {
+        uint64_t words[4];
+        if (readSlot(bucket.slots[i], fullKey, words)) target = i;
+    }
+    if (target < 0) target = chooseVictim(bucket);
+
+    uint64_t words[4];
+    for (int s = 0; s < 3; ++s) words[s] = bit_cast<uint64_t>(entry.scores[s]);
+    words[3] = static_cast<uint64_t>(entry.bestMove & 0xFF) | static_cast<uint64_t>(entry.bestReply & 0xFF) << 8;
+
+    // Two writers racing on one slot can interleave words; the check then fails
+    // and the slot reads as empty until someone stores it again
+    Slot& slot = bucket.slots[target];
+    uint64_t check = fullKey;
+    for (int i = 0; i < 4; ++i) {
+        slot.words[i].store(words[i], memory_order_relaxed);
+        check ^= words[i];
+    }
+    slot.check.store(check, memory_order_release);
+}
+
+void TranspositionTable::clear() {
+    for (size_t b = 0; b <= bucketMask; ++b) {
+        buckets[b].clock.store(0, memory_order_relaxed);
+        for (Slot& slot : buckets[b].slots) {
+            slot.check.store(0, memory_order_relaxed);
+            for (auto& word : slot.words) word.store(0, memory_order_relaxed);
+        }
+    }
+}
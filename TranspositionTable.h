@@ -0,0 +1,68 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// What a table entry holds; which AI wrote it decides what the numbers mean
+enum class TableKind : uint8_t {
+    HARD_SCORES = 1, // scoreMoveHard for each move
+    EQUILIBRIUM,     // OPTIMAL's mixed strategy
+    SEARCH_NODE,     // LOOKAHEAD value of a round-start state, in scores[0]
+    SEARCH_ROOT      // LOOKAHEAD value of each root move
+};
+
+struct TableEntry {
+    std::array<double, 3> scores{};
+    int bestMove = 0;  // 1-3, 0 = none
+    int bestReply = 0; // Opponent move that hurts bestMove most, 0 = none
+};
+
+// Fixed-size table shared by every AI and thread. Buckets hold four slots;
+// a slot's check word is the key XORed with its payload, so a read that
+// races a write sees a mismatch and counts as a miss instead of taking a
+// lock. Full buckets evict with the clock algorithm: a hit sets the slot's
+// reference bit, and the bucket's hand clears bits until it finds a slot
+// nobody has used since it last passed.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t bucketCount = 1 << 14); // Rounded up to a power of two
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // depth separates search results of different horizons; 0 for the one-ply AIs
+    bool probe(uint64_t key, TableKind kind, int depth, TableEntry& out);
+    void store(uint64_t key, TableKind kind, int depth, const TableEntry& entry);
+    void clear();
+
+    size_t capacity() const { return bucketMask + 1; }
+
+    // The table the AIs use, so work carries across turns, battles and threads
+    static TranspositionTable& shared();
+
+private:
+    static const int K_SLOTS_PER_BUCKET = 4;
+
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };
+        std::atomic<uint64_t> words[4]{}; // Three scores and the packed meta word
+    };
+
+    struct alignas(64) Bucket {
+        std::atomic<uint8_t> clock{ 0 }; // Bits 0-3 reference bits, 4-5 the hand
+        Slot slots[K_SLOTS_PER_BUCKET];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketMask;
+
+    static uint64_t slotKey(uint64_t key, TableKind kind, int depth);
+    bool readSlot(const Slot& slot, uint64_t fullKey, uint64_t (&words)[4]) const;
+    int chooseVictim(Bucket& bucket);
+};
+
+#endif // TRANSPOSITIONTABLE_H
@@ -0,0 +1,32 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Zobrist-style hashing of battle state: a fighter's hash is the XOR of one
+// pseudo-random key per (field, value), so a change to one field is two XORs.
+// Fields like HP have no fixed range, so keys come from a mixing function
+// instead of a precomputed table.
+enum class ZobristField : uint64_t {
+    HP = 1,
+    BONUS,
+    ROCK,
+    PAPER,
+    SCISSORS,
+    TRIGGERED // Value is the passive index; present while its flag is set
+};
+
+inline uint64_t zobristKey(ZobristField field, int value) {
+    // splitmix64 finaliser
+    uint64_t z = (static_cast<uint64_t>(field) << 40) ^ static_cast<uint32_t>(value) ^ 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Key for "self facing opponent"; swapping the two gives a different key
+inline uint64_t zobristPair(uint64_t selfHash, uint64_t opponentHash) {
+    return selfHash ^ ((opponentHash << 29) | (opponentHash >> 35)) ^ 0x5851F42D4C957F2DULL;
+}
+
+#endif // ZOBRIST_H
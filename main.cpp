@@ -1,8 +1,82 @@
 #include "MainMenu.h"
+#include "SimCommand.h"
+#include "RosterCommand.h"
+#include "BenchCommand.h"
+#include "ReplayCommand.h"
+#include "ServerCommand.h"
+#include "TerminalRenderer.h"
+#include "Metrics.h"
 #include <iostream>
+#include <string>
 
-int main() {
-    MainMenu menu;
-    menu.run();
-    return 0;
-}
\ No newline at end of file
+namespace {
+    // Removes "--metrics FILE" from the arguments, wherever it is, and returns FILE
+    std::string takeMetricsOption(int& argc, char* argv[]) {
+        std::string path;
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string(argv[i]) == "--metrics") {
+                path = argv[i + 1];
+                for (int j = i; j + 2 < argc; ++j) argv[j] = argv[j + 2];
+                argc -= 2;
+                break;
+            }
+        }
+        return path;
+    }
+
+    int runCommand(int argc, char* argv[]) {
+        if (argc > 1 && std::string(argv[1]) == "sim") {
+            return runSimCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "matrix") {
+            return runMatrixCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "solve") {
+            return runSolveCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "gauntlet") {
+            return runGauntletCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "tournament") {
+            return runTournamentCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "evolve") {
+            return runEvolveCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "bench") {
+            return runBenchCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "roster") {
+            return runRosterCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "replay") {
+            return runReplayCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "serve") {
+            return runServeCommand(argc - 2, argv + 2);
+        }
+        if (argc > 1 && std::string(argv[1]) == "connect") {
+            return runConnectCommand(argc - 2, argv + 2);
+        }
+
+        // --record FILE: append every battle played from the menu to a replay log
+        std::string recordPath;
+        if (argc > 2 && std::string(argv[1]) == "--record") recordPath = argv[2];
+        TerminalRenderer screen; // Outlives the menu, so its last words are shown
+        MainMenu menu(recordPath);
+        menu.run();
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // --metrics FILE: export the hot-path metrics there on exit (.json, else Prometheus text)
+    std::string metricsPath = takeMetricsOption(argc, argv);
+    if (!metricsPath.empty() && !Metrics::ENABLED) {
+        std::cerr << "Warning: built without PICBATTLE_METRICS (see the ReleaseMetrics configuration), so " << metricsPath << " will be all zeros." << std::endl;
+    }
+
+    int status = runCommand(argc, argv);
+    if (!metricsPath.empty() && !Metrics::writeFile(metricsPath)) return 1;
+    return status;
+}